@@ -0,0 +1,172 @@
+/*
+ * Copyright 2019 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UFG_COMMON_BUFFER_POOL_H_
+#define UFG_COMMON_BUFFER_POOL_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>  // NOLINT: Unapproved C++11 header.
+#include <utility>
+#include <vector>
+
+namespace ufg {
+struct BufferPoolStats {
+  size_t live_bytes = 0;        // Bytes in buffers currently acquired.
+  size_t pooled_bytes = 0;      // Bytes in buffers waiting for reuse.
+  size_t high_water_bytes = 0;  // Peak of live_bytes + pooled_bytes.
+  size_t alloc_count = 0;       // Acquires that required a new allocation.
+  size_t reuse_count = 0;       // Acquires satisfied from the pool.
+};
+
+// Thread-safe pool of large buffers, used to recycle image and pixel storage
+// across conversions rather than returning it to the heap.
+// * Buffers smaller than kMinPooledBytes are allocated and freed normally.
+// * Released buffers beyond kMaxPooledBytes are freed, oldest first.
+// * Every buffer passed to Acquire and Release is counted in live_bytes by its
+//   capacity, so buffers must only grow through Acquire or be recounted with
+//   Recount.
+template <typename T>
+class BufferPool {
+ public:
+  static constexpr size_t kMinPooledBytes = 64 * 1024;
+  static constexpr size_t kMaxPooledBytes = 512 * 1024 * 1024;
+
+  // Resize buffer to size elements, swapping in the smallest pooled buffer
+  // with sufficient capacity if the existing buffer is too small.
+  // * Existing content is not preserved if the buffer is replaced.
+  void Acquire(size_t size, std::vector<T>* buffer) {
+    if (buffer->capacity() >= size || size * sizeof(T) < kMinPooledBytes) {
+      const size_t old_capacity = buffer->capacity();
+      buffer->resize(size);
+      Recount(old_capacity, *buffer);
+      return;
+    }
+    Release(buffer);
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      size_t best = free_.size();
+      for (size_t i = 0; i != free_.size(); ++i) {
+        const size_t capacity = free_[i].capacity();
+        if (capacity >= size &&
+            (best == free_.size() || capacity < free_[best].capacity())) {
+          best = i;
+        }
+      }
+      if (best != free_.size()) {
+        buffer->swap(free_[best]);
+        free_.erase(free_.begin() + best);
+        stats_.pooled_bytes -= GetBytes(*buffer);
+        ++stats_.reuse_count;
+      } else {
+        ++stats_.alloc_count;
+      }
+    }
+    buffer->resize(size);
+    Recount(0, *buffer);
+  }
+
+  // Return buffer storage to the pool, leaving buffer empty.
+  void Release(std::vector<T>* buffer) {
+    const size_t bytes = GetBytes(*buffer);
+    std::vector<std::vector<T>> freed;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      stats_.live_bytes -= bytes;
+      if (bytes < kMinPooledBytes) {
+        freed.emplace_back();
+        freed.back().swap(*buffer);
+        return;
+      }
+      buffer->clear();
+      free_.emplace_back();
+      free_.back().swap(*buffer);
+      stats_.pooled_bytes += bytes;
+      while (stats_.pooled_bytes > kMaxPooledBytes) {
+        stats_.pooled_bytes -= GetBytes(free_.front());
+        freed.push_back(std::move(free_.front()));
+        free_.erase(free_.begin());
+      }
+      UpdateHighWater();
+    }
+  }
+
+  // Update live_bytes for a buffer whose storage changed outside the pool
+  // (e.g. decoded into), given its capacity before the change.
+  void Recount(size_t old_capacity, const std::vector<T>& buffer) {
+    const size_t old_bytes = old_capacity * sizeof(T);
+    const size_t new_bytes = GetBytes(buffer);
+    if (old_bytes == new_bytes) {
+      return;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    stats_.live_bytes = stats_.live_bytes - old_bytes + new_bytes;
+    UpdateHighWater();
+  }
+
+  // Free all pooled buffers.
+  void Trim() {
+    std::vector<std::vector<T>> freed;
+    std::unique_lock<std::mutex> lock(mutex_);
+    freed.swap(free_);
+    stats_.pooled_bytes = 0;
+  }
+
+  BufferPoolStats GetStats() const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return stats_;
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::vector<std::vector<T>> free_;
+  BufferPoolStats stats_;
+
+  static size_t GetBytes(const std::vector<T>& buffer) {
+    return buffer.capacity() * sizeof(T);
+  }
+
+  void UpdateHighWater() {
+    stats_.high_water_bytes = std::max(
+        stats_.high_water_bytes, stats_.live_bytes + stats_.pooled_bytes);
+  }
+};
+
+// Get the process-wide pool for buffers of type T.
+template <typename T>
+BufferPool<T>& GetBufferPool() {
+  static BufferPool<T> pool;
+  return pool;
+}
+
+// Owns a pooled buffer for the lifetime of a scope.
+template <typename T>
+class PooledBuffer {
+ public:
+  explicit PooledBuffer(size_t size) { GetBufferPool<T>().Acquire(size, &v_); }
+  ~PooledBuffer() { GetBufferPool<T>().Release(&v_); }
+  PooledBuffer(const PooledBuffer&) = delete;
+  PooledBuffer& operator=(const PooledBuffer&) = delete;
+  T* data() { return v_.data(); }
+  const T* data() const { return v_.data(); }
+  size_t size() const { return v_.size(); }
+  std::vector<T>& vector() { return v_; }
+ private:
+  std::vector<T> v_;
+};
+}  // namespace ufg
+
+#endif  // UFG_COMMON_BUFFER_POOL_H_
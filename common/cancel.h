@@ -0,0 +1,82 @@
+/*
+ * Copyright 2019 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UFG_COMMON_CANCEL_H_
+#define UFG_COMMON_CANCEL_H_
+
+#include <atomic>  // NOLINT: Unapproved C++11 header.
+#include <chrono>  // NOLINT: Unapproved C++11 header.
+#include <stdexcept>
+#include "common/common.h"
+
+namespace ufg {
+// Thrown by CheckCancel to unwind a cancelled operation.
+class CancelException : public std::runtime_error {
+ public:
+  CancelException() : std::runtime_error("Cancelled") {}
+};
+
+// Cooperative cancellation flag, polled by long-running loops.
+// * The token can be cancelled explicitly from any thread, or automatically
+//   once its deadline passes.
+// * A token is also cancelled when its parent is, so a caller-owned token can
+//   cancel per-job tokens that have their own deadlines.
+class CancelToken {
+ public:
+  explicit CancelToken(const CancelToken* parent = nullptr)
+      : parent_(parent) {}
+  CancelToken(const CancelToken&) = delete;
+  CancelToken& operator=(const CancelToken&) = delete;
+
+  void Cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+
+  // Cancel automatically once this many seconds have elapsed. Values <= 0
+  // disable the deadline.
+  void SetTimeout(float seconds) {
+    have_deadline_ = seconds > 0.0f;
+    if (have_deadline_) {
+      deadline_ = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                     std::chrono::duration<float>(seconds));
+    }
+  }
+
+  // Returns true if this token's own deadline has passed.
+  bool IsExpired() const {
+    return have_deadline_ && Clock::now() >= deadline_;
+  }
+
+  bool IsCancelled() const {
+    return cancelled_.load(std::memory_order_relaxed) || IsExpired() ||
+           (parent_ && parent_->IsCancelled());
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+  const CancelToken* parent_;
+  std::atomic<bool> cancelled_{false};
+  bool have_deadline_ = false;
+  Clock::time_point deadline_;
+};
+
+// Throw CancelException if the token is cancelled. The token may be null.
+inline void CheckCancel(const CancelToken* token) {
+  if (token && token->IsCancelled()) {
+    throw CancelException();
+  }
+}
+}  // namespace ufg
+
+#endif  // UFG_COMMON_CANCEL_H_
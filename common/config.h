@@ -17,7 +17,9 @@
 #ifndef UFG_COMMON_CONFIG_H_
 #define UFG_COMMON_CONFIG_H_
 
+#include "common/cancel.h"
 #include "common/common.h"
+#include "common/memory_tracker.h"
 #include "gltf/load.h"
 
 namespace ufg {
@@ -35,6 +37,11 @@ struct Constants {
   static constexpr Scalar kAcosTol = static_cast<Scalar>(0.9999999);
 };
 
+// Converter version, recorded in dependency manifests. Bump this for changes
+// that alter output for the same input and settings, so incremental batch
+// conversion doesn't keep stale output.
+constexpr const char* kConverterVersion = "1.2.0";
+
 // We eliminate skin influences with weights less than this.
 constexpr float kSkinWeightZeroTol = 0.01f;
 
@@ -46,6 +53,28 @@ constexpr float kPruneTranslationProportionalSq = Square(0.01f);
 constexpr float kPruneTranslationAbsoluteSq = Square(0.001f);
 constexpr float kPruneRotationComponent = 0.01f * Constants<float>::kDegToRad;
 constexpr float kPruneScaleComponent = 0.001f;
+constexpr float kPruneMorphWeight = 0.001f;
+
+// Morph target position and normal deltas with all components within this
+// tolerance are dropped from sparse blend shapes. Positions are in source units
+// (meters).
+constexpr float kMorphDeltaTol = 0.00001f;
+
+// Maximum error for values written at half precision (see
+// ConvertSettings::half_precision).
+// * UV and normal tolerances allow values in [-1, 1] to be written at half
+//   precision, which is within a quarter texel for 1024x1024 textures.
+// * Translation tolerance is in source units (meters).
+// * Rotation tolerance is in degrees.
+constexpr float kHalfUvTol = 1.0f / 4096.0f;
+constexpr float kHalfNormalTol = 0.001f;
+constexpr float kHalfTranslationTol = 0.0005f;
+constexpr float kHalfRotationTol = 0.1f;
+constexpr float kHalfScaleTol = 0.001f;
+
+// Skin weights are quantized to multiples of this step when writing at half
+// precision, so the USDC writer can store them in a compact lookup table.
+constexpr float kHalfWeightStep = 1.0f / 512.0f;
 
 // Animation frames per second.
 // * This number is fairly arbitrary since it only affects the scale of time
@@ -163,6 +192,27 @@ struct ConvertSettings {
   //   0.75, 0.5, 0.25, 0.25*0.75, 0.25*0.5, 0.25*0.25, 0.25*0.25*0.75, ...
   float limit_total_image_scale_step = 0.5f;
 
+  // When limiting total image size, scale each image individually rather than
+  // uniformly, allocating more of the budget to images with higher weight.
+  // * Weight is derived from texture usage (e.g. base color is weighted higher
+  //   than occlusion) and the UV-space area of geometry referencing the image.
+  // * Each image is resized to the largest size fitting its share of the
+  //   budget, so sizes aren't restricted to powers of the scale step.
+  bool limit_total_image_weighted = false;
+
+  // Limit the total file size of all output images, in bytes. If the total
+  // exceeds this limit, JPG quality is reduced (down to jpg_quality_min) to the
+  // highest quality that fits.
+  // * PNG, directly-copied, and fallback images are not affected, but count
+  //   towards the total.
+  // * A single JPG quality is searched for across all images, so one large JPG
+  //   lowers the quality of every other JPG.
+  // * Set to 0 to disable this limit.
+  uint32_t limit_total_image_file_size = 0;
+
+  // Minimum JPG quality used when limiting total image file size.
+  uint8_t jpg_quality_min = 50;
+
   // Add debug meshes to each transform node to visualize animation. This is
   // useful for debugging skinned animations in Usdview, because it doesn't
   // support skinning.
@@ -190,6 +240,11 @@ struct ConvertSettings {
   // black it will cause the whole material to be black.
   bool black_occlusion_is_white = true;
 
+  // Replace solid-color textures with constant shader input values, rather than
+  // referencing 1x1 textures. This reduces the number of files and shader nodes
+  // the viewer needs to load.
+  bool fold_solid_textures = false;
+
   // Delete unused intermediate output files.
   bool delete_unused = true;
 
@@ -228,6 +283,17 @@ struct ConvertSettings {
   // but this may look better (possibly at the cost of larger animation size).
   bool fix_skinned_normals = true;
 
+  // Reduce the precision of mesh and animation data to shrink output size, where
+  // the error is within tolerance (see kHalf*Tol). A summary of the measured
+  // error is logged.
+  // * UVs are written as texCoord2h primvars.
+  // * Normals are written as a normal3h 'primvars:normals' primvar rather than
+  //   the 'normals' attribute.
+  // * Rigid node animation is written with half-precision transform ops.
+  // * Skin weights are quantized to kHalfWeightStep. UsdSkel requires these
+  //   (and skeletal animation) to be full precision, so they retain their type.
+  bool half_precision = false;
+
   // Merge materials with identical parameters, irrespective of material name.
   bool merge_identical_materials = true;
 
@@ -248,6 +314,32 @@ struct ConvertSettings {
   // transparency will be converted to jpeg.
   bool prefer_jpeg = true;
 
+  // Encode opaque images as both PNG and JPG, and keep whichever is smaller.
+  // * JPG images are encoded at jpg_quality, which acts as a quality floor.
+  // * This overrides prefer_jpeg for opaque images.
+  bool pick_smaller_image_format = false;
+
+  // Read and decode source images on background threads while geometry is
+  // converted, so texture IO doesn't block conversion.
+  // * Read errors for prefetched images are logged from worker threads, so the
+  //   logger must be thread-safe (e.g. AsyncLogger).
+  // * This is off by default so library users (e.g. the USD plugin) don't
+  //   start threads or log concurrently. The usd_from_gltf tool enables it.
+  bool prefetch_images = false;
+
+  // Maximum bytes of encoded image data queued for the background writer, so
+  // encoding the next image overlaps with writing the previous one. Encoding
+  // blocks while the queue is full. If 0, images are written synchronously.
+  uint32_t write_queue_limit = 64 * 1024 * 1024;
+
+  // Whether written image and USD files are flushed to storage before the
+  // conversion completes:
+  //   0 -> Never - leave it to the OS.
+  //   1 -> Sync each written file.
+  //   2 -> Also sync the directory containing each file, so new files survive
+  //        a crash.
+  uint8_t fsync_policy = 0;
+
   // Print conversion time stats.
   bool print_timing = false;
 
@@ -265,6 +357,13 @@ struct ConvertSettings {
   // transforms - animating to an inverse scale will still break.
   bool reverse_culling_for_inverse_scale = true;
 
+  // Write geometry, materials, and skeletal animation to separate sublayers of
+  // the output, so viewers can load them progressively. The root layer
+  // contains only the hierarchy, extents, and model bounds (extentsHint).
+  // * Sublayers are written alongside the output as <name>_geom, <name>_mtl,
+  //   and <name>_anim. For USDZ output, they are flattened into the package.
+  bool split_layers = false;
+
   // Emit warnings for features that are incompatible with the iOS viewer (such
   // as texture sampling states, vertex colors, multiple UV sets, etc). These
   // will build correctly, but display incorrectly in the iOS viewer.
@@ -277,6 +376,33 @@ struct ConvertSettings {
   // loaded using the system path.
   std::string plugin_path;
 
+  // If set, write a JSON report of conversion timing and content statistics to
+  // this path.
+  std::string report_path;
+
+  // If set, write a JSON manifest of the files each conversion depends on to
+  // this path, so batch tools can skip conversions whose inputs are unchanged.
+  std::string manifest_path;
+
+  // Abort conversion if it runs longer than this many seconds, including load
+  // and write time. Values <= 0 disable the timeout.
+  // * Cancellation is checked between steps, so glTF parsing, JPG encoding and
+  //   individual image resizes run to completion before it takes effect.
+  float timeout = 0.0f;
+
+  // Abort conversion if memory charged to the tracker for a single model
+  // exceeds this many MiB. If 0, memory is unlimited.
+  uint32_t memory_limit_mb = 0;
+
+  // Optional token used to cancel conversion from another thread. This isn't
+  // owned, and must outlive the conversion.
+  const CancelToken* cancel_token = nullptr;
+
+  // Optional tracker for memory held by the conversion, so callers can query
+  // per-subsystem usage while it runs. This isn't owned, and must outlive the
+  // conversion. If null, the conversion uses its own tracker.
+  MemoryTracker* memory_tracker = nullptr;
+
   static const ConvertSettings kDefault;
 };
 
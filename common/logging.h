@@ -59,6 +59,8 @@ do {                                                            \
 namespace ufg {
 
 using Logger = GltfLogger;
+using AsyncLogger = GltfAsyncLogger;
+using SequencedLogger = GltfSequencedLogger;
 using OnceLogger = GltfOnceLogger;
 using Message = GltfMessage;
 using Severity = GltfSeverity;
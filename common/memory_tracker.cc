@@ -0,0 +1,136 @@
+/*
+ * Copyright 2019 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "common/memory_tracker.h"
+
+#include <stdio.h>
+
+namespace ufg {
+namespace {
+void UpdatePeak(size_t value, std::atomic<size_t>* peak) {
+  size_t old_peak = peak->load(std::memory_order_relaxed);
+  while (value > old_peak &&
+         !peak->compare_exchange_weak(old_peak, value,
+                                      std::memory_order_relaxed)) {
+  }
+}
+}  // namespace
+
+const char* const kMemoryTagNames[kMemoryTagCount] = {
+    "gltf_files",    // kMemoryGltfFiles
+    "gltf_content",  // kMemoryGltfContent
+    "src_images",    // kMemorySrcImages
+    "float_images",  // kMemoryFloatImages
+    "meshes",        // kMemoryMeshes
+    "usd",           // kMemoryUsd
+};
+
+MemoryTracker::MemoryTracker()
+    : total_(0), total_peak_(0), limit_exceeded_(false) {
+  for (size_t i = 0; i != kMemoryTagCount; ++i) {
+    current_[i] = 0;
+    peak_[i] = 0;
+  }
+}
+
+void MemoryTracker::SetLimit(size_t limit, CancelToken* cancel_token) {
+  limit_ = limit;
+  cancel_token_ = cancel_token;
+  limit_exceeded_ = limit != 0 && GetTotal() > limit;
+  if (limit_exceeded_ && cancel_token_) {
+    cancel_token_->Cancel();
+  }
+}
+
+void MemoryTracker::Add(MemoryTag tag, size_t bytes) {
+  if (bytes == 0) {
+    return;
+  }
+  UpdatePeak(current_[tag].fetch_add(bytes, std::memory_order_relaxed) + bytes,
+             &peak_[tag]);
+  const size_t total =
+      total_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  UpdatePeak(total, &total_peak_);
+  if (limit_ != 0 && total > limit_ &&
+      !limit_exceeded_.exchange(true, std::memory_order_relaxed) &&
+      cancel_token_) {
+    cancel_token_->Cancel();
+  }
+}
+
+void MemoryTracker::Remove(MemoryTag tag, size_t bytes) {
+  current_[tag].fetch_sub(bytes, std::memory_order_relaxed);
+  total_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+MemoryTag MemoryTracker::GetLargestTag() const {
+  size_t largest = 0;
+  for (size_t i = 1; i != kMemoryTagCount; ++i) {
+    if (current_[i] > current_[largest]) {
+      largest = i;
+    }
+  }
+  return static_cast<MemoryTag>(largest);
+}
+
+std::string MemoryTracker::GetSummary() const {
+  static constexpr double kMiB = 1024.0 * 1024.0;
+  std::string summary;
+  char text[128];
+  for (size_t i = 0; i != kMemoryTagCount; ++i) {
+    const MemoryTag tag = static_cast<MemoryTag>(i);
+    snprintf(text, sizeof(text), "%s=%.1f/%.1f ", kMemoryTagNames[i],
+             GetCurrent(tag) / kMiB, GetPeak(tag) / kMiB);
+    summary += text;
+  }
+  snprintf(text, sizeof(text), "total=%.1f/%.1f MiB (current/peak)",
+           GetTotal() / kMiB, GetTotalPeak() / kMiB);
+  summary += text;
+  return summary;
+}
+
+void MemoryCharge::SetTracker(MemoryTracker* tracker) {
+  if (tracker == tracker_) {
+    return;
+  }
+  if (tracker_) {
+    tracker_->Remove(tag_, bytes_);
+  }
+  tracker_ = tracker;
+  if (tracker_) {
+    tracker_->Add(tag_, bytes_);
+  }
+}
+
+void MemoryCharge::Add(size_t bytes) {
+  bytes_ += bytes;
+  if (tracker_) {
+    tracker_->Add(tag_, bytes);
+  }
+}
+
+void MemoryCharge::Set(size_t bytes) {
+  if (tracker_) {
+    if (bytes > bytes_) {
+      tracker_->Add(tag_, bytes - bytes_);
+    } else {
+      tracker_->Remove(tag_, bytes_ - bytes);
+    }
+  }
+  bytes_ = bytes;
+}
+}  // namespace ufg
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2019 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef UFG_COMMON_MEMORY_TRACKER_H_
+#define UFG_COMMON_MEMORY_TRACKER_H_
+
+#include <atomic>  // NOLINT: Unapproved C++11 header.
+#include <string>
+#include "common/cancel.h"
+#include "common/common.h"
+
+namespace ufg {
+// Owners of large conversion allocations, accounted separately.
+enum MemoryTag : uint8_t {
+  kMemoryGltfFiles,    // Buffer and image files held by GltfCache.
+  kMemoryGltfContent,  // Accessor data reformatted by GltfCache.
+  kMemorySrcImages,    // Decoded source images.
+  kMemoryFloatImages,  // Floating-point pixels used for image processing.
+  kMemoryMeshes,       // Decoded mesh primitives (PrimInfo arrays).
+  kMemoryUsd,          // Mesh and animation arrays authored to USD layers.
+  kMemoryTagCount
+};
+
+extern const char* const kMemoryTagNames[kMemoryTagCount];
+
+// Thread-safe accounting of current and peak bytes per tag, for a single
+// model.
+// * If a limit is set, the cancel token is cancelled as soon as the total
+//   exceeds it, so the conversion aborts at its next cancellation check rather
+//   than running the process out of memory.
+class MemoryTracker {
+ public:
+  MemoryTracker();
+  MemoryTracker(const MemoryTracker&) = delete;
+  MemoryTracker& operator=(const MemoryTracker&) = delete;
+
+  // Set the limit for total bytes, and the token cancelled when it's exceeded.
+  // * A limit of 0 disables it.
+  // * This must not be called while other threads are adding bytes.
+  void SetLimit(size_t limit, CancelToken* cancel_token);
+  size_t GetLimit() const { return limit_; }
+
+  void Add(MemoryTag tag, size_t bytes);
+  void Remove(MemoryTag tag, size_t bytes);
+
+  size_t GetCurrent(MemoryTag tag) const {
+    return current_[tag].load(std::memory_order_relaxed);
+  }
+  size_t GetPeak(MemoryTag tag) const {
+    return peak_[tag].load(std::memory_order_relaxed);
+  }
+  size_t GetTotal() const { return total_.load(std::memory_order_relaxed); }
+  size_t GetTotalPeak() const {
+    return total_peak_.load(std::memory_order_relaxed);
+  }
+
+  // Returns true if the total has exceeded the limit since it was set.
+  bool IsLimitExceeded() const {
+    return limit_exceeded_.load(std::memory_order_relaxed);
+  }
+
+  // Get the tag currently holding the most bytes.
+  MemoryTag GetLargestTag() const;
+
+  // Get a one-line summary of current and peak MiB for each tag.
+  std::string GetSummary() const;
+
+ private:
+  std::atomic<size_t> current_[kMemoryTagCount];
+  std::atomic<size_t> peak_[kMemoryTagCount];
+  std::atomic<size_t> total_;
+  std::atomic<size_t> total_peak_;
+  std::atomic<bool> limit_exceeded_;
+  size_t limit_ = 0;
+  CancelToken* cancel_token_ = nullptr;
+};
+
+// Bytes charged to a tracker under a single tag, released when the charge is
+// destroyed. The tracker may be null, in which case nothing is tracked.
+class MemoryCharge {
+ public:
+  explicit MemoryCharge(MemoryTag tag, MemoryTracker* tracker = nullptr)
+      : tag_(tag), tracker_(tracker) {}
+  ~MemoryCharge() { Release(); }
+  MemoryCharge(const MemoryCharge&) = delete;
+  MemoryCharge& operator=(const MemoryCharge&) = delete;
+
+  // Move the current charge to another tracker.
+  void SetTracker(MemoryTracker* tracker);
+  MemoryTracker* GetTracker() const { return tracker_; }
+
+  void Add(size_t bytes);
+  // Replace the current charge.
+  void Set(size_t bytes);
+  void Release() { Set(0); }
+  size_t GetBytes() const { return bytes_; }
+
+ private:
+  MemoryTag tag_;
+  MemoryTracker* tracker_;
+  size_t bytes_ = 0;
+};
+}  // namespace ufg
+
+#endif  // UFG_COMMON_MEMORY_TRACKER_H_
@@ -25,24 +25,38 @@
 #endif  // UFG_MSG0
 
 UFG_MSG3(ERROR, ASSERT                       , "%s(%d) : ASSERT(%s)", const char*, file, int, line, const char*, expression)
+UFG_MSG2(ERROR, TIMEOUT                      , "Conversion exceeded %g second timeout during %s phase.", double, timeout, const char*, phase)
+UFG_MSG1(ERROR, CANCELLED                    , "Conversion cancelled during %s phase.", const char*, phase)
+UFG_MSG4(ERROR, MEMORY_LIMIT                 , "Conversion exceeded %zu MiB memory limit during %s phase. Largest: %s (%zu MiB).", size_t, limit_mb, const char*, phase, const char*, tag, size_t, tag_mb)
 UFG_MSG1(ERROR, LOAD_PLUGINS                 , "Unable to load USD plugins. %s", const char*, why)
 UFG_MSG1(ERROR, ARGUMENT_UNKNOWN             , "Unknown flag: %s", const char*, text)
 UFG_MSG0(ERROR, ARGUMENT_PATHS               , "Non-even number of paths. Expected: src dst [src dst ...].")
 UFG_MSG2(ERROR, ARGUMENT_EXCEPTION           , "%s: %s", const char*, id, const char*, err)
+UFG_MSG1(ERROR, ARGUMENT_PROFILE             , "Invalid profile. Expected: name:[--flag value ...]. Got: %s", const char*, text)
 UFG_MSG1(ERROR, IO_WRITE_USD                 , "Cannot write USD: \"%s\"", const char*, path)
 UFG_MSG1(ERROR, IO_WRITE_IMAGE               , "Cannot write image: \"%s\"", const char*, path)
+UFG_MSG1(ERROR, IO_WRITE_REPORT              , "Cannot write report: \"%s\"", const char*, path)
+UFG_MSG1(ERROR, IO_WRITE_MANIFEST            , "Cannot write manifest: \"%s\"", const char*, path)
+UFG_MSG1(WARN , IO_HASH                      , "Cannot hash dependency: \"%s\"", const char*, path)
 UFG_MSG1(WARN , IO_DELETE                    , "Cannot delete file: %s", const char*, path)
 UFG_MSG1(ERROR, STOMP                        , "Would stomp source file: \"%s\"", const char*, path)
 UFG_MSG4(WARN , NON_TRIANGLES                , "Skipping unsupported %s primitive. Mesh: mesh[%zu].primitives[%zu], name=%s", const char*, prim_type, size_t, mesh_i, size_t, prim_i, const char*, name)
 UFG_MSG3(WARN , TEXTURE_LIMIT                , "Can't make %zu texture(s) fit in decompressed limit (%zu bytes). Reducing to minimum (%zu bytes).", size_t, count, size_t, decompressed_limit, size_t, decompressed_total)
+UFG_MSG2(WARN , IMAGE_FILE_LIMIT             , "Can't make images fit in file size limit (%zu bytes) at minimum JPG quality. Total: %zu bytes.", size_t, file_limit, size_t, file_total)
+UFG_MSG3(INFO , IMAGE_FILE_LIMIT             , "Reduced JPG quality to %d to fit images in file size limit (%zu bytes). Total: %zu bytes.", int, jpg_quality, size_t, file_limit, size_t, file_total)
+UFG_MSG2(INFO , IMAGE_FORMAT_SAVED           , "Choosing smaller image formats saved %zu bytes across %zu image(s).", size_t, saved_size, size_t, image_count)
+UFG_MSG4(INFO , HALF_PRECISION               , "Half precision %s: %zu of %zu written at reduced precision. Max error: %g.", const char*, what, size_t, half_count, size_t, total_count, double, max_error)
+UFG_MSG1(ERROR, PROFILE_DST_DIR              , "Multiple profiles write to the same directory: %s", const char*, dir)
+UFG_MSG1(INFO , PROFILE_BEGIN                , "Converting profile: %s", const char*, dst_path)
 UFG_MSG2(ERROR, LAYER_CREATE                 , "Cannot create layer '%s' at: %s", const char*, src_name, const char*, dst_path)
 UFG_MSG2(ERROR, USD                          , "USD: %s (%s)", const char*, commentary, const char*, function)
 UFG_MSG2(WARN , USD                          , "USD: %s (%s)", const char*, commentary, const char*, function)
 UFG_MSG2(INFO , USD                          , "USD: %s (%s)", const char*, commentary, const char*, function)
+UFG_MSG2(INFO , MEMORY                       , "Memory after %s phase: %s", const char*, phase, const char*, summary)
 UFG_MSG2(ERROR, USD_FATAL                    , "USD: FATAL: %s (%s)", const char*, commentary, const char*, function)
 UFG_MSG0(WARN , ALPHA_MASK_UNSUPPORTED       , "Alpha mask currently unsupported.")
 UFG_MSG0(WARN , CAMERAS_UNSUPPORTED          , "Cameras currently unsupported.")
-UFG_MSG0(WARN , MORPH_TARGETS_UNSUPPORTED    , "Morph targets currently unsupported.")
+UFG_MSG0(WARN , MORPH_TARGETS_UNSUPPORTED    , "Morph targets unsupported on iOS viewer.")
 UFG_MSG0(WARN , MULTIPLE_UVSETS_UNSUPPORTED  , "Multiple UV sets unsupported on iOS viewer.")
 UFG_MSG0(WARN , SECONDARY_UVSET_DISABLED     , "Disabling secondary UV set.")
 UFG_MSG0(WARN , SPECULAR_WORKFLOW_UNSUPPORTED, "Specular workflow unsupported on iOS viewer.")
@@ -71,6 +85,7 @@ UFG_MSG0(ERROR, PNG_WRITE_INIT               , "PNG: Failed to initialize for wr
 UFG_MSG3(ERROR, DRACO_UNKNOWN                , "Draco: Cannot determine geometry type for mesh: mesh[%zu].primitives[%zu], name=%s", size_t, mesh_i, size_t, prim_i, const char*, name)
 UFG_MSG3(ERROR, DRACO_LOAD                   , "Draco: Cannot load data for mesh: mesh[%zu].primitives[%zu], name=%s", size_t, mesh_i, size_t, prim_i, const char*, name)
 UFG_MSG3(ERROR, DRACO_DECODE                 , "Draco: Failed to decode mesh: mesh[%zu].primitives[%zu], name=%s", size_t, mesh_i, size_t, prim_i, const char*, name)
+UFG_MSG3(WARN , DRACO_MORPH_TARGETS          , "Draco: Skipping morph targets for compressed mesh: mesh[%zu].primitives[%zu], name=%s", size_t, mesh_i, size_t, prim_i, const char*, name)
 UFG_MSG3(ERROR, DRACO_NON_TRIANGLES          , "Draco: Non-triangular mesh: mesh[%zu].primitives[%zu], name=%s", size_t, mesh_i, size_t, prim_i, const char*, name)
 
 #undef UFG_MSG
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2019 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "common/output_writer.h"
+
+#include "common/platform.h"
+#include "gltf/disk_util.h"
+#include "gltf/gltf.h"
+
+namespace ufg {
+void OutputWriter::Start(size_t queue_limit, FsyncPolicy fsync_policy) {
+  Stop();
+  queue_limit_ = queue_limit;
+  fsync_policy_ = fsync_policy;
+  if (queue_limit != 0) {
+    scheduler_.reset(new Scheduler());
+    scheduler_->Start(1);
+  }
+}
+
+void OutputWriter::Write(const std::string& path, std::vector<uint8_t>* data) {
+  // Share ownership, because scheduled functions must be copyable.
+  std::shared_ptr<std::vector<uint8_t>> owned(new std::vector<uint8_t>());
+  owned->swap(*data);
+  const size_t size = owned->size();
+  Schedule(path, size, [path, owned]() {
+    return GltfDiskWriteBinary(path, owned->data(), owned->size());
+  });
+}
+
+void OutputWriter::Run(const std::string& path, std::function<bool()> write) {
+  Schedule(path, 0, std::move(write));
+}
+
+void OutputWriter::Sync(const std::string& path) {
+  Schedule(path, 0, []() { return true; });
+}
+
+std::vector<std::string> OutputWriter::Flush() {
+  if (scheduler_) {
+    scheduler_->WaitForAllComplete();
+  }
+  std::vector<std::string> failed_paths;
+  std::lock_guard<std::mutex> lock(mutex_);
+  failed_paths.swap(failed_paths_);
+  return failed_paths;
+}
+
+void OutputWriter::Stop() {
+  if (scheduler_) {
+    scheduler_->WaitForAllComplete();
+    scheduler_->Stop();
+    scheduler_.reset();
+  }
+}
+
+void OutputWriter::Schedule(const std::string& path, size_t size,
+                            std::function<bool()> write) {
+  if (!scheduler_) {
+    Complete(path, 0, write);
+    return;
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    dequeue_event_.wait(lock, [this, size]() {
+      return queued_size_ == 0 || queued_size_ + size <= queue_limit_;
+    });
+    queued_size_ += size;
+  }
+  scheduler_->Schedule([this, path, size, write]() {
+    Complete(path, size, write);
+  });
+}
+
+void OutputWriter::Complete(const std::string& path, size_t size,
+                            const std::function<bool()>& write) {
+  bool success;
+  try {
+    success = write();
+  } catch (...) {
+    success = false;
+  }
+  if (success && fsync_policy_ != kFsyncNone) {
+    success = SyncFile(path.c_str());
+    if (success && fsync_policy_ == kFsyncDir) {
+      std::string dir, name;
+      Gltf::SplitPath(path, &dir, &name);
+      success = SyncDirectory(dir.c_str());
+    }
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  queued_size_ -= size;
+  if (!success) {
+    failed_paths_.push_back(path);
+  }
+  dequeue_event_.notify_all();
+}
+}  // namespace ufg
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2019 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef UFG_COMMON_OUTPUT_WRITER_H_
+#define UFG_COMMON_OUTPUT_WRITER_H_
+
+#include <condition_variable>  // NOLINT: Unapproved C++11 header.
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT: Unapproved C++11 header.
+#include <string>
+#include <vector>
+#include "common/common.h"
+#include "common/scheduler.h"
+
+namespace ufg {
+// Writes output files on a background thread, so encoding the next output
+// overlaps with writing the previous one.
+// * Failures occur on the writer thread, so they're collected rather than
+//   logged. Callers retrieve them with Flush and log them in their own context.
+class OutputWriter {
+ public:
+  // Policy for flushing written files to storage.
+  enum FsyncPolicy : uint8_t {
+    kFsyncNone,  // Leave flushing to the OS.
+    kFsyncFile,  // Sync each file after it's written.
+    kFsyncDir,   // Also sync the containing directory.
+  };
+
+  OutputWriter() {}
+  ~OutputWriter() { Stop(); }
+
+  // Start the writer thread.
+  // * At most queue_limit bytes of data are queued at a time. Write blocks
+  //   while the queue is full, though a single write larger than the limit is
+  //   still accepted into an empty queue.
+  // * If queue_limit is 0, writes occur immediately on the calling thread.
+  void Start(size_t queue_limit, FsyncPolicy fsync_policy);
+
+  // Queue data to be written to a file. The data is taken from the vector.
+  void Write(const std::string& path, std::vector<uint8_t>* data);
+
+  // Queue a function that writes a file itself (e.g. a USD layer export). The
+  // function returns false on failure. Exceptions are treated as failures.
+  void Run(const std::string& path, std::function<bool()> write);
+
+  // Queue a sync of a file written elsewhere, according to the fsync policy.
+  void Sync(const std::string& path);
+
+  // Wait for queued writes to complete, and get the paths of files that failed
+  // to write or sync since the last call.
+  std::vector<std::string> Flush();
+
+  // Wait for queued writes to complete, and stop the writer thread. Failures
+  // are kept for the next call to Flush.
+  void Stop();
+
+  // Stops the writer when it goes out of scope, so queued writes complete
+  // before the caller unwinds (e.g. on cancellation).
+  struct StopSentry {
+    OutputWriter* writer;
+    explicit StopSentry(OutputWriter* writer) : writer(writer) {}
+    ~StopSentry() { writer->Stop(); }
+  };
+
+ private:
+  std::unique_ptr<Scheduler> scheduler_;
+  size_t queue_limit_ = 0;
+  FsyncPolicy fsync_policy_ = kFsyncNone;
+  std::mutex mutex_;
+  std::condition_variable dequeue_event_;
+  size_t queued_size_ = 0;
+  std::vector<std::string> failed_paths_;
+
+  void Schedule(const std::string& path, size_t size,
+                std::function<bool()> write);
+  void Complete(const std::string& path, size_t size,
+                const std::function<bool()>& write);
+};
+}  // namespace ufg
+
+#endif  // UFG_COMMON_OUTPUT_WRITER_H_
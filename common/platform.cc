@@ -16,11 +16,17 @@
 
 #include "common/platform.h"
 
+#include <sys/stat.h>
 #ifdef _MSC_VER
+#include <windows.h>
+// windows.h must precede psapi.h.
 #include <direct.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
 #pragma warning(disable : 4996)  // 'getcwd' POSIX name is deprecated.
 #else  // _MSC_VER
-#include <sys/stat.h>
+#include <fcntl.h>
+#include <sys/resource.h>
 #include <unistd.h>
 #include <fstream>
 #endif  // _MSC_VER
@@ -37,4 +43,70 @@ void SetCwd(const char* dir) {
     chdir(dir);
   }
 }
+
+size_t GetFileSize(const char* path) {
+#ifdef _MSC_VER
+  struct _stat64 info;
+  return _stat64(path, &info) == 0 ? static_cast<size_t>(info.st_size) : 0;
+#else  // _MSC_VER
+  struct stat info;
+  return stat(path, &info) == 0 ? static_cast<size_t>(info.st_size) : 0;
+#endif  // _MSC_VER
+}
+
+bool SyncFile(const char* path) {
+#ifdef _MSC_VER
+  const HANDLE file = CreateFileA(
+      path, GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  const bool success = FlushFileBuffers(file) != FALSE;
+  CloseHandle(file);
+  return success;
+#else  // _MSC_VER
+  const int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  const bool success = fsync(fd) == 0;
+  close(fd);
+  return success;
+#endif  // _MSC_VER
+}
+
+bool SyncDirectory(const char* path) {
+#ifdef _MSC_VER
+  return true;
+#else  // _MSC_VER
+  const int fd = open(path[0] ? path : ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  const bool success = fsync(fd) == 0;
+  close(fd);
+  return success;
+#endif  // _MSC_VER
+}
+
+size_t GetPeakRss() {
+#ifdef _MSC_VER
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+    return 0;
+  }
+  return counters.PeakWorkingSetSize;
+#else  // _MSC_VER
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#ifdef __APPLE__
+  return static_cast<size_t>(usage.ru_maxrss);  // Bytes on macOS.
+#else  // __APPLE__
+  return static_cast<size_t>(usage.ru_maxrss) * 1024;  // Kilobytes on Linux.
+#endif  // __APPLE__
+#endif  // _MSC_VER
+}
 }  // namespace ufg
@@ -17,6 +17,7 @@
 #ifndef UFG_COMMON_PLATFORM_H_
 #define UFG_COMMON_PLATFORM_H_
 
+#include <stddef.h>
 #include <string>
 
 // Used for DebugBreak.
@@ -33,6 +34,21 @@
 namespace ufg {
 std::string GetCwd();
 void SetCwd(const char* dir);
+
+// Get the size of a file in bytes, or 0 if it doesn't exist.
+size_t GetFileSize(const char* path);
+
+// Flush a file's contents to storage. Returns false on failure.
+bool SyncFile(const char* path);
+
+// Flush a directory's entries to storage, so newly created files in it survive
+// a crash. This is a no-op on Windows, which doesn't support syncing
+// directories.
+bool SyncDirectory(const char* path);
+
+// Get the peak resident set size of the current process in bytes, or 0 if it's
+// unavailable.
+size_t GetPeakRss();
 }  // namespace ufg
 
 #endif  // UFG_COMMON_PLATFORM_H_
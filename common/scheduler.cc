@@ -23,7 +23,7 @@ namespace {
 constexpr size_t kWorkerMax = 64;
 }  // namespace
 
-Scheduler::Scheduler() : stopping_(false) {
+Scheduler::Scheduler() : stopping_(false), running_count_(0) {
 }
 
 void Scheduler::Start(size_t worker_count) {
@@ -59,7 +59,7 @@ void Scheduler::WaitForAllComplete() {
   std::queue<std::exception_ptr> exceptions;
   for (;;) {
     std::unique_lock<std::mutex> lock(mutex_);
-    if (job_queue_.empty()) {
+    if (job_queue_.empty() && running_count_ == 0) {
       exceptions.swap(exceptions_);
       break;
     }
@@ -70,6 +70,11 @@ void Scheduler::WaitForAllComplete() {
   }
 }
 
+size_t Scheduler::GetDefaultWorkerCount() {
+  const size_t hardware_count = std::thread::hardware_concurrency();
+  return std::min(std::max(hardware_count, static_cast<size_t>(1)), kWorkerMax);
+}
+
 void Scheduler::WorkerThread(Scheduler* scheduler, size_t index) {
   while (!scheduler->stopping_) {
     bool have_job = false;
@@ -79,6 +84,7 @@ void Scheduler::WorkerThread(Scheduler* scheduler, size_t index) {
       if (!scheduler->job_queue_.empty()) {
         func.swap(scheduler->job_queue_.front().func);
         scheduler->job_queue_.pop();
+        ++scheduler->running_count_;
         have_job = true;
       } else {
         // Wait for a job to become available, or the signal to stop.
@@ -101,6 +107,10 @@ void Scheduler::WorkerThread(Scheduler* scheduler, size_t index) {
         std::unique_lock<std::mutex> lock(scheduler->mutex_);
         scheduler->exceptions_.push(std::current_exception());
       }
+      {
+        std::unique_lock<std::mutex> lock(scheduler->mutex_);
+        --scheduler->running_count_;
+      }
       scheduler->job_done_event_.notify_all();
     }
   }
@@ -51,9 +51,13 @@ class Scheduler {
     }
   }
 
-  // Wait for all scheduled jobs to complete.
+  // Wait for all scheduled jobs to complete, including those currently running.
   void WaitForAllComplete();
 
+  // Get the number of worker threads to use by default, based on the number of
+  // hardware threads.
+  static size_t GetDefaultWorkerCount();
+
  private:
   using JobFunction = std::function<void()>;
   struct Job {
@@ -62,6 +66,7 @@ class Scheduler {
     explicit Job(JobFunction&& func) : func(func) {}
   };
   bool stopping_;
+  size_t running_count_;
   std::condition_variable add_or_stop_event_;
   std::condition_variable job_done_event_;
   std::mutex mutex_;
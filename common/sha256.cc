@@ -0,0 +1,178 @@
+/*
+ * Copyright 2019 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "common/sha256.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+namespace ufg {
+namespace {
+constexpr uint32_t kRoundConstants[64] = {
+  0x428a2f98u, 0x71374491u, 0xb5c0fbcfu, 0xe9b5dba5u,
+  0x3956c25bu, 0x59f111f1u, 0x923f82a4u, 0xab1c5ed5u,
+  0xd807aa98u, 0x12835b01u, 0x243185beu, 0x550c7dc3u,
+  0x72be5d74u, 0x80deb1feu, 0x9bdc06a7u, 0xc19bf174u,
+  0xe49b69c1u, 0xefbe4786u, 0x0fc19dc6u, 0x240ca1ccu,
+  0x2de92c6fu, 0x4a7484aau, 0x5cb0a9dcu, 0x76f988dau,
+  0x983e5152u, 0xa831c66du, 0xb00327c8u, 0xbf597fc7u,
+  0xc6e00bf3u, 0xd5a79147u, 0x06ca6351u, 0x14292967u,
+  0x27b70a85u, 0x2e1b2138u, 0x4d2c6dfcu, 0x53380d13u,
+  0x650a7354u, 0x766a0abbu, 0x81c2c92eu, 0x92722c85u,
+  0xa2bfe8a1u, 0xa81a664bu, 0xc24b8b70u, 0xc76c51a3u,
+  0xd192e819u, 0xd6990624u, 0xf40e3585u, 0x106aa070u,
+  0x19a4c116u, 0x1e376c08u, 0x2748774cu, 0x34b0bcb5u,
+  0x391c0cb3u, 0x4ed8aa4au, 0x5b9cca4fu, 0x682e6ff3u,
+  0x748f82eeu, 0x78a5636fu, 0x84c87814u, 0x8cc70208u,
+  0x90befffau, 0xa4506cebu, 0xbef9a3f7u, 0xc67178f2u,
+};
+
+inline uint32_t RotateRight(uint32_t v, int n) {
+  return (v >> n) | (v << (32 - n));
+}
+}  // namespace
+
+constexpr size_t Sha256::kDigestSize;
+
+void Sha256::Reset() {
+  state_[0] = 0x6a09e667u;
+  state_[1] = 0xbb67ae85u;
+  state_[2] = 0x3c6ef372u;
+  state_[3] = 0xa54ff53au;
+  state_[4] = 0x510e527fu;
+  state_[5] = 0x9b05688cu;
+  state_[6] = 0x1f83d9abu;
+  state_[7] = 0x5be0cd19u;
+  total_size_ = 0;
+  block_size_ = 0;
+}
+
+void Sha256::Update(const void* data, size_t size) {
+  const uint8_t* src = static_cast<const uint8_t*>(data);
+  total_size_ += size;
+  if (block_size_ != 0) {
+    const size_t fill = std::min(size, sizeof(block_) - block_size_);
+    memcpy(block_ + block_size_, src, fill);
+    block_size_ += fill;
+    src += fill;
+    size -= fill;
+    if (block_size_ != sizeof(block_)) {
+      return;
+    }
+    ProcessBlock(block_);
+    block_size_ = 0;
+  }
+  while (size >= sizeof(block_)) {
+    ProcessBlock(src);
+    src += sizeof(block_);
+    size -= sizeof(block_);
+  }
+  memcpy(block_, src, size);
+  block_size_ = size;
+}
+
+std::string Sha256::FinishHex() {
+  // Pad with a 1 bit, zeros, and the message length in bits (big-endian).
+  const uint64_t bit_size = total_size_ * 8;
+  uint8_t pad[64 + 8] = {0x80};
+  const size_t pad_size =
+      (block_size_ < 56 ? 56 : 64 + 56) - block_size_;
+  for (size_t i = 0; i != 8; ++i) {
+    pad[pad_size + i] = static_cast<uint8_t>(bit_size >> (56 - 8 * i));
+  }
+  Update(pad, pad_size + 8);
+
+  static const char kHexDigits[] = "0123456789abcdef";
+  std::string hex(2 * kDigestSize, '0');
+  for (size_t i = 0; i != kDigestSize; ++i) {
+    const uint8_t byte =
+        static_cast<uint8_t>(state_[i / 4] >> (24 - 8 * (i % 4)));
+    hex[2 * i + 0] = kHexDigits[byte >> 4];
+    hex[2 * i + 1] = kHexDigits[byte & 0xf];
+  }
+  Reset();
+  return hex;
+}
+
+void Sha256::ProcessBlock(const uint8_t* block) {
+  uint32_t w[64];
+  for (size_t i = 0; i != 16; ++i) {
+    const uint8_t* const b = block + 4 * i;
+    w[i] = (static_cast<uint32_t>(b[0]) << 24) |
+           (static_cast<uint32_t>(b[1]) << 16) |
+           (static_cast<uint32_t>(b[2]) << 8) | static_cast<uint32_t>(b[3]);
+  }
+  for (size_t i = 16; i != 64; ++i) {
+    const uint32_t s0 = RotateRight(w[i - 15], 7) ^
+                        RotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    const uint32_t s1 = RotateRight(w[i - 2], 17) ^
+                        RotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+
+  uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3];
+  uint32_t e = state_[4], f = state_[5], g = state_[6], h = state_[7];
+  for (size_t i = 0; i != 64; ++i) {
+    const uint32_t s1 =
+        RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+    const uint32_t ch = (e & f) ^ (~e & g);
+    const uint32_t t1 = h + s1 + ch + kRoundConstants[i] + w[i];
+    const uint32_t s0 =
+        RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+    const uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+    const uint32_t t2 = s0 + maj;
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+  state_[0] += a;
+  state_[1] += b;
+  state_[2] += c;
+  state_[3] += d;
+  state_[4] += e;
+  state_[5] += f;
+  state_[6] += g;
+  state_[7] += h;
+}
+
+bool Sha256File(const char* path, std::string* out_hex) {
+  FILE* const file = fopen(path, "rb");
+  if (!file) {
+    return false;
+  }
+  Sha256 hash;
+  std::vector<uint8_t> buffer(1 << 16);
+  size_t read_size;
+  while ((read_size = fread(buffer.data(), 1, buffer.size(), file)) != 0) {
+    hash.Update(buffer.data(), read_size);
+  }
+  const bool success = ferror(file) == 0;
+  fclose(file);
+  if (!success) {
+    return false;
+  }
+  *out_hex = hash.FinishHex();
+  return true;
+}
+}  // namespace ufg
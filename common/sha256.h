@@ -0,0 +1,54 @@
+/*
+ * Copyright 2019 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef UFG_COMMON_SHA256_H_
+#define UFG_COMMON_SHA256_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace ufg {
+// Incremental SHA-256 hash, used to fingerprint conversion inputs. This matches
+// Python's hashlib.sha256, so tools can compare digests without the converter.
+class Sha256 {
+ public:
+  static constexpr size_t kDigestSize = 32;
+
+  Sha256() { Reset(); }
+  void Reset();
+  void Update(const void* data, size_t size);
+  void Update(const std::string& text) { Update(text.data(), text.size()); }
+
+  // Finish hashing and get the digest as a lower-case hex string. This resets
+  // the hash state.
+  std::string FinishHex();
+
+ private:
+  uint32_t state_[8];
+  uint64_t total_size_;
+  uint8_t block_[64];
+  size_t block_size_;
+
+  void ProcessBlock(const uint8_t* block);
+};
+
+// Hash the contents of a file, returning false if it can't be read.
+bool Sha256File(const char* path, std::string* out_hex);
+}  // namespace ufg
+
+#endif  // UFG_COMMON_SHA256_H_
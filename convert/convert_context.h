@@ -17,42 +17,182 @@
 #ifndef UFG_CONVERT_CONVERT_CONTEXT_H_
 #define UFG_CONVERT_CONVERT_CONTEXT_H_
 
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
 #include "common/common.h"
 #include "common/common_util.h"
 #include "common/config.h"
 #include "common/logging.h"
+#include "common/memory_tracker.h"
+#include "convert/convert_report.h"
 #include "convert/convert_util.h"
+#include "convert/image_prefetcher.h"
 #include "gltf/cache.h"
 #include "gltf/gltf.h"
+#include "process/image.h"
+#include "process/mesh.h"
+#include "pxr/usd/sdf/layer.h"
+#include "pxr/usd/usd/editTarget.h"
+#include "pxr/usd/usd/stage.h"
 
 namespace ufg {
+using PXR_NS::SdfLayerRefPtr;
+using PXR_NS::UsdEditTarget;
 using PXR_NS::UsdStageRefPtr;
 
+// Layers that content is split into when ConvertSettings::split_layers is set.
+enum ContentLayer : uint8_t {
+  kContentLayerRoot,       // Hierarchy, extents, and stage metadata.
+  kContentLayerGeometry,   // Mesh vertex and index data.
+  kContentLayerMaterials,  // Materials, shaders, and material bindings.
+  kContentLayerAnimation,  // Skeletons, skinning, and animated transforms.
+  kContentLayerCount
+};
+
+// Get the suffix appended to the output file name for a content layer.
+inline const char* GetContentLayerSuffix(ContentLayer layer) {
+  static const char* const kSuffixes[] = {"", "_geom", "_mtl", "_anim"};
+  static_assert(UFG_ARRAY_SIZE(kSuffixes) == kContentLayerCount, "");
+  return kSuffixes[layer];
+}
+
+// Settings-independent conversion data. This may be shared between multiple
+// conversions of the same glTF that differ only in settings, so the source is
+// only loaded and decoded once.
+struct ConvertShared {
+  // Forwards GltfCache memory changes to a tracker. This is declared before the
+  // cache, so it outlives it.
+  class CacheMemoryObserver : public GltfCache::MemoryObserver {
+   public:
+    explicit CacheMemoryObserver(MemoryTracker* tracker) : tracker_(tracker) {}
+    void OnMemoryChange(Type type, ptrdiff_t delta) override {
+      const MemoryTag tag =
+          type == kTypeFile ? kMemoryGltfFiles : kMemoryGltfContent;
+      if (delta >= 0) {
+        tracker_->Add(tag, static_cast<size_t>(delta));
+      } else {
+        tracker_->Remove(tag, static_cast<size_t>(-delta));
+      }
+    }
+
+   private:
+    MemoryTracker* tracker_;
+  };
+  std::unique_ptr<CacheMemoryObserver> cache_memory_observer;
+
+  GltfCache gltf_cache;
+
+  // Per-mesh info, populated by the first conversion.
+  bool have_mesh_infos = false;
+  std::vector<MeshInfo> mesh_infos;
+
+  // Decoded source images, keyed by image ID. Images that failed to decode are
+  // stored as null so they aren't decoded (or reported) again.
+  std::map<Gltf::Id, std::shared_ptr<const Image>> images;
+
+  // Messages logged while loading images that failed, so they're repeated for
+  // each conversion that references them.
+  std::map<Gltf::Id, std::vector<Message>> image_errors;
+
+  // Bytes held by mesh_infos and images, charged to the memory tracker.
+  MemoryCharge mesh_memory{kMemoryMeshes};
+  MemoryCharge image_memory{kMemorySrcImages};
+
+  void Reset(const Gltf* gltf = nullptr, GltfStream* stream = nullptr) {
+    gltf_cache.Reset(gltf, stream);
+    have_mesh_infos = false;
+    mesh_infos.clear();
+    images.clear();
+    image_errors.clear();
+    mesh_memory.Release();
+    image_memory.Release();
+  }
+
+  // Charge memory held by shared data to a tracker, which may be null. The
+  // tracker isn't owned, and must outlive this.
+  void SetMemoryTracker(MemoryTracker* tracker) {
+    if (tracker == mesh_memory.GetTracker()) {
+      return;
+    }
+    std::unique_ptr<CacheMemoryObserver> observer(
+        tracker ? new CacheMemoryObserver(tracker) : nullptr);
+    gltf_cache.SetMemoryObserver(observer.get());
+    cache_memory_observer = std::move(observer);
+    mesh_memory.SetTracker(tracker);
+    image_memory.SetTracker(tracker);
+  }
+};
+
 struct ConvertContext {
   std::string src_dir;
   std::string dst_dir;
   ConvertSettings settings;
   const Gltf* gltf;
   PathTable path_table;
-  GltfCache gltf_cache;
+  ConvertShared* shared;
+  GltfCache* gltf_cache;
+  // Source images being read in the background, or null if prefetch is
+  // disabled.
+  ImagePrefetcher* image_prefetcher;
   Logger* logger;
   GltfOnceLogger once_logger;
   UsdStageRefPtr stage;
   SdfPath root_path;
 
+  // Layers for each type of content, if content is split into layers. These
+  // are null if all content is written to the root layer.
+  SdfLayerRefPtr content_layers[kContentLayerCount];
+
+  // Statistics for the conversion report.
+  ConvertStats stats;
+
   void Reset(Logger* logger) {
     src_dir.clear();
     dst_dir.clear();
     settings = ConvertSettings::kDefault;
     gltf = nullptr;
     path_table.Clear();
-    gltf_cache.Reset();
+    shared = nullptr;
+    gltf_cache = nullptr;
+    image_prefetcher = nullptr;
     this->logger = logger;
     once_logger.Reset(logger);
     stage = UsdStageRefPtr();
     root_path = SdfPath::EmptyPath();
+    for (SdfLayerRefPtr& content_layer : content_layers) {
+      content_layer = SdfLayerRefPtr();
+    }
+    stats = ConvertStats();
   }
 };
+
+// Directs USD authoring to a content layer within a local scope. This has no
+// effect if content isn't split into layers.
+class ContentLayerSentry {
+ public:
+  ContentLayerSentry(const ConvertContext* cc, ContentLayer layer)
+      : stage_(cc->stage) {
+    const SdfLayerRefPtr& content_layer = cc->content_layers[layer];
+    if (content_layer) {
+      active_ = true;
+      old_target_ = stage_->GetEditTarget();
+      stage_->SetEditTarget(UsdEditTarget(content_layer));
+    }
+  }
+
+  ~ContentLayerSentry() {
+    if (active_) {
+      stage_->SetEditTarget(old_target_);
+    }
+  }
+
+ private:
+  UsdStageRefPtr stage_;
+  UsdEditTarget old_target_;
+  bool active_ = false;
+};
 }  // namespace ufg
 
 #endif  // UFG_CONVERT_CONVERT_CONTEXT_H_
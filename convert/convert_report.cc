@@ -0,0 +1,231 @@
+/*
+ * Copyright 2019 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "convert/convert_report.h"
+
+#include <stdio.h>
+#include "common/platform.h"
+#include "common/sha256.h"
+
+namespace ufg {
+namespace {
+std::string EscapeJson(const std::string& text) {
+  std::string escaped;
+  escaped.reserve(text.size());
+  for (const char c : text) {
+    switch (c) {
+    case '"':
+      escaped += "\\\"";
+      break;
+    case '\\':
+      escaped += "\\\\";
+      break;
+    case '\n':
+      escaped += "\\n";
+      break;
+    case '\t':
+      escaped += "\\t";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        char code[8];
+        snprintf(code, sizeof(code), "\\u%04x",
+                 static_cast<unsigned int>(static_cast<unsigned char>(c)));
+        escaped += code;
+      } else {
+        escaped += c;
+      }
+      break;
+    }
+  }
+  return escaped;
+}
+
+void WriteReport(const ConvertReport& report, FILE* file) {
+  const ConvertStats& stats = report.stats;
+  fprintf(file, "    {\n");
+  fprintf(file, "      \"src\": \"%s\",\n", EscapeJson(report.src_path).c_str());
+  fprintf(file, "      \"dst\": \"%s\",\n", EscapeJson(report.dst_path).c_str());
+  fprintf(file, "      \"success\": %s,\n", report.success ? "true" : "false");
+  if (stats.cancel_phase != kPhaseCount) {
+    fprintf(file, "      \"cancel_phase\": \"%s\",\n",
+            kPhaseNames[stats.cancel_phase]);
+  } else {
+    fprintf(file, "      \"cancel_phase\": null,\n");
+  }
+  fprintf(file, "      \"phase_seconds\": {");
+  for (size_t i = 0; i != kPhaseCount; ++i) {
+    fprintf(file, "%s\"%s\": %.6f", i == 0 ? "" : ", ", kPhaseNames[i],
+            stats.phase_seconds[i]);
+  }
+  fprintf(file, "},\n");
+  fprintf(file, "      \"peak_rss\": %zu,\n", report.peak_rss);
+  fprintf(file, "      \"memory_peaks\": {");
+  for (size_t i = 0; i != kMemoryTagCount; ++i) {
+    fprintf(file, "\"%s\": %zu, ", kMemoryTagNames[i], report.memory_peaks[i]);
+  }
+  fprintf(file, "\"total\": %zu},\n", report.memory_peak);
+  fprintf(file, "      \"bytes_read\": %zu,\n", stats.bytes_read);
+  fprintf(file, "      \"bytes_written\": %zu,\n", report.bytes_written);
+  fprintf(file, "      \"nodes\": %zu,\n", stats.node_count);
+  fprintf(file, "      \"meshes\": %zu,\n", stats.mesh_count);
+  fprintf(file, "      \"prims\": %zu,\n", stats.prim_count);
+  fprintf(file, "      \"src_verts\": %zu,\n", stats.src_vert_count);
+  fprintf(file, "      \"used_verts\": %zu,\n", stats.used_vert_count);
+  fprintf(file, "      \"images_decoded\": %zu,\n", stats.images_decoded);
+  fprintf(file, "      \"images_copied\": %zu,\n", stats.images_copied);
+  fprintf(file, "      \"images_resized\": %zu,\n", stats.images_resized);
+  fprintf(file, "      \"images_solid\": %zu,\n", stats.images_solid);
+  fprintf(file, "      \"image_scale\": %g,\n", stats.image_scale);
+  fprintf(file, "      \"anim_src_keys\": %zu,\n", stats.anim_src_keys);
+  fprintf(file, "      \"anim_pruned_keys\": %zu\n", stats.anim_pruned_keys);
+  fprintf(file, "    }");
+}
+
+void WriteManifestOutput(const ConvertReport& report, FILE* file,
+                         Logger* logger) {
+  const std::string src = EscapeJson(report.src_path);
+  const std::string dst = EscapeJson(report.dst_path);
+  fprintf(file, "    {\n");
+  fprintf(file, "      \"src\": \"%s\",\n", src.c_str());
+  fprintf(file, "      \"dst\": \"%s\",\n", dst.c_str());
+  fprintf(file, "      \"success\": %s,\n", report.success ? "true" : "false");
+  fprintf(file, "      \"inputs\": [");
+  const std::vector<std::string>& paths = report.src_dependencies;
+  const std::vector<std::string>& missing_paths =
+      report.src_missing_dependencies;
+  for (size_t i = 0; i != paths.size(); ++i) {
+    const char* const path = paths[i].c_str();
+    std::string hash;
+    fprintf(file, "%s\n        {\"path\": \"%s\", \"size\": %zu, ",
+            i == 0 ? "" : ",", EscapeJson(paths[i]).c_str(),
+            GetFileSize(path));
+    if (Sha256File(path, &hash)) {
+      fprintf(file, "\"sha256\": \"%s\"}", hash.c_str());
+    } else {
+      // A null hash never matches, so the output is treated as stale.
+      Log<UFG_WARN_IO_HASH>(logger, "", path);
+      fprintf(file, "\"sha256\": null}");
+    }
+  }
+  // Files that were looked up but not found are recorded so the output is
+  // treated as stale if they appear.
+  for (size_t i = 0; i != missing_paths.size(); ++i) {
+    fprintf(file, "%s\n        {\"path\": \"%s\", \"missing\": true}",
+            paths.empty() && i == 0 ? "" : ",",
+            EscapeJson(missing_paths[i]).c_str());
+  }
+  fprintf(file, paths.empty() && missing_paths.empty() ? "]\n"
+                                                       : "\n      ]\n");
+  fprintf(file, "    }");
+}
+}  // namespace
+
+const char* const kPhaseNames[kPhaseCount] = {
+  "load",        // kPhaseLoad
+  "meshes",      // kPhaseMeshes
+  "animation",   // kPhaseAnimation
+  "nodes",       // kPhaseNodes
+  "textures",    // kPhaseTextures
+  "write",       // kPhaseWrite
+};
+
+PhaseSentry::~PhaseSentry() {
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - time_begin_;
+  *seconds_ += elapsed.count();
+  if (trace_memory_) {
+    Log<UFG_INFO_MEMORY>(logger_, "", kPhaseNames[phase_],
+                         trace_memory_->GetSummary().c_str());
+  }
+}
+
+void LogCancel(const CancelToken* token, float timeout,
+               const MemoryTracker* memory_tracker, ConvertPhase phase,
+               Logger* logger) {
+  static constexpr size_t kMiB = 1024 * 1024;
+  const char* const phase_name =
+      phase < kPhaseCount ? kPhaseNames[phase] : "setup";
+  if (memory_tracker && memory_tracker->IsLimitExceeded()) {
+    const MemoryTag tag = memory_tracker->GetLargestTag();
+    Log<UFG_ERROR_MEMORY_LIMIT>(logger, "", memory_tracker->GetLimit() / kMiB,
+                                phase_name, kMemoryTagNames[tag],
+                                memory_tracker->GetCurrent(tag) / kMiB);
+  } else if (token && token->IsExpired()) {
+    Log<UFG_ERROR_TIMEOUT>(logger, "", timeout, phase_name);
+  } else {
+    Log<UFG_ERROR_CANCELLED>(logger, "", phase_name);
+  }
+}
+
+void RecordMemoryPeaks(const MemoryTracker& memory_tracker,
+                       ConvertReport* report) {
+  for (size_t i = 0; i != kMemoryTagCount; ++i) {
+    report->memory_peaks[i] =
+        memory_tracker.GetPeak(static_cast<MemoryTag>(i));
+  }
+  report->memory_peak = memory_tracker.GetTotalPeak();
+}
+
+bool WriteConvertReports(const char* path,
+                         const std::vector<ConvertReport>& reports,
+                         Logger* logger) {
+  FILE* const file = fopen(path, "w");
+  if (!file) {
+    Log<UFG_ERROR_IO_WRITE_REPORT>(logger, "", path);
+    return false;
+  }
+  fprintf(file, "{\n  \"reports\": [\n");
+  for (size_t i = 0; i != reports.size(); ++i) {
+    WriteReport(reports[i], file);
+    fprintf(file, i + 1 == reports.size() ? "\n" : ",\n");
+  }
+  fprintf(file, "  ]\n}\n");
+  const bool success = ferror(file) == 0;
+  fclose(file);
+  if (!success) {
+    Log<UFG_ERROR_IO_WRITE_REPORT>(logger, "", path);
+  }
+  return success;
+}
+
+bool WriteConvertManifest(const char* path, const char* version,
+                          const std::string& settings_digest,
+                          const std::vector<ConvertReport>& reports,
+                          Logger* logger) {
+  FILE* const file = fopen(path, "w");
+  if (!file) {
+    Log<UFG_ERROR_IO_WRITE_MANIFEST>(logger, "", path);
+    return false;
+  }
+  fprintf(file, "{\n");
+  fprintf(file, "  \"version\": \"%s\",\n", EscapeJson(version).c_str());
+  fprintf(file, "  \"settings_digest\": \"%s\",\n",
+          EscapeJson(settings_digest).c_str());
+  fprintf(file, "  \"outputs\": [\n");
+  for (size_t i = 0; i != reports.size(); ++i) {
+    WriteManifestOutput(reports[i], file, logger);
+    fprintf(file, i + 1 == reports.size() ? "\n" : ",\n");
+  }
+  fprintf(file, "  ]\n}\n");
+  const bool success = ferror(file) == 0;
+  fclose(file);
+  if (!success) {
+    Log<UFG_ERROR_IO_WRITE_MANIFEST>(logger, "", path);
+  }
+  return success;
+}
+}  // namespace ufg
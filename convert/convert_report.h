@@ -0,0 +1,146 @@
+/*
+ * Copyright 2019 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UFG_CONVERT_CONVERT_REPORT_H_
+#define UFG_CONVERT_CONVERT_REPORT_H_
+
+#include <chrono>  // NOLINT: Unapproved C++11 header.
+#include <string>
+#include <vector>
+#include "common/cancel.h"
+#include "common/common.h"
+#include "common/logging.h"
+#include "common/memory_tracker.h"
+
+namespace ufg {
+// Conversion phases timed in the report.
+enum ConvertPhase : uint8_t {
+  kPhaseLoad,        // Read and validate glTF.
+  kPhaseMeshes,      // Decode mesh primitives.
+  kPhaseAnimation,   // Read and resample animation.
+  kPhaseNodes,       // Create node hierarchy, meshes, and materials.
+  kPhaseTextures,    // Process and write textures.
+  kPhaseWrite,       // Write and package USD.
+  kPhaseCount
+};
+
+extern const char* const kPhaseNames[kPhaseCount];
+
+// Content statistics gathered during conversion.
+struct ConvertStats {
+  // Wall-clock time spent in each phase, in seconds.
+  double phase_seconds[kPhaseCount] = {};
+
+  // The most recently started phase, or kPhaseCount before the first.
+  ConvertPhase active_phase = kPhaseCount;
+
+  // The phase a cancelled conversion stopped in, or kPhaseCount if the
+  // conversion wasn't cancelled.
+  ConvertPhase cancel_phase = kPhaseCount;
+
+  // Bytes read from the source glTF and the files it references.
+  size_t bytes_read = 0;
+
+  size_t node_count = 0;
+  size_t mesh_count = 0;
+  size_t prim_count = 0;
+
+  // Vertex counts before and after removing vertices unreferenced by indices.
+  size_t src_vert_count = 0;
+  size_t used_vert_count = 0;
+
+  size_t images_decoded = 0;
+  size_t images_copied = 0;   // Copied to the output without processing.
+  size_t images_resized = 0;
+  size_t images_solid = 0;    // Reduced to 1x1 or a constant shader input.
+
+  // Smallest scale applied to fit images in the decompressed size limit.
+  float image_scale = 1.0f;
+
+  // Animation keys before and after pruning.
+  size_t anim_src_keys = 0;
+  size_t anim_pruned_keys = 0;
+};
+
+// Report for a single glTF->USD conversion.
+struct ConvertReport {
+  std::string src_path;
+  std::string dst_path;
+  bool success = false;
+  ConvertStats stats;
+  size_t bytes_written = 0;
+  size_t peak_rss = 0;
+  // Peak bytes charged to the memory tracker, per tag and in total.
+  size_t memory_peaks[kMemoryTagCount] = {};
+  size_t memory_peak = 0;
+  // Canonical paths of the source files the output depends on.
+  std::vector<std::string> src_dependencies;
+  // Canonical paths of referenced source files that didn't exist. Creating
+  // one of these may change the output.
+  std::vector<std::string> src_missing_dependencies;
+};
+
+// Accumulates wall-clock time into a phase for the lifetime of the sentry.
+// * If trace_memory is set, memory usage is logged when the phase ends.
+class PhaseSentry {
+ public:
+  PhaseSentry(ConvertStats* stats, ConvertPhase phase,
+              const MemoryTracker* trace_memory = nullptr,
+              Logger* logger = nullptr)
+      : phase_(phase),
+        seconds_(&stats->phase_seconds[phase]),
+        time_begin_(std::chrono::steady_clock::now()),
+        trace_memory_(trace_memory),
+        logger_(logger) {
+    stats->active_phase = phase;
+  }
+  ~PhaseSentry();
+
+ private:
+  ConvertPhase phase_;
+  double* seconds_;
+  std::chrono::steady_clock::time_point time_begin_;
+  const MemoryTracker* trace_memory_;
+  Logger* logger_;
+};
+
+// Log that a conversion was cancelled, timed out, or exceeded its memory limit
+// in the given phase.
+// * timeout is the ConvertSettings::timeout the token's deadline was set from.
+// * memory_tracker may be null.
+void LogCancel(const CancelToken* token, float timeout,
+               const MemoryTracker* memory_tracker, ConvertPhase phase,
+               Logger* logger);
+
+// Record the memory tracker's peaks in the report.
+void RecordMemoryPeaks(const MemoryTracker& memory_tracker,
+                       ConvertReport* report);
+
+// Write reports to a JSON file.
+bool WriteConvertReports(const char* path,
+                         const std::vector<ConvertReport>& reports,
+                         Logger* logger);
+
+// Write a dependency manifest to a JSON file, listing the size and SHA-256 of
+// each report's source dependencies alongside the converter version and
+// settings digest.
+bool WriteConvertManifest(const char* path, const char* version,
+                          const std::string& settings_digest,
+                          const std::vector<ConvertReport>& reports,
+                          Logger* logger);
+}  // namespace ufg
+
+#endif  // UFG_CONVERT_CONVERT_REPORT_H_
@@ -21,6 +21,15 @@
 #include "pxr/base/tf/stringUtils.h"
 
 namespace ufg {
+const char* const kHalfTypeNames[kHalfCount] = {
+    "UVs",           // kHalfUv
+    "normals",       // kHalfNormal
+    "skin weights",  // kHalfWeight
+    "translations",  // kHalfTranslation
+    "rotations",     // kHalfRotation
+    "scales",        // kHalfScale
+};
+
 std::string MakeValidUsdName(const char* prefix, const std::string& in,
                              size_t index) {
   return in.empty() ? AppendNumber(prefix, index)
@@ -34,24 +43,22 @@ UsdTimeCode GetTimeCode(float t) {
 }
 
 void PathTable::Clear() {
-  paths_.clear();
+  children_.clear();
 }
 
-std::string PathTable::MakeUnique(const SdfPath& parent_path,
-                                  const char* prefix, const std::string& in,
-                                  size_t index) {
+SdfPath PathTable::MakeUnique(const SdfPath& parent_path, const char* prefix,
+                              const std::string& in, size_t index) {
+  Children& children = children_[parent_path];
   const std::string orig_name = MakeValidUsdName(prefix, in, index);
-  std::string name = orig_name;
-  size_t duplicate_count = 0;
-  for (;;) {
-    const SdfPath path = parent_path.AppendElementString(name);
-    const std::string& path_str = path.GetString();
-    const auto insert_result = paths_.insert(path_str);
-    if (insert_result.second) {
-      return path_str;
-    }
-    name = AppendNumber(orig_name + '_', ++duplicate_count);
+  const TfToken orig_token(orig_name);
+  TfToken name = orig_token;
+  if (!children.names.insert(name).second) {
+    size_t& duplicate_count = children.next_suffixes[orig_token];
+    do {
+      name = TfToken(AppendNumber(orig_name + '_', ++duplicate_count));
+    } while (!children.names.insert(name).second);
   }
+  return parent_path.AppendChild(name);
 }
 
 }  // namespace ufg
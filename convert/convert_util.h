@@ -17,12 +17,15 @@
 #ifndef UFG_CONVERT_CONVERT_UTIL_H_
 #define UFG_CONVERT_CONVERT_UTIL_H_
 
+#include <algorithm>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include "convert/convert_common.h"
 #include "convert/tokens.h"
 #include "gltf/gltf.h"
 #include "pxr/base/tf/token.h"
+#include "pxr/usd/sdf/path.h"
 #include "pxr/usd/sdf/types.h"
 #include "pxr/usd/usd/timeCode.h"
 #include "pxr/usd/usdShade/shader.h"
@@ -53,14 +56,54 @@ void CreateEnumInput(const TfToken& name_tok, T value,
 
 UsdTimeCode GetTimeCode(float t);
 
+// Types of data that may be written at half precision.
+enum HalfType : uint8_t {
+  kHalfUv,
+  kHalfNormal,
+  kHalfWeight,
+  kHalfTranslation,
+  kHalfRotation,
+  kHalfScale,
+  kHalfCount
+};
+
+extern const char* const kHalfTypeNames[kHalfCount];
+
+// Error stats for data written at half precision, used for reporting.
+struct HalfStats {
+  // Number of arrays or animation channels written at half precision.
+  size_t half_count = 0;
+  // Number of arrays or animation channels considered.
+  size_t total_count = 0;
+  // Maximum per-component error of values written at half precision.
+  float max_error = 0.0f;
+
+  void Add(bool is_half, float error) {
+    ++total_count;
+    if (is_half) {
+      ++half_count;
+      max_error = std::max(max_error, error);
+    }
+  }
+};
+
+// Generates unique child paths. Names are tracked per parent as interned
+// tokens, so the cost of each lookup is independent of the path depth.
 class PathTable {
  public:
   void Clear();
-  std::string MakeUnique(const SdfPath& parent_path, const char* prefix,
-                         const std::string& in, size_t index);
+  SdfPath MakeUnique(const SdfPath& parent_path, const char* prefix,
+                     const std::string& in, size_t index);
 
  private:
-  std::unordered_set<std::string> paths_;
+  using NameSet = std::unordered_set<TfToken, TfToken::HashFunctor>;
+  struct Children {
+    NameSet names;
+    // Next duplicate suffix to try for each base name, so repeated names don't
+    // rescan suffixes that are already taken.
+    std::unordered_map<TfToken, size_t, TfToken::HashFunctor> next_suffixes;
+  };
+  std::unordered_map<SdfPath, Children, SdfPath::Hash> children_;
 };
 }  // namespace ufg
 
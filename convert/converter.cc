@@ -23,28 +23,40 @@
 #include "process/mesh.h"
 #include "process/process_util.h"
 #include "process/skin.h"
+#include "pxr/base/gf/half.h"
+#include "pxr/base/gf/vec2h.h"
+#include "pxr/base/gf/vec3h.h"
 #include "pxr/base/vt/value.h"
 #include "pxr/usd/sdf/types.h"
 #include "pxr/usd/usd/attribute.h"
 #include "pxr/usd/usd/modelAPI.h"
+#include "pxr/usd/usd/relationship.h"
 #include "pxr/usd/usd/stage.h"
 #include "pxr/usd/usdGeom/mesh.h"
 #include "pxr/usd/usdGeom/metrics.h"
+#include "pxr/usd/usdGeom/modelAPI.h"
 #include "pxr/usd/usdGeom/scope.h"
 #include "pxr/usd/usdGeom/tokens.h"
 #include "pxr/usd/usdGeom/xform.h"
 #include "pxr/usd/usdShade/materialBindingAPI.h"
 #include "pxr/usd/usdSkel/animation.h"
 #include "pxr/usd/usdSkel/bindingAPI.h"
+#include "pxr/usd/usdSkel/blendShape.h"
 #include "pxr/usd/usdSkel/root.h"
 #include "pxr/usd/usdSkel/skeleton.h"
 
 namespace ufg {
+using PXR_NS::GfHalf;
+using PXR_NS::GfRange3d;
+using PXR_NS::GfVec2h;
+using PXR_NS::GfVec3h;
 using PXR_NS::SdfAssetPath;
+using PXR_NS::SdfLayer;
 using PXR_NS::SdfValueTypeNames;
 using PXR_NS::TfMakeValidIdentifier;
 using PXR_NS::UsdAttribute;
 using PXR_NS::UsdGeomMesh;
+using PXR_NS::UsdGeomModelAPI;
 using PXR_NS::UsdGeomPrimvar;
 using PXR_NS::UsdGeomScope;
 using PXR_NS::UsdGeomSetStageUpAxis;
@@ -53,10 +65,12 @@ using PXR_NS::UsdGeomXform;
 using PXR_NS::UsdGeomXformOp;
 using PXR_NS::UsdModelAPI;
 using PXR_NS::UsdPrim;
+using PXR_NS::UsdRelationship;
 using PXR_NS::UsdShadeInput;
 using PXR_NS::UsdShadeMaterialBindingAPI;
 using PXR_NS::UsdSkelAnimation;
 using PXR_NS::UsdSkelBindingAPI;
+using PXR_NS::UsdSkelBlendShape;
 using PXR_NS::UsdSkelRoot;
 using PXR_NS::UsdSkelSkeleton;
 using PXR_NS::UsdStage;
@@ -109,129 +123,307 @@ Gltf::Id GetAnimId(const Gltf& gltf, const ConvertSettings& settings) {
                                                           : Gltf::Id::kNull;
 }
 
+// Get IDs of images referenced by the materials of meshes under scene nodes,
+// excluding images that were already decoded.
+std::vector<Gltf::Id> GetUsedImageIds(
+    const Gltf& gltf, const std::vector<Gltf::Id>& scene_nodes,
+    const std::map<Gltf::Id, std::shared_ptr<const Image>>& decoded) {
+  std::vector<bool> materials_used(gltf.materials.size(), false);
+  for (const Gltf::Id node_id : scene_nodes) {
+    const Gltf::Node* const node = Gltf::GetById(gltf.nodes, node_id);
+    const Gltf::Mesh* const mesh =
+        node ? Gltf::GetById(gltf.meshes, node->mesh) : nullptr;
+    if (!mesh) {
+      continue;
+    }
+    for (const Gltf::Mesh::Primitive& prim : mesh->primitives) {
+      if (Gltf::IsValidId(gltf.materials, prim.material)) {
+        materials_used[Gltf::IdToIndex(prim.material)] = true;
+      }
+    }
+  }
+
+  std::vector<bool> images_used(gltf.images.size(), false);
+  std::vector<Gltf::Id> image_ids;
+  for (size_t i = 0; i != gltf.materials.size(); ++i) {
+    if (!materials_used[i]) {
+      continue;
+    }
+    const Gltf::Material& material = gltf.materials[i];
+    const Gltf::Material::Texture* inputs[] = {
+        &material.pbr.baseColorTexture, &material.pbr.metallicRoughnessTexture,
+        &material.normalTexture, &material.occlusionTexture,
+        &material.emissiveTexture, nullptr, nullptr};
+    if (material.pbr.specGloss) {
+      inputs[5] = &material.pbr.specGloss->diffuseTexture;
+      inputs[6] = &material.pbr.specGloss->specularGlossinessTexture;
+    }
+    for (const Gltf::Material::Texture* const input : inputs) {
+      const Gltf::Texture* const texture =
+          input ? Gltf::GetById(gltf.textures, input->index) : nullptr;
+      if (!texture || !Gltf::IsValidId(gltf.images, texture->source)) {
+        continue;
+      }
+      const size_t image_index = Gltf::IdToIndex(texture->source);
+      if (!images_used[image_index] &&
+          decoded.find(texture->source) == decoded.end()) {
+        images_used[image_index] = true;
+        image_ids.push_back(texture->source);
+      }
+    }
+  }
+  return image_ids;
+}
+
+// Get the maximum per-component error from converting vectors to half
+// precision.
+template <typename Vec>
+float GetHalfError(const Vec* values, size_t count) {
+  float max_error = 0.0f;
+  for (size_t i = 0; i != count; ++i) {
+    for (size_t c = 0; c != Vec::dimension; ++c) {
+      const float value = values[i][c];
+      const float error = std::abs(static_cast<float>(GfHalf(value)) - value);
+      // Comparison ordered so NaN errors (e.g. from overflow) propagate.
+      if (!(error <= max_error)) {
+        max_error = error;
+      }
+    }
+  }
+  return max_error;
+}
+
+// Determine if values can be written at half precision within tolerance,
+// recording error stats. Half precision is disabled if stats is null.
+template <typename Vec>
+bool UseHalf(const Vec* values, size_t count, float tol, HalfStats* stats) {
+  if (!stats) {
+    return false;
+  }
+  const float error = GetHalfError(values, count);
+  const bool is_half = error <= tol;
+  stats->Add(is_half, error);
+  return is_half;
+}
+
+template <typename HalfVec, typename Vec>
+VtArray<HalfVec> ToHalf(const VtArray<Vec>& values) {
+  const size_t count = values.size();
+  VtArray<HalfVec> half_values(count);
+  for (size_t i = 0; i != count; ++i) {
+    half_values[i] = HalfVec(values[i]);
+  }
+  return half_values;
+}
+
+UsdGeomXformOp::Precision GetOpPrecision(bool is_half) {
+  return is_half ? UsdGeomXformOp::PrecisionHalf
+                 : UsdGeomXformOp::PrecisionFloat;
+}
+
+void SetOpValue(const UsdGeomXformOp& op, const GfVec3f& value, bool is_half,
+                UsdTimeCode time = UsdTimeCode::Default()) {
+  if (is_half) {
+    op.Set(GfVec3h(value), time);
+  } else {
+    op.Set(value, time);
+  }
+}
+
+// Quantize skin weights to multiples of step, adjusting the largest weight for
+// each vertex to preserve the total. Returns the maximum error.
+float QuantizeSkinWeights(size_t influence_count, float step,
+                          VtArray<float>* weights) {
+  UFG_ASSERT_LOGIC(influence_count > 0);
+  const float inv_step = 1.0f / step;
+  const size_t vert_count = weights->size() / influence_count;
+  float max_error = 0.0f;
+  for (size_t vert_index = 0; vert_index != vert_count; ++vert_index) {
+    float* const vert_weights = weights->data() + vert_index * influence_count;
+    float total_error = 0.0f;
+    size_t max_index = 0;
+    float max_orig = vert_weights[0];
+    for (size_t i = 0; i != influence_count; ++i) {
+      const float orig = vert_weights[i];
+      const float quantized = std::round(orig * inv_step) * step;
+      vert_weights[i] = quantized;
+      total_error += orig - quantized;
+      max_error = std::max(max_error, std::abs(orig - quantized));
+      if (orig > max_orig) {
+        max_index = i;
+        max_orig = orig;
+      }
+    }
+    float& max_weight = vert_weights[max_index];
+    max_weight = std::max(
+        max_weight + std::round(total_error * inv_step) * step, 0.0f);
+    max_error = std::max(max_error, std::abs(max_orig - max_weight));
+  }
+  return max_error;
+}
+
+// Accumulate animation key counts before and after pruning.
+template <typename Stream>
+void AddKeyStats(size_t src_count, const Stream& stream,
+                 size_t pruned_count, ConvertStats* stats) {
+  stats->anim_src_keys += src_count;
+  stats->anim_pruned_keys += stream.IsPrunedConstant() ? 1 : pruned_count;
+}
+
 void SetTranslationKeys(const UsdGeomXform& xform, const GfVec3f& initial_point,
                         const std::vector<float>& times,
-                        const std::vector<GfVec3f>& points) {
+                        const std::vector<GfVec3f>& points,
+                        HalfStats* half_stats, ConvertStats* stats,
+                        const CancelToken* cancel) {
   const size_t src_count = times.size();
   if (src_count == 0) {
     if (!NearlyEqual(initial_point, kDefaultTranslation,
                      kDefaultTranslationTol)) {
-      const UsdGeomXformOp op =
-          xform.AddTranslateOp(UsdGeomXformOp::PrecisionFloat);
-      op.Set(initial_point);
+      const bool is_half =
+          UseHalf(&initial_point, 1, kHalfTranslationTol, half_stats);
+      const UsdGeomXformOp op = xform.AddTranslateOp(GetOpPrecision(is_half));
+      SetOpValue(op, initial_point, is_half);
     }
     return;
   }
   UFG_ASSERT_LOGIC(points.size() == src_count);
   TranslationPrunerStream stream(times.data(), points.data());
-  PruneAnimationKeys(src_count, &stream);
-  const UsdGeomXformOp op =
-      xform.AddTranslateOp(UsdGeomXformOp::PrecisionFloat);
+  PruneAnimationKeys(src_count, &stream, cancel);
+  AddKeyStats(src_count, stream, stream.times.size(), stats);
+  const bool is_half = UseHalf(stream.points.data(), stream.points.size(),
+                               kHalfTranslationTol, half_stats);
+  const UsdGeomXformOp op = xform.AddTranslateOp(GetOpPrecision(is_half));
   if (stream.IsPrunedConstant()) {
-    op.Set(stream.points[0]);
+    SetOpValue(op, stream.points[0], is_half);
   } else {
     const size_t pruned_count = stream.times.size();
     for (size_t i = 0; i != pruned_count; ++i) {
-      op.Set(stream.points[i], GetTimeCode(stream.times[i]));
+      SetOpValue(op, stream.points[i], is_half, GetTimeCode(stream.times[i]));
     }
   }
 }
 
 void SetRotationKeys(const UsdGeomXform& xform, const GfQuatf& initial_point,
                      const std::vector<float>& times,
-                     const std::vector<GfQuatf>& points) {
+                     const std::vector<GfQuatf>& points,
+                     HalfStats* half_stats, ConvertStats* stats,
+                     const CancelToken* cancel) {
   const size_t quat_count = times.size();
   if (quat_count == 0) {
     const GfVec3f initial_euler = QuatToEuler(initial_point);
     if (!NearlyEqual(initial_euler, kDefaultEuler, kDefaultEulerTol)) {
-      const UsdGeomXformOp op =
-          xform.AddRotateXYZOp(UsdGeomXformOp::PrecisionFloat);
-      op.Set(RadToDeg(initial_euler));
+      const GfVec3f initial_degrees = RadToDeg(initial_euler);
+      const bool is_half =
+          UseHalf(&initial_degrees, 1, kHalfRotationTol, half_stats);
+      const UsdGeomXformOp op = xform.AddRotateXYZOp(GetOpPrecision(is_half));
+      SetOpValue(op, initial_degrees, is_half);
     }
     return;
   }
   UFG_ASSERT_LOGIC(points.size() == quat_count);
 
-  // TODO: Set basis.
-  const UsdGeomXformOp op =
-      xform.AddRotateXYZOp(UsdGeomXformOp::PrecisionFloat);
-
   // Prune quaternions, then convert to Euler.
   QuatPrunerStream stream(times.data(), points.data());
-  PruneAnimationKeys(quat_count, &stream);
+  PruneAnimationKeys(quat_count, &stream, cancel);
+  AddKeyStats(quat_count, stream, stream.times.size(), stats);
   std::vector<float> euler_times;
   std::vector<GfVec3f> eulers;
   ConvertRotationKeys(stream.times, stream.points, &euler_times, &eulers);
+  for (GfVec3f& euler : eulers) {
+    euler = GfVec3f(RadToDeg(euler));
+  }
+
+  // TODO: Set basis.
+  const bool is_half =
+      UseHalf(eulers.data(), eulers.size(), kHalfRotationTol, half_stats);
+  const UsdGeomXformOp op = xform.AddRotateXYZOp(GetOpPrecision(is_half));
   if (stream.IsPrunedConstant()) {
-    op.Set(GfVec3f(RadToDeg(eulers[0])));
+    SetOpValue(op, eulers[0], is_half);
   } else {
     const size_t euler_count = euler_times.size();
     for (size_t i = 0; i != euler_count; ++i) {
-      op.Set(GfVec3f(RadToDeg(eulers[i])), GetTimeCode(euler_times[i]));
+      SetOpValue(op, eulers[i], is_half, GetTimeCode(euler_times[i]));
     }
   }
 }
 
 void SetScaleKeys(const UsdGeomXform& xform, const GfVec3f& initial_point,
                   const std::vector<float>& times,
-                  const std::vector<GfVec3f>& points) {
+                  const std::vector<GfVec3f>& points, HalfStats* half_stats,
+                  ConvertStats* stats, const CancelToken* cancel) {
   const size_t src_count = times.size();
   if (src_count == 0) {
     if (!NearlyEqual(initial_point, kDefaultScale, kDefaultScaleTol)) {
-      const UsdGeomXformOp op =
-          xform.AddScaleOp(UsdGeomXformOp::PrecisionFloat);
-      op.Set(initial_point);
+      const bool is_half =
+          UseHalf(&initial_point, 1, kHalfScaleTol, half_stats);
+      const UsdGeomXformOp op = xform.AddScaleOp(GetOpPrecision(is_half));
+      SetOpValue(op, initial_point, is_half);
     }
     return;
   }
   UFG_ASSERT_LOGIC(points.size() == src_count);
   ScalePrunerStream stream(times.data(), points.data());
-  PruneAnimationKeys(src_count, &stream);
-  const UsdGeomXformOp op = xform.AddScaleOp(UsdGeomXformOp::PrecisionFloat);
+  PruneAnimationKeys(src_count, &stream, cancel);
+  AddKeyStats(src_count, stream, stream.times.size(), stats);
+  const bool is_half = UseHalf(stream.points.data(), stream.points.size(),
+                               kHalfScaleTol, half_stats);
+  const UsdGeomXformOp op = xform.AddScaleOp(GetOpPrecision(is_half));
   if (stream.IsPrunedConstant()) {
-    op.Set(stream.points[0]);
+    SetOpValue(op, stream.points[0], is_half);
   } else {
     const size_t pruned_count = stream.times.size();
     for (size_t i = 0; i != pruned_count; ++i) {
-      op.Set(stream.points[i], GetTimeCode(stream.times[i]));
+      SetOpValue(op, stream.points[i], is_half, GetTimeCode(stream.times[i]));
     }
   }
 }
 
+// Set an array value, charging its size to USD memory.
+template <typename Value, typename Attr>
+void SetArray(const Attr& attr, const VtArray<Value>& values,
+              UsdArrayCharge* usd_memory,
+              UsdTimeCode time = UsdTimeCode::Default()) {
+  attr.Set(values, time);
+  usd_memory->Add(values);
+}
+
 template <typename Vec>
 void SetConstantSkinKey(const UsdAttribute& attr, const VtArray<Vec>& points,
-                        float time_min, float time_max) {
+                        float time_min, float time_max,
+                        UsdArrayCharge* usd_memory) {
   // We have to add two keys for compatibility with Apple's viewer (a single
   // constant key will cause the mesh to be rendered unskinned).
-  attr.Set(points, GetTimeCode(time_min));
-  attr.Set(points, GetTimeCode(time_max));
+  SetArray(attr, points, usd_memory, GetTimeCode(time_min));
+  SetArray(attr, points, usd_memory, GetTimeCode(time_max));
 }
 
 void SetTranslationSkinKeys(
     const UsdSkelAnimation& skel_anim,
     const NodeInfo* const* joint_infos, size_t ujoint_count,
-    const VtArray<GfVec3f>& rest_points, float time_min, float time_max) {
+    const VtArray<GfVec3f>& rest_points, float time_min, float time_max,
+    UsdArrayCharge* usd_memory, ConvertStats* stats, const CancelToken* cancel) {
   std::vector<TranslationKey> keys;
   GenerateSkinAnimKeys(ujoint_count, joint_infos, &keys);
   const size_t key_count = keys.size();
   const UsdAttribute attr = skel_anim.CreateTranslationsAttr();
   if (key_count > 0) {
     TranslationKeyPrunerStream stream(keys.data());
-    PruneAnimationKeys(key_count, &stream);
+    PruneAnimationKeys(key_count, &stream, cancel);
+    AddKeyStats(key_count, stream, stream.keys.size(), stats);
     if (stream.IsPrunedConstant()) {
       VtArray<GfVec3f> points;
       ToVtArray(stream.keys[0].p, &points);
-      SetConstantSkinKey(attr, points, time_min, time_max);
+      SetConstantSkinKey(attr, points, time_min, time_max, usd_memory);
     } else {
       for (const TranslationKey& key : stream.keys) {
         VtArray<GfVec3f> points;
         ToVtArray(key.p, &points);
-        attr.Set(points, GetTimeCode(key.t));
+        SetArray(attr, points, usd_memory, GetTimeCode(key.t));
       }
     }
     return;
   } else {
-    SetConstantSkinKey(attr, rest_points, time_min, time_max);
+    SetConstantSkinKey(attr, rest_points, time_min, time_max, usd_memory);
   }
 }
 
@@ -239,7 +431,8 @@ void SetRotationSkinKeys(
     const UsdSkelAnimation& skel_anim,
     const NodeInfo* const* joint_infos, size_t ujoint_count,
     const VtArray<GfQuatf>& rest_points, float time_min, float time_max,
-    std::vector<GfQuatf>* out_frame0_rots) {
+    UsdArrayCharge* usd_memory, std::vector<GfQuatf>* out_frame0_rots,
+    ConvertStats* stats, const CancelToken* cancel) {
   std::vector<RotationKey> keys;
   GenerateSkinAnimKeys(ujoint_count, joint_infos, &keys);
   const size_t key_count = keys.size();
@@ -248,21 +441,22 @@ void SetRotationSkinKeys(
     // TODO: Subdivide large rotations to compensate for Nlerp
     // innaccuracy in the iOS viewer.
     RotationKeyPrunerStream stream(keys.data());
-    PruneAnimationKeys(key_count, &stream);
+    PruneAnimationKeys(key_count, &stream, cancel);
+    AddKeyStats(key_count, stream, stream.keys.size(), stats);
     if (stream.IsPrunedConstant()) {
       VtArray<GfQuatf> points;
       ToVtArray(stream.keys[0].p, &points);
-      SetConstantSkinKey(attr, points, time_min, time_max);
+      SetConstantSkinKey(attr, points, time_min, time_max, usd_memory);
     } else {
       for (const RotationKey& key : stream.keys) {
         VtArray<GfQuatf> points;
         ToVtArray(key.p, &points);
-        attr.Set(points, GetTimeCode(key.t));
+        SetArray(attr, points, usd_memory, GetTimeCode(key.t));
       }
     }
     out_frame0_rots->swap(keys[0].p);
   } else {
-    SetConstantSkinKey(attr, rest_points, time_min, time_max);
+    SetConstantSkinKey(attr, rest_points, time_min, time_max, usd_memory);
     const GfQuatf* const points = rest_points.data();
     out_frame0_rots->assign(points, points + ujoint_count);
   }
@@ -283,7 +477,8 @@ GfVec3f SetScaleSkinKeys(
     const NodeInfo* const* joint_infos, size_t ujoint_count,
     const std::vector<GfVec3f>& rest_points, float time_min, float time_max,
     bool normalize, const std::vector<uint16_t>& ujoint_roots,
-    std::vector<GfVec3f>* out_frame0_scales) {
+    UsdArrayCharge* usd_memory, std::vector<GfVec3f>* out_frame0_scales,
+    ConvertStats* stats, const CancelToken* cancel) {
   GfVec3f root_scale(1.0f);
   std::vector<ScaleKey> keys;
   GenerateSkinAnimKeys(ujoint_count, joint_infos, &keys);
@@ -291,7 +486,8 @@ GfVec3f SetScaleSkinKeys(
   const UsdAttribute attr = skel_anim.CreateScalesAttr();
   if (key_count > 0) {
     ScaleKeyPrunerStream stream(keys.data());
-    PruneAnimationKeys(key_count, &stream);
+    PruneAnimationKeys(key_count, &stream, cancel);
+    AddKeyStats(key_count, stream, stream.keys.size(), stats);
     if (normalize) {
       // Normalize animation so joint0 has scale 1.0.
       const ScaleKey& key0 = stream.keys[0];
@@ -306,12 +502,12 @@ GfVec3f SetScaleSkinKeys(
     if (stream.IsPrunedConstant()) {
       VtArray<GfVec3h> points;
       ToVtArray(stream.keys[0].p, &points);
-      SetConstantSkinKey(attr, points, time_min, time_max);
+      SetConstantSkinKey(attr, points, time_min, time_max, usd_memory);
     } else {
       for (const ScaleKey& key : stream.keys) {
         VtArray<GfVec3h> points;
         ToVtArray(key.p, &points);
-        attr.Set(points, GetTimeCode(key.t));
+        SetArray(attr, points, usd_memory, GetTimeCode(key.t));
       }
     }
     out_frame0_scales->swap(keys[0].p);
@@ -332,15 +528,61 @@ GfVec3f SetScaleSkinKeys(
         (*out_frame0_scales)[ujoint_index] = point;
       }
     }
-    SetConstantSkinKey(attr, rest_points_h, time_min, time_max);
+    SetConstantSkinKey(attr, rest_points_h, time_min, time_max, usd_memory);
   }
 
   return root_scale;
 }
 
+void SetBlendShapeWeightKeys(
+    const UsdSkelAnimation& skel_anim, const std::vector<WeightTrack>& tracks,
+    UsdArrayCharge* usd_memory, ConvertStats* stats, const CancelToken* cancel) {
+  const size_t track_count = tracks.size();
+  std::vector<const WeightTrack*> track_ptrs(track_count);
+  for (size_t i = 0; i != track_count; ++i) {
+    track_ptrs[i] = &tracks[i];
+  }
+  std::vector<WeightsKey> keys;
+  GenerateSkinAnimKeys(track_count, track_ptrs.data(), &keys);
+  const size_t key_count = keys.size();
+  const UsdAttribute attr = skel_anim.CreateBlendShapeWeightsAttr();
+  if (key_count > 0) {
+    WeightsKeyPrunerStream stream(keys.data());
+    PruneAnimationKeys(key_count, &stream, cancel);
+    AddKeyStats(key_count, stream, stream.keys.size(), stats);
+    if (stream.IsPrunedConstant()) {
+      VtArray<float> weights;
+      ToVtArray(stream.keys[0].p, &weights);
+      SetArray(attr, weights, usd_memory);
+    } else {
+      for (const WeightsKey& key : stream.keys) {
+        VtArray<float> weights;
+        ToVtArray(key.p, &weights);
+        SetArray(attr, weights, usd_memory, GetTimeCode(key.t));
+      }
+    }
+  } else {
+    // None of the weights are animated, so just set their static values.
+    VtArray<float> weights(track_count);
+    for (size_t i = 0; i != track_count; ++i) {
+      weights[i] = tracks[i].points[0];
+    }
+    SetArray(attr, weights, usd_memory);
+  }
+}
+
+bool HasMorphTargets(const MeshInfo& mesh_info) {
+  for (const PrimInfo& prim_info : mesh_info.prims) {
+    if (!prim_info.targets.empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
 template <typename Value, typename Attr>
 void SetVertexValues(const Attr& attr, const VtArray<Value>& values,
-                     bool emulate_double_sided) {
+                     bool emulate_double_sided, UsdArrayCharge* usd_memory) {
   if (emulate_double_sided) {
     const size_t count = values.size();
     VtArray<Value> doubled_values(2 * count);
@@ -350,17 +592,18 @@ void SetVertexValues(const Attr& attr, const VtArray<Value>& values,
     for (size_t i = 0; i != count; ++i) {
       doubled_values[count + i] = values[i];
     }
-    attr.Set(doubled_values);
+    SetArray(attr, doubled_values, usd_memory);
   } else {
-    attr.Set(values);
+    SetArray(attr, values, usd_memory);
   }
 }
 
-void SetVertexNormals(const UsdAttribute& attr, const VtArray<GfVec3f>& values,
-                      bool emulate_double_sided) {
+template <typename Vec, typename Attr>
+void SetVertexNormals(const Attr& attr, const VtArray<Vec>& values,
+                      bool emulate_double_sided, UsdArrayCharge* usd_memory) {
   if (emulate_double_sided) {
     const size_t count = values.size();
-    VtArray<GfVec3f> doubled_values(2 * count);
+    VtArray<Vec> doubled_values(2 * count);
     for (size_t i = 0; i != count; ++i) {
       doubled_values[i] = values[i];
     }
@@ -368,14 +611,15 @@ void SetVertexNormals(const UsdAttribute& attr, const VtArray<GfVec3f>& values,
     for (size_t i = 0; i != count; ++i) {
       doubled_values[count + i] = -values[i];
     }
-    attr.Set(doubled_values);
+    SetArray(attr, doubled_values, usd_memory);
   } else {
-    attr.Set(values);
+    SetArray(attr, values, usd_memory);
   }
 }
 
 void SetVertexIndices(const UsdAttribute& attr, const VtArray<int>& values,
-                      bool emulate_double_sided, size_t point_count) {
+                      bool emulate_double_sided, size_t point_count,
+                      UsdArrayCharge* usd_memory) {
   if (emulate_double_sided) {
     const size_t count = values.size();
     VtArray<int> doubled_values(2 * count);
@@ -390,43 +634,95 @@ void SetVertexIndices(const UsdAttribute& attr, const VtArray<int>& values,
       dst[1] = static_cast<int>(point_count + values[i + 1]);
       dst[2] = static_cast<int>(point_count + values[i + 0]);
     }
-    attr.Set(doubled_values);
+    SetArray(attr, doubled_values, usd_memory);
+  } else {
+    SetArray(attr, values, usd_memory);
+  }
+}
+
+// Set sparse blend shape point indices, duplicating them for back-facing
+// points (see SetVertexIndices).
+void SetPointIndices(const UsdAttribute& attr, const VtArray<int>& values,
+                     bool emulate_double_sided, size_t point_count,
+                     UsdArrayCharge* usd_memory) {
+  if (emulate_double_sided) {
+    const size_t count = values.size();
+    VtArray<int> doubled_values(2 * count);
+    for (size_t i = 0; i != count; ++i) {
+      doubled_values[i] = values[i];
+    }
+    for (size_t i = 0; i != count; ++i) {
+      doubled_values[count + i] = static_cast<int>(point_count + values[i]);
+    }
+    SetArray(attr, doubled_values, usd_memory);
   } else {
-    attr.Set(values);
+    SetArray(attr, values, usd_memory);
   }
 }
+
+// Get the total UV-space area of a triangle list.
+float GetUvArea(const VtArray<GfVec2f>& uvs, const VtArray<int>& tri_indices) {
+  const size_t uv_count = uvs.size();
+  const size_t index_count = tri_indices.size() - tri_indices.size() % 3;
+  float area = 0.0f;
+  for (size_t i = 0; i != index_count; i += 3) {
+    const size_t i0 = static_cast<size_t>(tri_indices[i + 0]);
+    const size_t i1 = static_cast<size_t>(tri_indices[i + 1]);
+    const size_t i2 = static_cast<size_t>(tri_indices[i + 2]);
+    if (i0 >= uv_count || i1 >= uv_count || i2 >= uv_count) {
+      continue;
+    }
+    const GfVec2f e1 = uvs[i1] - uvs[i0];
+    const GfVec2f e2 = uvs[i2] - uvs[i0];
+    area += 0.5f * std::abs(e1[0] * e2[1] - e1[1] * e2[0]);
+  }
+  return area;
+}
 }  // namespace
 
 void Converter::Reset(Logger* logger) {
+  image_prefetcher_.Stop();
   cc_.Reset(logger);
   curr_pass_ = kPassCount;
   materializer_.Clear();
   node_parents_.clear();
   node_infos_.clear();
-  mesh_infos_.clear();
+  own_shared_.Reset();
+  usd_memory_.Release();
   used_skin_infos_.clear();
   gltf_skin_srcs_.clear();
   anim_info_.Clear();
   debug_bone_material_ = UsdShadeMaterial();
+  for (HalfStats& half_stats : half_stats_) {
+    half_stats = HalfStats();
+  }
 }
 
 bool Converter::Convert(const ConvertSettings& settings, const Gltf& gltf,
                         GltfStream* gltf_stream, const std::string& src_dir,
                         const std::string& dst_dir,
                         const std::string& dst_filename,
-                        const SdfLayerRefPtr& layer, Logger* logger) {
+                        const SdfLayerRefPtr& layer, ConvertShared* shared,
+                        Logger* logger) {
   try {
     const size_t old_error_count = logger->GetErrorCount();
     ConvertImpl(settings, gltf, gltf_stream, src_dir, dst_dir, dst_filename,
-                layer, logger);
+                layer, shared, logger);
     cc_.once_logger.Flush();
     cc_.logger = nullptr;
     const size_t error_count = logger->GetErrorCount();
     return error_count == old_error_count;
   } catch (const AssertException& e) {
+    image_prefetcher_.Stop();
     Log<UFG_ERROR_ASSERT>(
         logger, "", e.GetFile(), e.GetLine(), e.GetExpression());
     return false;
+  } catch (const CancelException&) {
+    image_prefetcher_.Stop();
+    cc_.stats.cancel_phase = cc_.stats.active_phase;
+    LogCancel(settings.cancel_token, settings.timeout, settings.memory_tracker,
+              cc_.stats.cancel_phase, logger);
+    return false;
   }
 }
 
@@ -470,6 +766,7 @@ void Converter::CreateDebugBoneMesh(const SdfPath& parent_path,
 
   // Create the material the first time it is referenced.
   if (!debug_bone_material_) {
+    ContentLayerSentry layer_sentry(&cc_, kContentLayerMaterials);
     const UsdStageRefPtr& stage = cc_.stage;
     const SdfPath material_path("/Materials/debug_bone_material");
     const UsdShadeMaterial usd_material =
@@ -501,16 +798,23 @@ void Converter::CreateDebugBoneMesh(const SdfPath& parent_path,
   const VtArray<GfVec3f> extent({ aabb.GetMin(), aabb.GetMax() });
   const SdfPath path = parent_path.AppendElementString("debug_bone");
   const UsdGeomMesh usd_mesh = UsdGeomMesh::Define(cc_.stage, path);
-  usd_mesh.CreateSubdivisionSchemeAttr().Set(UsdGeomTokens->none);
-  usd_mesh.GetPointsAttr().Set(kPoints);
-  usd_mesh.GetNormalsAttr().Set(kNorms);
-  usd_mesh.GetFaceVertexIndicesAttr().Set(tri_indices);
-  usd_mesh.GetFaceVertexCountsAttr().Set(kTriCounts);
   usd_mesh.GetExtentAttr().Set(extent);
-  UsdShadeMaterialBindingAPI(usd_mesh.GetPrim()).Bind(debug_bone_material_);
+  {
+    ContentLayerSentry layer_sentry(&cc_, kContentLayerGeometry);
+    usd_mesh.CreateSubdivisionSchemeAttr().Set(UsdGeomTokens->none);
+    usd_mesh.GetPointsAttr().Set(kPoints);
+    usd_mesh.GetNormalsAttr().Set(kNorms);
+    usd_mesh.GetFaceVertexIndicesAttr().Set(tri_indices);
+    usd_mesh.GetFaceVertexCountsAttr().Set(kTriCounts);
+  }
+  {
+    ContentLayerSentry layer_sentry(&cc_, kContentLayerMaterials);
+    UsdShadeMaterialBindingAPI(usd_mesh.GetPrim()).Bind(debug_bone_material_);
+  }
 }
 
 void Converter::CreateSkeleton(const SdfPath& path, const SkinInfo& skin_info) {
+  ContentLayerSentry layer_sentry(&cc_, kContentLayerAnimation);
   const UsdSkelSkeleton skeleton = UsdSkelSkeleton::Define(cc_.stage, path);
   skeleton.CreateJointsAttr().Set(skin_info.ujoint_names);
   skeleton.CreateBindTransformsAttr().Set(skin_info.bind_mats);
@@ -521,6 +825,7 @@ GfVec3f Converter::CreateSkelAnim(
     const SdfPath& path, const SkinInfo& skin_info, const AnimInfo& anim_info,
     std::vector<GfQuatf>* out_frame0_rots,
     std::vector<GfVec3f>* out_frame0_scales) {
+  ContentLayerSentry layer_sentry(&cc_, kContentLayerAnimation);
   const Gltf::Animation* const anim =
       Gltf::GetById(cc_.gltf->animations, anim_info.id);
   const UsdSkelAnimation skel_anim = UsdSkelAnimation::Define(cc_.stage, path);
@@ -548,41 +853,101 @@ GfVec3f Converter::CreateSkelAnim(
   const float time_max = anim ? anim_info.time_max : 1.0f;
 
   SetTranslationSkinKeys(skel_anim, joint_infos.data(), ujoint_count,
-      rest_translations, time_min, time_max);
+      rest_translations, time_min, time_max, &usd_memory_, &cc_.stats,
+      cc_.settings.cancel_token);
   SetRotationSkinKeys(skel_anim, joint_infos.data(), ujoint_count,
-      rest_rotations, time_min, time_max, out_frame0_rots);
+      rest_rotations, time_min, time_max, &usd_memory_, out_frame0_rots,
+      &cc_.stats, cc_.settings.cancel_token);
 
   const std::vector<uint16_t> ujoint_roots =
       GetJointRoots(node_parents_.data(), cc_.gltf->nodes.size(),
                     skin_info.ujoint_to_node_map);
   const GfVec3f root_scale = SetScaleSkinKeys(
       skel_anim, joint_infos.data(), ujoint_count, rest_scales, time_min,
-      time_max, cc_.settings.normalize_skin_scale, ujoint_roots,
-      out_frame0_scales);
+      time_max, cc_.settings.normalize_skin_scale, ujoint_roots, &usd_memory_,
+      out_frame0_scales, &cc_.stats, cc_.settings.cancel_token);
 
   return root_scale;
 }
 
+VtArray<TfToken> Converter::AddMorphChannels(
+    const Gltf::Mesh& mesh, const SdfPath& mesh_path, size_t target_count,
+    const MorphContext& morph_context) {
+  const Gltf::Node& node =
+      *UFG_VERIFY(Gltf::GetById(cc_.gltf->nodes, morph_context.node_id));
+  const NodeInfo& node_info =
+      *UFG_VERIFY(Gltf::GetById(node_infos_, morph_context.node_id));
+
+  // Node weights override mesh weights, and both default to zero.
+  const std::vector<float>& weights =
+      node.weights.empty() ? mesh.weights : node.weights;
+  const bool is_animated = node_info.weight_tracks.size() == target_count;
+
+  // Channels are named after the mesh prim, which is unique under the
+  // SkelRoot, so meshes sharing a SkelAnimation don't collide.
+  VtArray<TfToken> names(target_count);
+  MorphChannels& channels = *morph_context.channels;
+  for (size_t i = 0; i != target_count; ++i) {
+    names[i] = TfToken(AppendNumber(mesh_path.GetName() + "_shape", i));
+    channels.names.push_back(names[i]);
+    if (is_animated) {
+      channels.tracks.push_back(node_info.weight_tracks[i]);
+    } else {
+      WeightTrack track;
+      track.points.push_back(i < weights.size() ? weights[i] : 0.0f);
+      channels.tracks.push_back(std::move(track));
+    }
+  }
+  return names;
+}
+
+void Converter::CreateMorphAnim(const SdfPath& path,
+                                const MorphChannels& channels) {
+  ContentLayerSentry layer_sentry(&cc_, kContentLayerAnimation);
+  const UsdSkelAnimation skel_anim = UsdSkelAnimation::Define(cc_.stage, path);
+  skel_anim.CreateBlendShapesAttr().Set(channels.names);
+  SetBlendShapeWeightKeys(skel_anim, channels.tracks, &usd_memory_, &cc_.stats,
+                          cc_.settings.cancel_token);
+}
+
 void Converter::CreateMesh(
     size_t mesh_index, const SdfPath& parent_path, bool reverse_winding,
-    const SkinnedMeshContext* skinned_mesh_context) {
+    const SkinnedMeshContext* skinned_mesh_context,
+    const MorphContext* morph_context) {
   // TODO: Perform vertex welding, because some of our source meshes
   // appear to be non-indexed, thus way oversized.
   UFG_ASSERT_LOGIC(mesh_index < cc_.gltf->meshes.size());
   const Gltf::Mesh& mesh = cc_.gltf->meshes[mesh_index];
-  const std::string mesh_path_str =
+  const SdfPath mesh_path =
       cc_.path_table.MakeUnique(parent_path, "mesh", mesh.name, mesh_index);
 
   // The GLTF loader should prevent this.
   UFG_ASSERT_LOGIC(!mesh.primitives.empty());
 
-  const MeshInfo& mesh_info = mesh_infos_[mesh_index];
+  const MeshInfo& mesh_info = cc_.shared->mesh_infos[mesh_index];
   const size_t prim_count = mesh.primitives.size();
   UFG_ASSERT_LOGIC(prim_count == mesh_info.prims.size());
 
+  // Morph targets are exported as UsdSkel blend shapes. glTF requires all
+  // primitives to have the same targets, so they share weight channels.
+  const size_t target_count =
+      morph_context ? mesh.primitives[0].targets.size() : 0;
+  VtArray<TfToken> channel_names;
+  if (target_count > 0) {
+    channel_names =
+        AddMorphChannels(mesh, mesh_path, target_count, *morph_context);
+    if (cc_.settings.warn_ios_incompat) {
+      const std::string src_mesh_name =
+          Gltf::GetName(cc_.gltf->meshes, Gltf::IndexToId(mesh_index), "mesh");
+      LogOnce<UFG_WARN_MORPH_TARGETS_UNSUPPORTED>(
+          &cc_.once_logger, " Mesh(es): ", src_mesh_name.c_str());
+    }
+  }
+
   // A glTF primitive is geometry with a specific format and material.
   // TODO: Can we handle multiple prims with UsdGeomSubsets?
   for (size_t prim_index = 0; prim_index != prim_count; ++prim_index) {
+    CheckCancel(cc_.settings.cancel_token);
     const PrimInfo& prim_info = mesh_info.prims[prim_index];
     const size_t used_vert_count = prim_info.pos.size();
     if (used_vert_count == 0) {
@@ -601,7 +966,7 @@ void Converter::CreateMesh(
     const bool emulate_double_sided =
         double_sided && cc_.settings.emulate_double_sided;
 
-    SkinData skin_data;
+    SkinData& skin_data = skin_data_;
     const bool have_skin_data =
         skinned_mesh_context && prim_info.skin_index_stride != 0 &&
         GetSkinData(prim_info.skin_indices.data(), prim_info.skin_index_stride,
@@ -610,35 +975,23 @@ void Converter::CreateMesh(
                     skinned_mesh_context->gjoint_to_ujoint_map,
                     skinned_mesh_context->gjoint_count, &skin_data);
 
-    // TODO: Morph targets.
-    // * This is supported in USD, but not on iOS.
-    // * https://graphics.pixar.com/usd/docs/api/_usd_skel__schemas.html#UsdSkel_BlendShape
-    // * It's also possible to emulate it via vertex animation similar to how
-    //   XCode converts Alembic animations (you can set timeSamples for
-    //   position, normal, etc). This works in Usdview, but is ignored on iOS.
-    if (!mesh.weights.empty()) {
-      const std::string src_mesh_name =
-          Gltf::GetName(cc_.gltf->meshes, Gltf::IndexToId(mesh_index), "mesh");
-      LogOnce<UFG_WARN_MORPH_TARGETS_UNSUPPORTED>(
-          &cc_.once_logger, " Mesh(es): ", src_mesh_name.c_str());
-    }
-
     // TODO: When we create a mesh we're providing a specific path to
     // it, which doesn't support instancing (a mesh being replicated at multiple
     // points in the hierarchy).
-    std::string path_str = mesh_path_str;
-    if (mesh.primitives.size() != 1) {
-      path_str =
-          AppendNumber(path_str + "_prim", &prim - mesh.primitives.data());
-    }
-    const SdfPath path(path_str);
+    const SdfPath path =
+        mesh.primitives.size() == 1
+            ? mesh_path
+            : mesh_path.ReplaceName(TfToken(
+                  AppendNumber(mesh_path.GetName() + "_prim",
+                               &prim - mesh.primitives.data())));
     UsdGeomMesh usd_mesh = UsdGeomMesh::Define(cc_.stage, path);
+    ContentLayerSentry geometry_layer_sentry(&cc_, kContentLayerGeometry);
     usd_mesh.CreateSubdivisionSchemeAttr().Set(UsdGeomTokens->none);
 
     // Set vertex attributes.
     UFG_ASSERT_FORMAT(!prim_info.pos.empty());
     SetVertexValues(usd_mesh.GetPointsAttr(), prim_info.pos,
-                    emulate_double_sided);
+                    emulate_double_sided, &usd_memory_);
     if (!prim_info.norm.empty()) {
       const VtArray<GfVec3f>* norms = &prim_info.norm;
       VtArray<GfVec3f> skin_norms;
@@ -651,8 +1004,18 @@ void Converter::CreateMesh(
                     skin_norms.data());
         norms = &skin_norms;
       }
-      SetVertexNormals(usd_mesh.GetNormalsAttr(), *norms, emulate_double_sided);
-      usd_mesh.SetNormalsInterpolation(UsdGeomTokens->vertex);
+      if (UseHalf(norms->data(), norms->size(), kHalfNormalTol,
+                  GetHalfStats(kHalfNormal))) {
+        const UsdGeomPrimvar norms_primvar = usd_mesh.CreatePrimvar(
+            UsdGeomTokens->normals, SdfValueTypeNames->Normal3hArray,
+            UsdGeomTokens->vertex);
+        SetVertexNormals(norms_primvar, ToHalf<GfVec3h>(*norms),
+                         emulate_double_sided, &usd_memory_);
+      } else {
+        SetVertexNormals(usd_mesh.GetNormalsAttr(), *norms,
+                         emulate_double_sided, &usd_memory_);
+        usd_mesh.SetNormalsInterpolation(UsdGeomTokens->vertex);
+      }
     }
 
     const Materializer::Value* const material_binding =
@@ -680,10 +1043,25 @@ void Converter::CreateMesh(
           uv = &transformed_uv;
         }
         const TfToken uvset_tok(AppendNumber("st", number));
-        const UsdGeomPrimvar uvs_primvar = usd_mesh.CreatePrimvar(
-            uvset_tok, SdfValueTypeNames->TexCoord2fArray,
-            UsdGeomTokens->vertex);
-        SetVertexValues(uvs_primvar, *uv, emulate_double_sided);
+        if (UseHalf(uv->data(), uv->size(), kHalfUvTol,
+                    GetHalfStats(kHalfUv))) {
+          const UsdGeomPrimvar uvs_primvar = usd_mesh.CreatePrimvar(
+              uvset_tok, SdfValueTypeNames->TexCoord2hArray,
+              UsdGeomTokens->vertex);
+          SetVertexValues(uvs_primvar, ToHalf<GfVec2h>(*uv),
+                          emulate_double_sided, &usd_memory_);
+        } else {
+          const UsdGeomPrimvar uvs_primvar = usd_mesh.CreatePrimvar(
+              uvset_tok, SdfValueTypeNames->TexCoord2fArray,
+              UsdGeomTokens->vertex);
+          SetVertexValues(uvs_primvar, *uv, emulate_double_sided,
+                          &usd_memory_);
+        }
+        if (cc_.settings.limit_total_image_weighted) {
+          materializer_.AddUvCoverage(
+              prim.material, number,
+              GetUvArea(*uv, prim_info.tri_vert_indices));
+        }
       }
     }
 
@@ -717,19 +1095,24 @@ void Converter::CreateMesh(
       tri_vert_indices = &reversed_tri_vert_indices;
     }
     SetVertexIndices(usd_mesh.GetFaceVertexIndicesAttr(), *tri_vert_indices,
-                     emulate_double_sided, used_vert_count);
+                     emulate_double_sided, used_vert_count, &usd_memory_);
     SetVertexValues(usd_mesh.GetFaceVertexCountsAttr(),
-                    prim_info.tri_vert_counts, emulate_double_sided);
+                    prim_info.tri_vert_counts, emulate_double_sided,
+                    &usd_memory_);
 
     // Set point extent from its AABB.
     // TODO: We may need to expand this to account for animation.
     const GfRange3f aabb =
         BoundPoints(prim_info.pos.data(), prim_info.pos.size());
     const VtArray<GfVec3f> extent({aabb.GetMin(), aabb.GetMax()});
-    usd_mesh.GetExtentAttr().Set(extent);
+    {
+      ContentLayerSentry layer_sentry(&cc_, kContentLayerRoot);
+      usd_mesh.GetExtentAttr().Set(extent);
+    }
 
     // Set material.
     if (material) {
+      ContentLayerSentry layer_sentry(&cc_, kContentLayerMaterials);
       usd_mesh.GetDoubleSidedAttr().Set(double_sided && !emulate_double_sided);
       UsdShadeMaterialBindingAPI(usd_mesh.GetPrim())
           .Bind(material_binding->material);
@@ -737,6 +1120,7 @@ void Converter::CreateMesh(
 
     // Bind skin data.
     if (have_skin_data) {
+      ContentLayerSentry layer_sentry(&cc_, kContentLayerAnimation);
       UFG_ASSERT_LOGIC(skin_data.bindings.size() == used_vert_count);
       const size_t influence_count = skin_data.influence_count;
       const size_t influence_total = used_vert_count * influence_count;
@@ -767,13 +1151,77 @@ void Converter::CreateMesh(
           binding_api.CreateJointWeightsPrimvar(
               skin_data.is_rigid, static_cast<int>(influence_count));
       SetVertexValues(joint_indices_primvar, joint_indices,
-                      emulate_double_sided);
+                      emulate_double_sided, &usd_memory_);
+      HalfStats* const weight_stats = GetHalfStats(kHalfWeight);
+      if (weight_stats) {
+        const float error = QuantizeSkinWeights(
+            influence_count, kHalfWeightStep, &joint_weights);
+        weight_stats->Add(true, error);
+      }
       SetVertexValues(joint_weights_primvar, joint_weights,
-                      emulate_double_sided);
+                      emulate_double_sided, &usd_memory_);
+    }
+
+    // Bind blend shapes, stored sparsely as children of the mesh.
+    if (target_count > 0 && prim_info.targets.size() == target_count) {
+      ContentLayerSentry layer_sentry(&cc_, kContentLayerAnimation);
+      const UsdSkelBindingAPI binding_api(usd_mesh.GetPrim());
+      if (!have_skin_data) {
+        binding_api.CreateSkeletonRel().AddTarget(morph_context->skeleton_path);
+        binding_api.CreateAnimationSourceRel().AddTarget(
+            morph_context->anim_path);
+      }
+      binding_api.CreateBlendShapesAttr().Set(channel_names);
+      const UsdRelationship targets_rel =
+          binding_api.CreateBlendShapeTargetsRel();
+      for (size_t i = 0; i != target_count; ++i) {
+        const MorphTargetInfo& target = prim_info.targets[i];
+        const SdfPath shape_path =
+            path.AppendElementString(AppendNumber("shape", i));
+        const UsdSkelBlendShape shape =
+            UsdSkelBlendShape::Define(cc_.stage, shape_path);
+        if (!target.point_indices.empty()) {
+          SetPointIndices(shape.CreatePointIndicesAttr(), target.point_indices,
+                          emulate_double_sided, used_vert_count, &usd_memory_);
+        }
+        SetVertexValues(shape.CreateOffsetsAttr(), target.offsets,
+                        emulate_double_sided, &usd_memory_);
+        if (!target.normal_offsets.empty()) {
+          SetVertexNormals(shape.CreateNormalOffsetsAttr(),
+                           target.normal_offsets, emulate_double_sided,
+                           &usd_memory_);
+        }
+        targets_rel.AddTarget(shape_path);
+      }
     }
   }
 }
 
+void Converter::CreateMorphMesh(Gltf::Id node_id, size_t mesh_index,
+                                const SdfPath& parent_path,
+                                bool reverse_winding) {
+  // UsdSkel only applies blend shapes to meshes bound to a Skeleton under a
+  // SkelRoot, so give each rigid morph mesh a joint-less skeleton of its own.
+  const Gltf::Mesh& mesh = cc_.gltf->meshes[mesh_index];
+  const SdfPath root_path =
+      cc_.path_table.MakeUnique(parent_path, "morph", mesh.name, mesh_index);
+  UsdSkelRoot::Define(cc_.stage, root_path);
+  MorphChannels channels;
+  const MorphContext morph_context = {
+    root_path.AppendElementString("skeleton"),
+    root_path.AppendElementString("anim"),
+    node_id, &channels
+  };
+  {
+    ContentLayerSentry layer_sentry(&cc_, kContentLayerAnimation);
+    UsdSkelSkeleton::Define(cc_.stage, morph_context.skeleton_path);
+  }
+  CreateMesh(mesh_index, root_path, reverse_winding, nullptr, &morph_context);
+  if (!channels.names.empty()) {
+    CreateMorphAnim(morph_context.anim_path, channels);
+  }
+}
+
 void Converter::CreateSkinnedMeshes(const SdfPath& parent_path,
                                     const std::vector<Gltf::Id>& node_ids,
                                     bool reverse_winding) {
@@ -783,6 +1231,7 @@ void Converter::CreateSkinnedMeshes(const SdfPath& parent_path,
     SdfPath skeleton_path;
     SdfPath anim_path;
     std::vector<GfMatrix3f> bake_norm_mats;
+    MorphChannels morph_channels;
   };
   std::vector<Skel> skels(used_skin_infos_.size());
 
@@ -807,9 +1256,8 @@ void Converter::CreateSkinnedMeshes(const SdfPath& parent_path,
       skel.created = true;
 
       const SkinInfo& skin_info = used_skin_infos_[used_skin_index];
-      const std::string skin_path_str = cc_.path_table.MakeUnique(
+      skel.skin_path = cc_.path_table.MakeUnique(
           parent_path, "skin", skin_info.name, used_skin_index);
-      skel.skin_path = SdfPath(skin_path_str);
       const UsdSkelRoot skel_root =
           UsdSkelRoot::Define(cc_.stage, skel.skin_path);
 
@@ -818,12 +1266,11 @@ void Converter::CreateSkinnedMeshes(const SdfPath& parent_path,
 
       const Gltf::Animation* const anim =
           Gltf::GetById(cc_.gltf->animations, anim_info_.id);
-      const std::string anim_path_str =
+      skel.anim_path =
           anim ? cc_.path_table.MakeUnique(skel.skin_path, "anim", anim->name,
                                            Gltf::IdToIndex(anim_info_.id))
                : cc_.path_table.MakeUnique(skel.skin_path, nullptr,
                                            "default_skin_anim", 0);
-      skel.anim_path = SdfPath(anim_path_str);
       std::vector<GfQuatf> frame0_rots;
       std::vector<GfVec3f> frame0_scales;
       const GfVec3f root_scale = CreateSkelAnim(
@@ -854,99 +1301,129 @@ void Converter::CreateSkinnedMeshes(const SdfPath& parent_path,
       joint_map.data(), joint_map.size(),
       GetDataOrNull(skel.bake_norm_mats)
     };
+    const MorphContext morph_context = {
+      skel.skeleton_path, skel.anim_path, node_id, &skel.morph_channels
+    };
     CreateMesh(mesh_index, skel.skin_path, reverse_winding,
-               &skinned_mesh_context);
+               &skinned_mesh_context,
+               HasMorphTargets(cc_.shared->mesh_infos[mesh_index])
+                   ? &morph_context
+                   : nullptr);
   }
-}
 
-void Converter::CreateNodeHierarchy(Gltf::Id node_id,
-                                    const SdfPath& parent_path,
-                                    const GfMatrix4d& parent_world_mat) {
-  const size_t node_index = Gltf::IdToIndex(node_id);
-  const NodeInfo& info = node_infos_[node_index];
-  if (!info.passes_used[curr_pass_]) {
-    // Omit nodes without any content.
-    return;
+  // Blend shape weights for all meshes bound to each skin are stored in its
+  // SkelAnimation.
+  for (const Skel& skel : skels) {
+    if (!skel.morph_channels.names.empty()) {
+      CreateMorphAnim(skel.anim_path, skel.morph_channels);
+    }
   }
+}
+
+void Converter::CreateNodeHierarchy(Gltf::Id root_id,
+                                    const SdfPath& parent_path) {
+  // Traverse depth-first with an explicit stack so deep hierarchies can't
+  // overflow the call stack. Children are pushed in reverse so nodes are
+  // visited (and thus named and ordered) as they would be recursively.
+  GfMatrix4d identity;
+  identity.SetIdentity();
+  node_stack_.clear();
+  node_stack_.push_back({root_id, parent_path, identity});
+  while (!node_stack_.empty()) {
+    CheckCancel(cc_.settings.cancel_token);
+    const NodeVisit visit = node_stack_.back();
+    node_stack_.pop_back();
+    const size_t node_index = Gltf::IdToIndex(visit.node_id);
+    const NodeInfo& info = node_infos_[node_index];
+    if (!info.passes_used[curr_pass_]) {
+      // Omit nodes without any content.
+      continue;
+    }
+
+    UFG_ASSERT_FORMAT(node_index < cc_.gltf->nodes.size());
+    const Gltf::Node& node = cc_.gltf->nodes[node_index];
+    const SdfPath path = cc_.path_table.MakeUnique(
+        visit.parent_path, "node", node.name, node_index);
+    const UsdGeomXform xform = UsdGeomXform::Define(cc_.stage, path);
 
-  UFG_ASSERT_FORMAT(node_index < cc_.gltf->nodes.size());
-  const Gltf::Node& node = cc_.gltf->nodes[node_index];
-  const std::string path_str =
-      cc_.path_table.MakeUnique(parent_path, "node", node.name, node_index);
-  const SdfPath path(path_str);
-  const UsdGeomXform xform = UsdGeomXform::Define(cc_.stage, path);
-
-  // Apply transform.
-  if (!info.is_animated) {
-    // Either the node isn't animated, or it doesn't contain any meshes, so we
-    // can treat it as static. Note for skinned meshes, animation data is stored
-    // separately under SkelRoot.
-    // TODO: Maybe set SRT separately with AddTranslateOp, AddScaleOp,
-    // and AddRotate<XYZ>Op.
-    const GfMatrix4d mat =
+    // The static local transform. For animated nodes, this is the rest pose
+    // the animation keys are relative to.
+    const GfMatrix4d local_mat =
         node.is_matrix
             ? ToMatrix4d(node.matrix)
             : SrtToMatrix4d(node.scale, node.rotation, node.translation);
-    xform.AddTransformOp().Set(mat);
-  } else {
-    // Animated node.
-    const Srt srt = GetNodeSrt(node);
-    SetTranslationKeys(xform, srt.translation, info.translation_times,
-                       info.translation_points);
-    SetRotationKeys(xform, srt.rotation, info.rotation_times,
-                    info.rotation_points);
-    SetScaleKeys(xform, srt.scale, info.scale_times, info.scale_points);
-  }
 
-  // TODO: Cameras.
-  if (node.camera != Gltf::Id::kNull) {
-    // TODO: This warning won't be emitted if this node is pruned due
-    // to absence of meshes.
-    const std::string src_node_name =
-        Gltf::GetName(cc_.gltf->nodes, node_id, "node");
-    LogOnce<UFG_WARN_CAMERAS_UNSUPPORTED>(
-        &cc_.once_logger, " Node(s): ", src_node_name.c_str());
-  }
+    // Apply transform.
+    if (!info.is_animated) {
+      // Either the node isn't animated, or it doesn't contain any meshes, so
+      // we can treat it as static. Note for skinned meshes, animation data is
+      // stored separately under SkelRoot.
+      // TODO: Maybe set SRT separately with AddTranslateOp, AddScaleOp,
+      // and AddRotate<XYZ>Op.
+      xform.AddTransformOp().Set(local_mat);
+    } else {
+      // Animated node.
+      ContentLayerSentry layer_sentry(&cc_, kContentLayerAnimation);
+      const Srt srt = GetNodeSrt(node);
+      SetTranslationKeys(xform, srt.translation, info.translation_times,
+                         info.translation_points,
+                         GetHalfStats(kHalfTranslation), &cc_.stats,
+                         cc_.settings.cancel_token);
+      SetRotationKeys(xform, srt.rotation, info.rotation_times,
+                      info.rotation_points, GetHalfStats(kHalfRotation),
+                      &cc_.stats, cc_.settings.cancel_token);
+      SetScaleKeys(xform, srt.scale, info.scale_times, info.scale_points,
+                   GetHalfStats(kHalfScale), &cc_.stats,
+                   cc_.settings.cancel_token);
+    }
 
-  GfMatrix4d local_mat;
-  bool resets_xform_stack;
-  if (!xform.GetLocalTransformation(&local_mat, &resets_xform_stack)) {
-    local_mat.SetIdentity();
-  }
-  UFG_ASSERT_LOGIC(!resets_xform_stack);
-
-  // From my reading of usdSkel/utils.cpp, vector-matrix multiplication has the
-  // vector on the left, so the convention appears to be that matrix
-  // multiplication is ordered local*world. Either way, it's currently arbitrary
-  // for our purposes because we're only using the world matrix to determine
-  // when we need to reverse winding for inverse-scale.
-  const GfMatrix4d world_mat = local_mat * parent_world_mat;
-  const bool reverse_winding = cc_.settings.reverse_culling_for_inverse_scale &&
-                               world_mat.GetDeterminant() < 0;
-
-  // TODO: It's possible a mesh may be referenced at multiple places
-  // in the hierarchy, in which case this duplicates mesh data. I'm not sure if
-  // there's a way to instance meshes in USD, though.
-  if (curr_pass_ == kPassRigid) {
-    if (node.mesh != Gltf::Id::kNull && node.skin == Gltf::Id::kNull) {
-      CreateMesh(Gltf::IdToIndex(node.mesh), path, reverse_winding, nullptr);
-    } else if (cc_.settings.add_debug_bone_meshes) {
-      CreateDebugBoneMesh(path, reverse_winding);
-    }
-  } else if (curr_pass_ == kPassSkinned) {
-    CreateSkinnedMeshes(path, info.skinned_node_ids, reverse_winding);
-  }
+    // TODO: Cameras.
+    if (node.camera != Gltf::Id::kNull) {
+      // TODO: This warning won't be emitted if this node is pruned due
+      // to absence of meshes.
+      const std::string src_node_name =
+          Gltf::GetName(cc_.gltf->nodes, visit.node_id, "node");
+      LogOnce<UFG_WARN_CAMERAS_UNSUPPORTED>(
+          &cc_.once_logger, " Node(s): ", src_node_name.c_str());
+    }
+
+    // From my reading of usdSkel/utils.cpp, vector-matrix multiplication has
+    // the vector on the left, so the convention appears to be that matrix
+    // multiplication is ordered local*world. Either way, it's currently
+    // arbitrary for our purposes because we're only using the world matrix to
+    // determine when we need to reverse winding for inverse-scale.
+    const GfMatrix4d world_mat = local_mat * visit.parent_world_mat;
+    const bool reverse_winding =
+        cc_.settings.reverse_culling_for_inverse_scale &&
+        world_mat.GetDeterminant() < 0;
+
+    // TODO: It's possible a mesh may be referenced at multiple places
+    // in the hierarchy, in which case this duplicates mesh data. I'm not sure
+    // if there's a way to instance meshes in USD, though.
+    if (curr_pass_ == kPassRigid) {
+      if (node.mesh != Gltf::Id::kNull && node.skin == Gltf::Id::kNull) {
+        const size_t mesh_index = Gltf::IdToIndex(node.mesh);
+        if (HasMorphTargets(cc_.shared->mesh_infos[mesh_index])) {
+          CreateMorphMesh(visit.node_id, mesh_index, path, reverse_winding);
+        } else {
+          CreateMesh(mesh_index, path, reverse_winding, nullptr, nullptr);
+        }
+      } else if (cc_.settings.add_debug_bone_meshes) {
+        CreateDebugBoneMesh(path, reverse_winding);
+      }
+    } else if (curr_pass_ == kPassSkinned) {
+      CreateSkinnedMeshes(path, info.skinned_node_ids, reverse_winding);
+    }
 
-  // Add child transforms.
-  for (const Gltf::Id child_id : node.children) {
-    CreateNodeHierarchy(child_id, path, world_mat);
+    // Add child transforms.
+    for (auto it = node.children.rbegin(); it != node.children.rend(); ++it) {
+      node_stack_.push_back({*it, path, world_mat});
+    }
   }
 }
 
 void Converter::CreateNodes(const std::vector<Gltf::Id>& root_nodes) {
   // Create transform tree under each root.
-  GfMatrix4d identity;
-  identity.SetIdentity();
   for (size_t pass = 0; pass != kPassCount; ++pass) {
     bool used = root_node_info_.passes_used[pass];
     for (const Gltf::Id node_id : root_nodes) {
@@ -974,7 +1451,7 @@ void Converter::CreateNodes(const std::vector<Gltf::Id>& root_nodes) {
 
     curr_pass_ = static_cast<Pass>(pass);
     for (const Gltf::Id node_id : root_nodes) {
-      CreateNodeHierarchy(node_id, pass_path, identity);
+      CreateNodeHierarchy(node_id, pass_path);
     }
 
     // Apply root scale, optionally scaling it to limit the bounding box size.
@@ -1014,12 +1491,16 @@ void Converter::CreateAnimation(const AnimInfo& anim_info) {
       continue;
     }
     NodeInfo& info = node_infos_[node_index];
-    info.is_animated = true;
+    if (channel.target.path !=
+        Gltf::Animation::Channel::Target::kPathWeights) {
+      // Weights animate blend shapes rather than the node transform.
+      info.is_animated = true;
+    }
 
     const Gltf::Animation::Sampler& sampler =
         *Gltf::GetById(anim->samplers, channel.sampler);
     std::vector<float> times;
-    CopyAccessorToVectors(*cc_.gltf, sampler.input, &cc_.gltf_cache, &times);
+    CopyAccessorToVectors(*cc_.gltf, sampler.input, cc_.gltf_cache, &times);
     if (times.empty()) {
       // If there is no animation, preserve the default transform associated
       // with the node.
@@ -1028,7 +1509,7 @@ void Converter::CreateAnimation(const AnimInfo& anim_info) {
     switch (channel.target.path) {
     case Gltf::Animation::Channel::Target::kPathTranslation: {
       info.translation_times.swap(times);
-      CopyAccessorToVectors(*cc_.gltf, sampler.output, &cc_.gltf_cache,
+      CopyAccessorToVectors(*cc_.gltf, sampler.output, cc_.gltf_cache,
                             &info.translation_points);
       ConvertAnimKeysToLinear<TranslationKeyConverter>(
           sampler.interpolation, &info.translation_times,
@@ -1037,7 +1518,7 @@ void Converter::CreateAnimation(const AnimInfo& anim_info) {
     }
     case Gltf::Animation::Channel::Target::kPathRotation: {
       info.rotation_times.swap(times);
-      CopyAccessorToVectors(*cc_.gltf, sampler.output, &cc_.gltf_cache,
+      CopyAccessorToVectors(*cc_.gltf, sampler.output, cc_.gltf_cache,
                             &info.rotation_points);
       SanitizeRotations(info.rotation_points.size(),
                         info.rotation_points.data());
@@ -1047,14 +1528,37 @@ void Converter::CreateAnimation(const AnimInfo& anim_info) {
     }
     case Gltf::Animation::Channel::Target::kPathScale: {
       info.scale_times.swap(times);
-      CopyAccessorToVectors(*cc_.gltf, sampler.output, &cc_.gltf_cache,
+      CopyAccessorToVectors(*cc_.gltf, sampler.output, cc_.gltf_cache,
                             &info.scale_points);
       ConvertAnimKeysToLinear<ScaleKeyConverter>(
           sampler.interpolation, &info.scale_times, &info.scale_points);
       break;
     }
     case Gltf::Animation::Channel::Target::kPathWeights: {
-      // TODO: Support morph-target animation.
+      // Each key holds weights for all morph targets (with in and out tangents
+      // for cubic splines), so split them into a track per target.
+      std::vector<float> values;
+      CopyAccessorToVectors(*cc_.gltf, sampler.output, cc_.gltf_cache,
+                            &values);
+      const size_t elements_per_key =
+          sampler.interpolation ==
+                  Gltf::Animation::Sampler::kInterpolationCubicSpline
+              ? 3
+              : 1;
+      const size_t element_count = times.size() * elements_per_key;
+      UFG_ASSERT_FORMAT(values.size() % element_count == 0);
+      const size_t target_count = values.size() / element_count;
+      info.weight_tracks.resize(target_count);
+      for (size_t ti = 0; ti != target_count; ++ti) {
+        WeightTrack& track = info.weight_tracks[ti];
+        track.times = times;
+        track.points.resize(element_count);
+        for (size_t ei = 0; ei != element_count; ++ei) {
+          track.points[ei] = values[ei * target_count + ti];
+        }
+        ConvertAnimKeysToLinear<WeightKeyConverter>(
+            sampler.interpolation, &track.times, &track.points);
+      }
       break;
     }
     default:
@@ -1066,6 +1570,22 @@ void Converter::CreateAnimation(const AnimInfo& anim_info) {
 
 void Converter::CreateStage(const SdfLayerRefPtr& layer,
                             const std::string& dst_filename) {
+  // Optionally split content into sublayers, so viewers can load the hierarchy
+  // and bounds before heavier content.
+  if (cc_.settings.split_layers) {
+    std::vector<std::string> sublayer_paths;
+    cc_.content_layers[kContentLayerRoot] = layer;
+    for (size_t i = kContentLayerRoot + 1; i != kContentLayerCount; ++i) {
+      const char* const suffix =
+          GetContentLayerSuffix(static_cast<ContentLayer>(i));
+      const SdfLayerRefPtr sublayer =
+          SdfLayer::CreateAnonymous(std::string(suffix) + ".usda");
+      cc_.content_layers[i] = sublayer;
+      sublayer_paths.push_back(sublayer->GetIdentifier());
+    }
+    layer->SetSubLayerPaths(sublayer_paths);
+  }
+
   cc_.stage = UsdStage::Open(layer);
 
   // All nodes are placed under the following root node.
@@ -1083,15 +1603,27 @@ void Converter::ConvertImpl(const ConvertSettings& settings, const Gltf& gltf,
                             GltfStream* gltf_stream, const std::string& src_dir,
                             const std::string& dst_dir,
                             const std::string& dst_filename,
-                            const SdfLayerRefPtr& layer, Logger* logger) {
+                            const SdfLayerRefPtr& layer, ConvertShared* shared,
+                            Logger* logger) {
   Reset(logger);
 
-  CreateStage(layer, dst_filename);
   cc_.settings = settings;
+  CreateStage(layer, dst_filename);
   cc_.gltf = &gltf;
   cc_.src_dir = src_dir;
   cc_.dst_dir = dst_dir;
-  cc_.gltf_cache.Reset(&gltf, gltf_stream);
+  if (shared) {
+    cc_.shared = shared;
+  } else {
+    own_shared_.Reset(&gltf, gltf_stream);
+    cc_.shared = &own_shared_;
+  }
+  cc_.gltf_cache = &cc_.shared->gltf_cache;
+  cc_.shared->SetMemoryTracker(cc_.settings.memory_tracker);
+  usd_memory_.SetTracker(cc_.settings.memory_tracker);
+  const MemoryTracker* const trace_memory =
+      cc_.settings.print_timing ? cc_.settings.memory_tracker : nullptr;
+  const size_t bytes_read_begin = cc_.gltf_cache->GetBytesRead();
   node_parents_ = GetNodeParents(gltf.nodes);
 
   const Gltf::Id scene_id = GetSceneId(gltf, cc_.settings);
@@ -1102,18 +1634,47 @@ void Converter::ConvertImpl(const ConvertSettings& settings, const Gltf& gltf,
       GetNodesUnderRoots(*cc_.gltf, root_nodes,
           cc_.settings.remove_node_prefixes);
 
-  // Populate per-mesh info.
-  const size_t mesh_count = cc_.gltf->meshes.size();
-  mesh_infos_.resize(mesh_count);
-  for (size_t mesh_index = 0; mesh_index != mesh_count; ++mesh_index) {
-    GetMeshInfo(*cc_.gltf, Gltf::IndexToId(mesh_index), &cc_.gltf_cache,
-                &mesh_infos_[mesh_index], cc_.logger);
+  // Read and decode images in the background, while meshes, skins, and
+  // animation are processed.
+  if (cc_.settings.prefetch_images) {
+    image_prefetcher_.Start(
+        gltf, cc_.gltf_cache,
+        GetUsedImageIds(gltf, scene_nodes, cc_.shared->images));
+    cc_.image_prefetcher = &image_prefetcher_;
+  }
+
+  // Populate per-mesh info. This is settings-independent, so it's only done
+  // once for shared conversions.
+  std::vector<MeshInfo>& mesh_infos = cc_.shared->mesh_infos;
+  if (!cc_.shared->have_mesh_infos) {
+    PhaseSentry phase_sentry(&cc_.stats, kPhaseMeshes, trace_memory,
+                             cc_.logger);
+    const size_t mesh_count = cc_.gltf->meshes.size();
+    mesh_infos.resize(mesh_count);
+    for (size_t mesh_index = 0; mesh_index != mesh_count; ++mesh_index) {
+      GetMeshInfo(*cc_.gltf, Gltf::IndexToId(mesh_index), cc_.gltf_cache,
+                  &mesh_infos[mesh_index], cc_.logger,
+                  cc_.settings.cancel_token);
+      cc_.shared->mesh_memory.Add(mesh_infos[mesh_index].GetDataSize());
+    }
+    cc_.shared->have_mesh_infos = true;
+  }
+  cc_.stats.node_count = scene_nodes.size();
+  cc_.stats.mesh_count = mesh_infos.size();
+  for (const MeshInfo& mesh_info : mesh_infos) {
+    cc_.stats.prim_count += mesh_info.prims.size();
+    for (const PrimInfo& prim_info : mesh_info.prims) {
+      cc_.stats.src_vert_count += prim_info.src_vert_count;
+      cc_.stats.used_vert_count += prim_info.pos.size();
+    }
   }
 
   // glTF can store multiple animations, but we only export a single one.
   const Gltf::Id anim_id = GetAnimId(*cc_.gltf, cc_.settings);
   if (anim_id != Gltf::Id::kNull) {
-    anim_info_ = GetAnimInfo(*cc_.gltf, anim_id, &cc_.gltf_cache);
+    PhaseSentry phase_sentry(&cc_.stats, kPhaseAnimation, trace_memory,
+                             cc_.logger);
+    anim_info_ = GetAnimInfo(*cc_.gltf, anim_id, cc_.gltf_cache);
   }
 
   // Work-around for grossly inaccurate normals on the iOS viewer.
@@ -1132,9 +1693,9 @@ void Converter::ConvertImpl(const ConvertSettings& settings, const Gltf& gltf,
           : nullptr;
 
   // Populate per-skin info.
-  GetUsedSkinInfos(*cc_.gltf, mesh_infos_, node_parents_.data(), scene_nodes,
+  GetUsedSkinInfos(*cc_.gltf, mesh_infos, node_parents_.data(), scene_nodes,
                    force_nodes_used, cc_.settings.merge_skeletons,
-                   &cc_.gltf_cache, &used_skin_infos_, &gltf_skin_srcs_);
+                   cc_.gltf_cache, &used_skin_infos_, &gltf_skin_srcs_);
 
   // Populate per-node info.
   const size_t node_count = gltf.nodes.size();
@@ -1180,11 +1741,58 @@ void Converter::ConvertImpl(const ConvertSettings& settings, const Gltf& gltf,
   }
 
   if (anim_id != Gltf::Id::kNull) {
+    PhaseSentry phase_sentry(&cc_.stats, kPhaseAnimation, trace_memory,
+                             cc_.logger);
     CreateAnimation(anim_info_);
   }
 
   materializer_.Begin(&cc_);
-  CreateNodes(root_nodes);
-  materializer_.End();
+  {
+    PhaseSentry phase_sentry(&cc_.stats, kPhaseNodes, trace_memory,
+                             cc_.logger);
+    CreateNodes(root_nodes);
+  }
+  {
+    PhaseSentry phase_sentry(&cc_.stats, kPhaseTextures, trace_memory,
+                             cc_.logger);
+    materializer_.End();
+  }
+  image_prefetcher_.Stop();
+  cc_.image_prefetcher = nullptr;
+  cc_.stats.bytes_read = cc_.gltf_cache->GetBytesRead() - bytes_read_begin;
+
+  // All source files have been read, so drop preloaded data that wasn't
+  // consumed (e.g. buffers only read in part). Shared conversions keep it for
+  // later profiles, and it's released with the stream.
+  if (cc_.shared == &own_shared_) {
+    cc_.gltf_cache->GetStream()->ReleasePreloadedResources();
+  }
+
+  // Report error for data written at half precision.
+  if (cc_.settings.half_precision) {
+    for (size_t i = 0; i != kHalfCount; ++i) {
+      const HalfStats& half_stats = half_stats_[i];
+      if (half_stats.total_count != 0) {
+        Log<UFG_INFO_HALF_PRECISION>(
+            cc_.logger, "", kHalfTypeNames[i], half_stats.half_count,
+            half_stats.total_count, half_stats.max_error);
+      }
+    }
+  }
+
+  // Store model bounds in the root layer, so viewers can display a proxy before
+  // split content layers are loaded.
+  if (cc_.settings.split_layers) {
+    const UsdGeomXform root_xform(cc_.stage->GetPrimAtPath(cc_.root_path));
+    const GfRange3d range =
+        root_xform
+            .ComputeWorldBound(UsdTimeCode::Default(), UsdGeomTokens->default_)
+            .ComputeAlignedRange();
+    if (!range.IsEmpty()) {
+      const VtArray<GfVec3f> extents_hint(
+          {GfVec3f(range.GetMin()), GfVec3f(range.GetMax())});
+      UsdGeomModelAPI(root_xform.GetPrim()).SetExtentsHint(extents_hint);
+    }
+  }
 }
 }  // namespace ufg
@@ -17,13 +17,16 @@
 #ifndef UFG_CONVERT_CONVERTER_H_
 #define UFG_CONVERT_CONVERTER_H_
 
+#include <set>
 #include <string>
 #include <vector>
 #include "common/common_util.h"
 #include "common/config.h"
+#include "common/memory_tracker.h"
 #include "convert/convert_common.h"
 #include "convert/convert_context.h"
 #include "convert/convert_util.h"
+#include "convert/image_prefetcher.h"
 #include "convert/materializer.h"
 #include "gltf/gltf.h"
 #include "process/animation.h"
@@ -48,19 +51,52 @@ using PXR_NS::UsdShadeShader;
 using PXR_NS::UsdStageRefPtr;
 using PXR_NS::VtArray;
 
+// Charges array data authored to USD layers to a memory tracker. Copies of a
+// VtArray share storage, so an array set on multiple attributes or time samples
+// is only charged once.
+class UsdArrayCharge {
+ public:
+  void SetTracker(MemoryTracker* tracker) { memory_.SetTracker(tracker); }
+  void Release() {
+    memory_.Release();
+    charged_.clear();
+  }
+
+  template <typename Value>
+  void Add(const VtArray<Value>& values) {
+    if (!values.empty() && charged_.insert(values.cdata()).second) {
+      memory_.Add(values.size() * sizeof(Value));
+    }
+  }
+
+ private:
+  MemoryCharge memory_{kMemoryUsd};
+  std::set<const void*> charged_;
+};
+
 class Converter {
  public:
   void Reset(Logger* logger);
+
+  // Convert glTF to USD.
+  // * If shared is set, it must be reset with gltf and gltf_stream. It is used
+  //   to cache settings-independent data, so it may be passed to subsequent
+  //   conversions of the same glTF with different settings.
   bool Convert(const ConvertSettings& settings, const Gltf& gltf,
                GltfStream* gltf_stream, const std::string& src_dir,
                const std::string& dst_dir, const std::string& dst_filename,
-               const SdfLayerRefPtr& layer, Logger* logger);
+               const SdfLayerRefPtr& layer, ConvertShared* shared,
+               Logger* logger);
   const std::vector<std::string>& GetWritten() const {
     return materializer_.GetWritten();
   }
   const std::vector<std::string>& GetCreatedDirectories() const {
     return materializer_.GetCreatedDirectories();
   }
+  const SdfLayerRefPtr& GetContentLayer(ContentLayer content_layer) const {
+    return cc_.content_layers[content_layer];
+  }
+  const ConvertStats& GetStats() const { return cc_.stats; }
 
  private:
   struct SkinnedMeshContext {
@@ -71,9 +107,24 @@ class Converter {
     const GfMatrix3f* bake_norm_mats;  // Null if not baking normals.
   };
 
+  // Blend shape channels driven by a single SkelAnimation.
+  struct MorphChannels {
+    VtArray<TfToken> names;
+    std::vector<WeightTrack> tracks;
+  };
+
+  struct MorphContext {
+    SdfPath skeleton_path;
+    SdfPath anim_path;
+    Gltf::Id node_id;         // Node instancing the mesh, for its weights.
+    MorphChannels* channels;  // Receives the mesh's channels.
+  };
+
   ConvertContext cc_;
+  ConvertShared own_shared_;
   Pass curr_pass_;
   Materializer materializer_;
+  ImagePrefetcher image_prefetcher_;
 
   // TODO: A node can exist in multiple places in the hierarchy, so
   // each node could have multiple parents. I haven't found any models that
@@ -82,12 +133,29 @@ class Converter {
 
   NodeInfo root_node_info_;
   std::vector<NodeInfo> node_infos_;
-  std::vector<MeshInfo> mesh_infos_;
   std::vector<SkinInfo> used_skin_infos_;
   std::vector<SkinSrc> gltf_skin_srcs_;
   AnimInfo anim_info_;
   UsdShadeMaterial debug_bone_material_;
+  HalfStats half_stats_[kHalfCount];
 
+  // Bytes of array data authored to USD layers.
+  UsdArrayCharge usd_memory_;
+
+  // Skin bindings for the current primitive, retained to reuse storage.
+  SkinData skin_data_;
+
+  // Pending nodes for the CreateNodeHierarchy traversal.
+  struct NodeVisit {
+    Gltf::Id node_id;
+    SdfPath parent_path;
+    GfMatrix4d parent_world_mat;
+  };
+  std::vector<NodeVisit> node_stack_;
+
+  HalfStats* GetHalfStats(HalfType type) {
+    return cc_.settings.half_precision ? &half_stats_[type] : nullptr;
+  }
   void CreateStage(const SdfLayerRefPtr& layer,
                    const std::string& dst_filename);
   void CreateDebugBoneMesh(const SdfPath& parent_path, bool reverse_winding);
@@ -96,20 +164,28 @@ class Converter {
                          const AnimInfo& anim_info,
                          std::vector<GfQuatf>* out_frame0_rots,
                          std::vector<GfVec3f>* out_frame0_scales);
+  VtArray<TfToken> AddMorphChannels(const Gltf::Mesh& mesh,
+                                    const SdfPath& mesh_path,
+                                    size_t target_count,
+                                    const MorphContext& morph_context);
+  void CreateMorphAnim(const SdfPath& path, const MorphChannels& channels);
   void CreateMesh(size_t mesh_index, const SdfPath& parent_path,
                   bool reverse_winding,
-                  const SkinnedMeshContext* skinned_mesh_context);
+                  const SkinnedMeshContext* skinned_mesh_context,
+                  const MorphContext* morph_context);
+  void CreateMorphMesh(Gltf::Id node_id, size_t mesh_index,
+                       const SdfPath& parent_path, bool reverse_winding);
   void CreateSkinnedMeshes(const SdfPath& parent_path,
                            const std::vector<Gltf::Id>& node_ids,
                            bool reverse_winding);
-  void CreateNodeHierarchy(Gltf::Id node_id, const SdfPath& parent_path,
-                           const GfMatrix4d& parent_world_mat);
+  void CreateNodeHierarchy(Gltf::Id root_id, const SdfPath& parent_path);
   void CreateNodes(const std::vector<Gltf::Id>& root_nodes);
   void CreateAnimation(const AnimInfo& anim_info);
   void ConvertImpl(const ConvertSettings& settings, const Gltf& gltf,
                    GltfStream* gltf_stream, const std::string& src_dir,
                    const std::string& dst_dir, const std::string& dst_filename,
-                   const SdfLayerRefPtr& layer, Logger* logger);
+                   const SdfLayerRefPtr& layer, ConvertShared* shared,
+                   Logger* logger);
 };
 
 }  // namespace ufg
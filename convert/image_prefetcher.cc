@@ -0,0 +1,138 @@
+/*
+ * Copyright 2019 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "convert/image_prefetcher.h"
+
+#include <algorithm>
+
+namespace ufg {
+void ImagePrefetcher::Start(const Gltf& gltf, GltfCache* gltf_cache,
+                            const std::vector<Gltf::Id>& image_ids) {
+  Stop();
+  gltf_ = &gltf;
+  gltf_cache_ = gltf_cache;
+  for (const Gltf::Id image_id : image_ids) {
+    const Gltf::Image* const image = Gltf::GetById(gltf.images, image_id);
+    if (!image || entries_.count(image_id)) {
+      continue;
+    }
+    std::unique_ptr<Entry> entry(new Entry());
+    entry->image_id = image_id;
+    if (image->bufferView != Gltf::Id::kNull) {
+      // Buffers are shared with mesh processing, so they're only accessed on
+      // this thread.
+      entry->embedded_data = gltf_cache->GetImageData(
+          image_id, &entry->embedded_size, &entry->mime_type);
+    } else if (!gltf_cache->ImageExists(image_id)) {
+      // Let the caller report missing images.
+      continue;
+    }
+    entries_[image_id] = std::move(entry);
+  }
+  if (entries_.empty()) {
+    return;
+  }
+
+  stopping_ = false;
+  scheduler_.reset(new Scheduler());
+  scheduler_->Start(
+      std::min(entries_.size(), Scheduler::GetDefaultWorkerCount()));
+  for (const auto& kv : entries_) {
+    Entry* const entry = kv.second.get();
+    scheduler_->Schedule([this, entry]() { Run(entry); });
+  }
+}
+
+bool ImagePrefetcher::Take(Gltf::Id image_id, const std::string& name,
+                           Logger* logger, std::shared_ptr<Image>* out_image) {
+  const auto found = entries_.find(image_id);
+  if (found == entries_.end() || !scheduler_) {
+    return false;
+  }
+  Entry& entry = *found->second;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!entry.done) {
+      done_event_.wait(lock);
+    }
+  }
+  if (!entry.ready) {
+    return false;
+  }
+  entry.ready = false;
+
+  // Keep read data in the cache, so it's available for copying and size
+  // tracking without being read again.
+  if (!entry.embedded_data) {
+    gltf_cache_->SetImageData(image_id, &entry.file_data, entry.mime_type);
+  }
+  for (Message message : entry.logger.GetMessages()) {
+    if (message.path.empty()) {
+      message.path = name;
+    }
+    logger->Add(message);
+  }
+  entry.logger.Clear();
+  *out_image = std::move(entry.image);
+  return true;
+}
+
+void ImagePrefetcher::Stop() {
+  if (scheduler_) {
+    stopping_ = true;
+    scheduler_->WaitForAllComplete();
+    scheduler_->Stop();
+    scheduler_.reset();
+  }
+  entries_.clear();
+  gltf_ = nullptr;
+  gltf_cache_ = nullptr;
+}
+
+void ImagePrefetcher::Run(Entry* entry) {
+  // Entries that aren't ready are loaded directly by the taker. Exceptions
+  // (e.g. asserts) are handled the same way, so they're raised on the taker's
+  // thread rather than lost on this one.
+  if (!stopping_) {
+    try {
+      const uint8_t* data = entry->embedded_data;
+      size_t size = entry->embedded_size;
+      if (!data) {
+        gltf_cache_->GetStream()->ReadImage(
+            *gltf_, entry->image_id, &entry->file_data, &entry->mime_type);
+        data = entry->file_data.data();
+        size = entry->file_data.size();
+      }
+      if (size != 0) {
+        std::shared_ptr<Image> image(new Image());
+        if (image->Read(data, size, entry->mime_type, &entry->logger)) {
+          entry->image = std::move(image);
+        }
+      }
+      entry->ready = true;
+    } catch (...) {
+      entry->image.reset();
+      entry->logger.Clear();
+    }
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    entry->done = true;
+  }
+  done_event_.notify_all();
+}
+}  // namespace ufg
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2019 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef UFG_CONVERT_IMAGE_PREFETCHER_H_
+#define UFG_CONVERT_IMAGE_PREFETCHER_H_
+
+#include <atomic>  // NOLINT: Unapproved C++11 header.
+#include <condition_variable>  // NOLINT: Unapproved C++11 header.
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT: Unapproved C++11 header.
+#include <string>
+#include <vector>
+#include "common/logging.h"
+#include "common/scheduler.h"
+#include "gltf/cache.h"
+#include "gltf/gltf.h"
+#include "process/image.h"
+
+namespace ufg {
+// Reads and decodes source images on background threads, so texture IO and
+// decoding overlap with mesh, skin, and animation processing.
+// * Workers read through the glTF stream, so stream errors for prefetched
+//   images are logged from worker threads. Decode messages are buffered and
+//   logged by the thread that takes the image.
+class ImagePrefetcher {
+ public:
+  ImagePrefetcher() {}
+  ~ImagePrefetcher() { Stop(); }
+
+  // Start reading and decoding images on worker threads.
+  // * Image data embedded in buffers is fetched from the cache on the calling
+  //   thread. The cache must not be reset until Stop is called.
+  void Start(const Gltf& gltf, GltfCache* gltf_cache,
+             const std::vector<Gltf::Id>& image_ids);
+
+  // Wait for an image to be prefetched, and take the decoded result.
+  // * Returns false if the image wasn't prefetched, in which case the caller
+  //   should load it directly.
+  // * On success, out_image is null if the image is missing or failed to
+  //   decode. Messages are logged under the given name.
+  bool Take(Gltf::Id image_id, const std::string& name, Logger* logger,
+            std::shared_ptr<Image>* out_image);
+
+  // Stop prefetching, skipping images that haven't started, and wait for
+  // workers to finish. Images not yet taken are discarded.
+  void Stop();
+
+ private:
+  struct Entry {
+    Gltf::Id image_id = Gltf::Id::kNull;
+    // Embedded image data, owned by the cache.
+    const uint8_t* embedded_data = nullptr;
+    size_t embedded_size = 0;
+    // Data read from the stream, for URI-based images.
+    std::vector<uint8_t> file_data;
+    Gltf::Image::MimeType mime_type = Gltf::Image::kMimeUnset;
+    std::shared_ptr<Image> image;
+    GltfVectorLogger logger;
+    // Set when the worker finishes with the entry.
+    bool done = false;
+    // Set if the result is ready to be taken.
+    bool ready = false;
+  };
+
+  const Gltf* gltf_ = nullptr;
+  GltfCache* gltf_cache_ = nullptr;
+  std::unique_ptr<Scheduler> scheduler_;
+  std::map<Gltf::Id, std::unique_ptr<Entry>> entries_;
+  std::atomic<bool> stopping_{false};
+  std::mutex mutex_;
+  std::condition_variable done_event_;
+
+  void Run(Entry* entry);
+};
+}  // namespace ufg
+
+#endif  // UFG_CONVERT_IMAGE_PREFETCHER_H_
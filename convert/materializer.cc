@@ -37,6 +37,18 @@ GfVec4f ToVec4(const float value) {
   return GfVec4f(value, 0.f, 0.f, 1.f);
 }
 
+// Apply the scale and bias a texture shader would apply to a solid texture
+// value, to get the equivalent constant input value.
+ColorF FoldSolidTexture(const ColorF& value, const ColorF& scale,
+                        bool scale_baked, bool is_normal) {
+  ColorF folded;
+  for (size_t i = 0; i != kColorChannelCount; ++i) {
+    const float s = scale_baked ? 1.0f : scale.c[i];
+    folded.c[i] = is_normal ? value.c[i] * 2.0f * s - 1.0f : value.c[i] * s;
+  }
+  return folded;
+}
+
 }  // namespace
 
 using PXR_NS::SdfAssetPath;
@@ -50,6 +62,7 @@ void Materializer::Clear() {
   scope_ = UsdGeomScope();
   materials_.clear();
   texturator_.Clear();
+  file_inputs_.clear();
 }
 
 void Materializer::Begin(ConvertContext* cc) {
@@ -61,6 +74,46 @@ void Materializer::Begin(ConvertContext* cc) {
 
 void Materializer::End() {
   texturator_.End();
+
+  // Update references to images renamed due to format changes.
+  const std::map<std::string, std::string>& renamed = texturator_.GetRenamed();
+  if (!renamed.empty()) {
+    ContentLayerSentry layer_sentry(cc_, kContentLayerMaterials);
+    for (auto& file_input : file_inputs_) {
+      const auto found = renamed.find(file_input.first);
+      if (found != renamed.end()) {
+        file_input.second.Set(SdfAssetPath(found->second));
+      }
+    }
+  }
+}
+
+void Materializer::AddUvCoverage(Gltf::Id material_id,
+                                 Gltf::Mesh::Attribute::Number uvset_index,
+                                 float uv_area) {
+  const Gltf::Material* const material =
+      Gltf::GetById(cc_->gltf->materials, material_id);
+  if (!material) {
+    return;
+  }
+  const Gltf::Material::Texture* inputs[] = {
+      &material->pbr.baseColorTexture, &material->pbr.metallicRoughnessTexture,
+      &material->normalTexture, &material->occlusionTexture,
+      &material->emissiveTexture, nullptr, nullptr};
+  if (material->pbr.specGloss) {
+    inputs[5] = &material->pbr.specGloss->diffuseTexture;
+    inputs[6] = &material->pbr.specGloss->specularGlossinessTexture;
+  }
+  for (const Gltf::Material::Texture* const input : inputs) {
+    if (!input || input->texCoord != uvset_index) {
+      continue;
+    }
+    const Gltf::Texture* const texture =
+        Gltf::GetById(cc_->gltf->textures, input->index);
+    if (texture && texture->source != Gltf::Id::kNull) {
+      texturator_.AddImageCoverage(texture->source, uv_area);
+    }
+  }
 }
 
 const Materializer::Value& Materializer::FindOrCreate(Gltf::Id material_id) {
@@ -77,9 +130,9 @@ const Materializer::Value& Materializer::FindOrCreate(Gltf::Id material_id) {
     return value;
   }
 
-  const std::string material_path_str = cc_->path_table.MakeUnique(
+  ContentLayerSentry layer_sentry(cc_, kContentLayerMaterials);
+  value.path = cc_->path_table.MakeUnique(
       scope_.GetPath(), "material", material.name, material_index);
-  value.path = SdfPath(material_path_str);
   value.material = UsdShadeMaterial::Define(cc_->stage, value.path);
 
   const SdfPath pbr_shader_path = value.path.AppendElementString("pbr_shader");
@@ -235,8 +288,10 @@ UsdShadeShader Materializer::CreateTextureShader(
   const SdfPath tex_path = material_path.AppendElementString(name);
   UsdShadeShader tex = UsdShadeShader::Define(cc_->stage, tex_path);
   tex.CreateIdAttr(VtValue(kTokUvTexture));
-  tex.CreateInput(kTokFile, SdfValueTypeNames->Asset)
-      .Set(SdfAssetPath(usd_path));
+  UsdShadeInput file_input =
+      tex.CreateInput(kTokFile, SdfValueTypeNames->Asset);
+  file_input.Set(SdfAssetPath(usd_path));
+  file_inputs_.push_back(std::make_pair(usd_path, file_input));
 
   const auto uvset_found = uvsets.find(uvset_index);
   UFG_ASSERT_LOGIC(uvset_found != uvsets.end());
@@ -347,6 +402,14 @@ void Materializer::AttachTextureInput(
   UsdShadeInput in = pbr_shader->CreateInput(input_tok, input_type);
   const Gltf::Texture* const texture =
       Gltf::GetById(cc_->gltf->textures, input.index);
+  ColorF solid_value;
+  if (texture && cc_->settings.fold_solid_textures &&
+      texturator_.GetSolidValue(texture->source, tex_args, &solid_value)) {
+    in.Set(ColorToVec<Vec>(FoldSolidTexture(
+        solid_value, tex_args.scale,
+        cc_->settings.bake_texture_color_scale_bias, is_normal)));
+    return;
+  }
   const bool uvset_valid =
       !texture ||
       AddMaterialTextureUvset(material_id, material_path, input, uvsets);
@@ -448,6 +511,26 @@ void Materializer::AttachBaseTextureInput(
     const TfToken& tok, UvsetMap* uvsets, UsdShadeShader* pbr_shader) {
   const Gltf::Texture* const texture =
       Gltf::GetById(cc_->gltf->textures, input.index);
+  ColorF solid_value;
+  if (texture && cc_->settings.fold_solid_textures &&
+      texturator_.GetSolidValue(texture->source, tex_args, &solid_value)) {
+    // Attach as untextured, with the solid color folded into the constant
+    // color and opacity.
+    // * When baking, the alpha factor is only baked into the texture for
+    //   non-blended materials. Otherwise it's carried in the opacity.
+    const bool scale_baked = cc_->settings.bake_texture_color_scale_bias;
+    Texturator::Args folded_args = tex_args;
+    folded_args.scale =
+        FoldSolidTexture(solid_value, tex_args.scale, scale_baked, false);
+    folded_args.scale.a = solid_value.a * (scale_baked ? tex_args.opacity
+                                                       : tex_args.scale.a);
+    folded_args.bias = ColorF::kZero;
+    folded_args.opacity = folded_args.scale.a;
+    AttachBaseTextureInput(
+        nullptr, folded_args, input, material_id, material_path, tok,
+        uvsets, pbr_shader);
+    return;
+  }
   const std::string* const usd_name =
       texture ? &texturator_.Add(texture->source, tex_args) : nullptr;
   AttachBaseTextureInput(
@@ -18,6 +18,9 @@
 #define UFG_CONVERT_MATERIALIZER_H_
 
 #include <map>
+#include <string>
+#include <utility>
+#include <vector>
 #include "common/common_util.h"
 #include "common/config.h"
 #include "common/logging.h"
@@ -38,6 +41,7 @@ using PXR_NS::SdfPath;
 using PXR_NS::SdfValueTypeName;
 using PXR_NS::TfToken;
 using PXR_NS::UsdGeomScope;
+using PXR_NS::UsdShadeInput;
 using PXR_NS::UsdShadeMaterial;
 using PXR_NS::UsdShadeShader;
 using PXR_NS::UsdStageRefPtr;
@@ -67,6 +71,11 @@ class Materializer {
   void End();
   const Value& FindOrCreate(Gltf::Id material_id);
   bool IsInvisible(Gltf::Id material_id);
+
+  // Accumulate UV-space area for textures in the material referencing a uvset,
+  // used to weight the image size budget.
+  void AddUvCoverage(Gltf::Id material_id,
+                     Gltf::Mesh::Attribute::Number uvset_index, float uv_area);
   const std::vector<std::string>& GetWritten() const {
     return texturator_.GetWritten();
   }
@@ -95,6 +104,10 @@ class Materializer {
   Map materials_;
   Texturator texturator_;
 
+  // Texture file inputs and the image names they reference, used to update
+  // references if the texturator renames images.
+  std::vector<std::pair<std::string, UsdShadeInput>> file_inputs_;
+
   Texturator::Args GetDefaultTextureArgs() const;
   bool AddMaterialTextureUvset(
       Gltf::Id material_id, const SdfPath& material_path,
@@ -16,7 +16,12 @@
 
 #include "convert/package.h"
 
+#include <set>
+
 #include "common/common_util.h"
+#include "common/memory_tracker.h"
+#include "common/output_writer.h"
+#include "common/platform.h"
 #include "convert/converter.h"
 #include "gltf/gltf.h"
 #include "gltf/message.h"
@@ -169,72 +174,69 @@ class UsdMessageHandler : public TfDiagnosticMgr::Delegate {
  private:
   Logger* logger_ = nullptr;
 };
-}  // namespace
-
-bool RegisterPlugins(const std::string& path, Logger* logger) {
-  UsdMessageHandler usd_message_handler(logger);
 
-  std::string search_path;
-  PlugRegistry& registry = PlugRegistry::GetInstance();
-  if (!path.empty()) {
-    search_path = path;
-    registry.RegisterPlugins(path);
-  } else {
-    const PlugPluginPtr usd_plugin = registry.GetPluginWithName("usd");
-    if (!usd_plugin) {
-      // Expected plugins aren't registered. Search system paths.
-      search_path = GetDefaultPluginPath();
-      if (!search_path.empty()) {
-        registry.RegisterPlugins(search_path);
-      }
-    }
+// Open and load the source glTF, returning null on failure.
+std::unique_ptr<GltfStream> LoadGltf(const char* src_gltf_path,
+                                     const std::string& src_dir,
+                                     const GltfLoadSettings& load_settings,
+                                     Gltf* out_gltf, Logger* logger) {
+  std::unique_ptr<GltfStream> gltf_stream =
+      GltfStream::Open(logger, src_gltf_path, src_dir.c_str());
+  if (!gltf_stream) {
+    return nullptr;
   }
-
-  if (!registry.GetPluginWithName("usd")) {
-    const std::string why =
-        search_path.empty() ? "Could not locate plugin search path."
-                            : "No plugins found at search path: " + search_path;
-    Log<UFG_ERROR_LOAD_PLUGINS>(logger, "", why.c_str());
-    return false;
+  if (!GltfLoadAndValidate(gltf_stream.get(), src_gltf_path, load_settings,
+                           out_gltf, logger)) {
+    return nullptr;
   }
+  return gltf_stream;
+}
 
-  // In statically-linked builds of the USD library this type doesn't get
-  // automatically registered because it relies on a static constructor being
-  // called in an otherwise unreferenced object file (gf/half.cpp).
-  if (TfType::Find<GfHalf>() == TfType::GetUnknownType()) {
-    TfType::Define<GfHalf>();
+// Get the total size of files that exist at the given paths.
+size_t GetTotalFileSize(const std::vector<std::string>& paths) {
+  size_t total = 0;
+  for (const std::string& path : paths) {
+    if (!path.empty()) {
+      total += GetFileSize(path.c_str());
+    }
   }
-
-#if defined(_MSC_VER) && defined(USD_STATICALLY_LINKED)
-  // Same issue as with the GfHalf registration: This function should be called
-  // via a static constructor in arch/initConfig.cpp, but it's getting stripped
-  // because the object file is not otherwise referenced.
-  // * Note, there are other setup functions called in initConfig.cpp, but they
-  //   don't affect us.
-  PXR_NS::Arch_InitTmpDir();
-#endif  // defined(_MSC_VER) && defined(USD_STATICALLY_LINKED)
-  return true;
+  return total;
 }
 
-bool ConvertGltfToUsd(const char* src_gltf_path, const char* dst_usd_path,
-                      const ConvertSettings& settings, Logger* logger) {
-  UsdMessageHandler usd_message_handler(logger);
-
-  std::string src_dir, src_name;
-  Gltf::SplitPath(src_gltf_path, &src_dir, &src_name);
-
-  std::unique_ptr<GltfStream> gltf_stream =
-      GltfStream::Open(logger, src_gltf_path, src_dir.c_str());
-  if (!gltf_stream) {
-    return false;
+// Applies a memory limit to a tracker for the lifetime of the sentry, so the
+// tracker never references the cancel token after it's destroyed.
+class MemoryLimitSentry {
+ public:
+  MemoryLimitSentry(MemoryTracker* tracker, uint32_t limit_mb,
+                    CancelToken* cancel)
+      : tracker_(tracker) {
+    tracker_->SetLimit(static_cast<size_t>(limit_mb) * 1024 * 1024, cancel);
   }
+  ~MemoryLimitSentry() { tracker_->SetLimit(0, nullptr); }
 
-  Gltf gltf;
-  if (!GltfLoadAndValidate(gltf_stream.get(), src_gltf_path,
-                           settings.gltf_load_settings, &gltf, logger)) {
+ private:
+  MemoryTracker* tracker_;
+};
+
+// If the conversion is cancelled, log it, record the phase in the report, and
+// return true.
+bool HandleCancel(const ConvertSettings& settings, ConvertPhase phase,
+                  ConvertReport* report, Logger* logger) {
+  if (!settings.cancel_token || !settings.cancel_token->IsCancelled()) {
     return false;
   }
+  report->stats.cancel_phase = phase;
+  LogCancel(settings.cancel_token, settings.timeout, settings.memory_tracker,
+            phase, logger);
+  return true;
+}
 
+// Convert loaded glTF and write it to the destination USD path.
+// * The report is populated with conversion stats and output sizes.
+bool WriteUsd(const Gltf& gltf, GltfStream* gltf_stream,
+              const std::string& src_dir, const std::string& src_name,
+              const char* dst_usd_path, const ConvertSettings& settings,
+              ConvertShared* shared, Logger* logger, ConvertReport* report) {
   const bool is_both = Gltf::StringEndsWithCI(dst_usd_path, ".usd-");
   const bool is_usdz = is_both ||
       Gltf::StringEndsWithCI(dst_usd_path, ".usdz");
@@ -258,28 +260,110 @@ bool ConvertGltfToUsd(const char* src_gltf_path, const char* dst_usd_path,
   }
   Converter converter;
   const bool convert_success =
-      converter.Convert(settings, gltf, gltf_stream.get(), src_dir, dst_dir,
-                        dst_name, gltf_layer, logger);
+      converter.Convert(settings, gltf, gltf_stream, src_dir, dst_dir,
+                        dst_name, gltf_layer, shared, logger);
   CleanerSentry cleaner_sentry(&converter, logger);
+  report->stats = converter.GetStats();
   if (!convert_success) {
     // Error message already logged on failure.
     return false;
   }
+  PhaseSentry write_phase_sentry(
+      &report->stats, kPhaseWrite,
+      settings.print_timing ? settings.memory_tracker : nullptr, logger);
+
+  // Content layers are exported on the writer thread while the root layer is
+  // assembled. The writer also syncs written files according to fsync_policy.
+  // It's declared after the cleaner sentry, so it stops before the cleaner
+  // deletes anything.
+  OutputWriter writer;
+  writer.Start(settings.write_queue_limit,
+               static_cast<OutputWriter::FsyncPolicy>(settings.fsync_policy));
+  OutputWriter::StopSentry writer_sentry(&writer);
+  const auto flush_writes = [&]() {
+    const std::vector<std::string> failed_paths = writer.Flush();
+    for (const std::string& path : failed_paths) {
+      Log<UFG_ERROR_IO_WRITE_USD>(logger, "", path.c_str());
+    }
+    return failed_paths.empty();
+  };
+
+  // USD files written so far, deleted if the conversion is cancelled before
+  // it completes.
+  std::vector<std::string> usd_paths;
+  const auto is_cancelled = [&]() {
+    if (!HandleCancel(settings, kPhaseWrite, report, logger)) {
+      return false;
+    }
+    // Wait for queued exports before deleting their files.
+    writer.Flush();
+    for (const std::string& path : usd_paths) {
+      UfgDeleteFile(path.c_str(), logger);
+    }
+    return true;
+  };
+
+  // Write split content layers alongside the root layer. The converted root
+  // layer references them by anonymous identifier, so export a copy that
+  // references them by relative path.
+  SdfLayerRefPtr dst_layer = gltf_layer;
+  std::vector<std::string> content_layer_paths;
+  if (settings.split_layers) {
+    std::vector<std::string> sublayer_names;
+    for (size_t i = kContentLayerRoot + 1; i != kContentLayerCount; ++i) {
+      const ContentLayer content_layer = static_cast<ContentLayer>(i);
+      const SdfLayerRefPtr& layer = converter.GetContentLayer(content_layer);
+      if (!layer || layer->IsEmpty()) {
+        continue;
+      }
+      const std::string name =
+          AddFileNameSuffix(dst_name, GetContentLayerSuffix(content_layer));
+      const std::string path = Gltf::JoinPath(dst_dir, name);
+      if (is_cancelled()) {
+        return false;
+      }
+      writer.Run(path, [layer, path]() { return layer->Export(path); });
+      usd_paths.push_back(path);
+      sublayer_names.push_back(name);
+      content_layer_paths.push_back(path);
+    }
+    dst_layer = SdfLayer::CreateAnonymous(".usda");
+    dst_layer->TransferContent(gltf_layer);
+    dst_layer->SetSubLayerPaths(sublayer_names);
+  }
 
-  gltf_layer->Export(dst_path);
+  if (is_cancelled()) {
+    return false;
+  }
+  writer.Run(dst_path, [dst_layer, dst_path]() {
+    return dst_layer->Export(dst_path);
+  });
+  usd_paths.push_back(dst_path);
+  if (!flush_writes()) {
+    return false;
+  }
 
   // Save again as USDA.
   // * Note, this has to occur before packing to USDZ, because
   //   UsdUtilsCreateNewARKitUsdzPackage somehow modifies resource paths of the
   //   currently open layer.
   if (is_both) {
-    if (!gltf_layer->Export(dst_usda_path)) {
+    if (is_cancelled()) {
+      return false;
+    }
+    if (!dst_layer->Export(dst_usda_path)) {
       Log<UFG_ERROR_IO_WRITE_USD>(logger, "", dst_usda_path.c_str());
       return false;
     }
+    usd_paths.push_back(dst_usda_path);
+    writer.Sync(dst_usda_path);
   }
 
   if (is_usdz) {
+    if (is_cancelled()) {
+      return false;
+    }
+
     // The package function will encode full paths in the zip if the package
     // path is not under the current working directory (even when both the
     // package and the contents are in the same directory). This breaks the iOS
@@ -293,19 +377,244 @@ bool ConvertGltfToUsd(const char* src_gltf_path, const char* dst_usd_path,
       return false;
     }
     SetCwd(old_dir.c_str());
+    writer.Sync(dst_usdz_path);
 
-    // Delete unused USDC file.
+    // Delete unused USDC file. Split content layers are flattened into the
+    // package, so they're also unused.
     if (settings.delete_unused || settings.delete_generated) {
       UfgDeleteFile(dst_path.c_str(), logger);
+      if (!is_both) {
+        for (const std::string& path : content_layer_paths) {
+          UfgDeleteFile(path.c_str(), logger);
+        }
+      }
     }
   }
 
+  if (!flush_writes()) {
+    return false;
+  }
+
   // Keep generated files on success if requested.
   const bool is_usda = !is_usdz || is_both;
-  if (!settings.delete_generated && (!settings.delete_unused || is_usda)) {
+  const bool keep_generated =
+      !settings.delete_generated && (!settings.delete_unused || is_usda);
+  if (keep_generated) {
     cleaner_sentry.KeepFiles();
   }
 
+  // Deleted intermediate files don't exist, so they don't contribute. Generated
+  // files not being kept still exist until the cleaner sentry deletes them.
+  report->bytes_written =
+      GetTotalFileSize({dst_path, dst_usda_path, dst_usdz_path}) +
+      GetTotalFileSize(content_layer_paths);
+  if (keep_generated) {
+    report->bytes_written += GetTotalFileSize(converter.GetWritten());
+  }
   return true;
 }
+}  // namespace
+
+bool RegisterPlugins(const std::string& path, Logger* logger) {
+  UsdMessageHandler usd_message_handler(logger);
+
+  std::string search_path;
+  PlugRegistry& registry = PlugRegistry::GetInstance();
+  if (!path.empty()) {
+    search_path = path;
+    registry.RegisterPlugins(path);
+  } else {
+    const PlugPluginPtr usd_plugin = registry.GetPluginWithName("usd");
+    if (!usd_plugin) {
+      // Expected plugins aren't registered. Search system paths.
+      search_path = GetDefaultPluginPath();
+      if (!search_path.empty()) {
+        registry.RegisterPlugins(search_path);
+      }
+    }
+  }
+
+  if (!registry.GetPluginWithName("usd")) {
+    const std::string why =
+        search_path.empty() ? "Could not locate plugin search path."
+                            : "No plugins found at search path: " + search_path;
+    Log<UFG_ERROR_LOAD_PLUGINS>(logger, "", why.c_str());
+    return false;
+  }
+
+  // In statically-linked builds of the USD library this type doesn't get
+  // automatically registered because it relies on a static constructor being
+  // called in an otherwise unreferenced object file (gf/half.cpp).
+  if (TfType::Find<GfHalf>() == TfType::GetUnknownType()) {
+    TfType::Define<GfHalf>();
+  }
+
+#if defined(_MSC_VER) && defined(USD_STATICALLY_LINKED)
+  // Same issue as with the GfHalf registration: This function should be called
+  // via a static constructor in arch/initConfig.cpp, but it's getting stripped
+  // because the object file is not otherwise referenced.
+  // * Note, there are other setup functions called in initConfig.cpp, but they
+  //   don't affect us.
+  PXR_NS::Arch_InitTmpDir();
+#endif  // defined(_MSC_VER) && defined(USD_STATICALLY_LINKED)
+  return true;
+}
+
+bool ConvertGltfToUsd(const char* src_gltf_path, const char* dst_usd_path,
+                      const ConvertSettings& settings, Logger* logger,
+                      ConvertReport* report) {
+  UsdMessageHandler usd_message_handler(logger);
+
+  ConvertReport local_report;
+  if (!report) {
+    report = &local_report;
+  }
+  *report = ConvertReport();
+  report->src_path = src_gltf_path;
+  report->dst_path = dst_usd_path;
+
+  // The timeout applies to the whole conversion, including load and write.
+  CancelToken cancel(settings.cancel_token);
+  cancel.SetTimeout(settings.timeout);
+  ConvertSettings job_settings = settings;
+  job_settings.cancel_token = &cancel;
+
+  // Memory is tracked per model, and exceeding the limit cancels conversion.
+  MemoryTracker local_memory_tracker;
+  MemoryTracker* const memory_tracker = settings.memory_tracker
+                                            ? settings.memory_tracker
+                                            : &local_memory_tracker;
+  MemoryLimitSentry memory_limit_sentry(memory_tracker,
+                                        settings.memory_limit_mb, &cancel);
+  job_settings.memory_tracker = memory_tracker;
+
+  std::string src_dir, src_name;
+  Gltf::SplitPath(src_gltf_path, &src_dir, &src_name);
+
+  Gltf gltf;
+  ConvertStats load_stats;
+  std::unique_ptr<GltfStream> gltf_stream;
+  {
+    PhaseSentry phase_sentry(&load_stats, kPhaseLoad);
+    gltf_stream = LoadGltf(src_gltf_path, src_dir,
+                           settings.gltf_load_settings, &gltf, logger);
+  }
+  if (gltf_stream &&
+      !HandleCancel(job_settings, kPhaseLoad, report, logger)) {
+    report->success =
+        WriteUsd(gltf, gltf_stream.get(), src_dir, src_name, dst_usd_path,
+                 job_settings, nullptr, logger, report);
+  }
+  if (gltf_stream) {
+    report->src_dependencies = gltf_stream->GetSourcePaths();
+    report->src_missing_dependencies = gltf_stream->GetMissingSourcePaths();
+  }
+  report->stats.phase_seconds[kPhaseLoad] =
+      load_stats.phase_seconds[kPhaseLoad];
+  report->stats.bytes_read += GetFileSize(src_gltf_path);
+  report->peak_rss = GetPeakRss();
+  RecordMemoryPeaks(*memory_tracker, report);
+  return report->success;
+}
+
+bool ConvertGltfToUsdProfiles(const char* src_gltf_path,
+                              const std::vector<ConvertProfile>& profiles,
+                              Logger* logger,
+                              std::vector<ConvertReport>* reports) {
+  if (profiles.empty()) {
+    return true;
+  }
+  UsdMessageHandler usd_message_handler(logger);
+
+  std::vector<ConvertReport> local_reports;
+  if (!reports) {
+    reports = &local_reports;
+  }
+  reports->assign(profiles.size(), ConvertReport());
+  for (size_t i = 0; i != profiles.size(); ++i) {
+    (*reports)[i].src_path = src_gltf_path;
+    (*reports)[i].dst_path = profiles[i].dst_usd_path;
+  }
+
+  // Profiles generate images with the same names but different contents, so
+  // they can't share an output directory.
+  std::set<std::string> dst_dirs;
+  for (const ConvertProfile& profile : profiles) {
+    std::string dst_dir, dst_name;
+    Gltf::SplitPath(profile.dst_usd_path, &dst_dir, &dst_name);
+    if (!dst_dirs.insert(dst_dir).second) {
+      Log<UFG_ERROR_PROFILE_DST_DIR>(logger, "", dst_dir.c_str());
+      return false;
+    }
+  }
+
+  std::string src_dir, src_name;
+  Gltf::SplitPath(src_gltf_path, &src_dir, &src_name);
+
+  // The source is loaded once, so load time and size are attributed to the
+  // first profile. Each profile has its own timeout, with the first profile's
+  // also covering load time.
+  CancelToken load_cancel(profiles[0].settings.cancel_token);
+  load_cancel.SetTimeout(profiles[0].settings.timeout);
+
+  // Profiles share decoded source data, so they share a memory tracker, with
+  // each profile's limit applied while it converts.
+  MemoryTracker local_memory_tracker;
+  MemoryTracker* const memory_tracker =
+      profiles[0].settings.memory_tracker
+          ? profiles[0].settings.memory_tracker
+          : &local_memory_tracker;
+  Gltf gltf;
+  ConvertStats load_stats;
+  std::unique_ptr<GltfStream> gltf_stream;
+  {
+    // The first profile's limit also covers load, as its timeout does.
+    MemoryLimitSentry memory_limit_sentry(
+        memory_tracker, profiles[0].settings.memory_limit_mb, &load_cancel);
+    PhaseSentry phase_sentry(&load_stats, kPhaseLoad);
+    gltf_stream = LoadGltf(src_gltf_path, src_dir,
+                           profiles[0].settings.gltf_load_settings, &gltf,
+                           logger);
+  }
+
+  bool success = gltf_stream != nullptr;
+  if (gltf_stream) {
+    ConvertShared shared;
+    shared.Reset(&gltf, gltf_stream.get());
+    for (size_t i = 0; i != profiles.size(); ++i) {
+      const ConvertProfile& profile = profiles[i];
+      ConvertReport* const report = &(*reports)[i];
+
+      // Introduce each profile, so the messages that follow are attributed to
+      // it.
+      Log<UFG_INFO_PROFILE_BEGIN>(logger, "", profile.dst_usd_path.c_str());
+      CancelToken profile_cancel(profile.settings.cancel_token);
+      profile_cancel.SetTimeout(profile.settings.timeout);
+      ConvertSettings settings = profile.settings;
+      settings.cancel_token = i == 0 ? &load_cancel : &profile_cancel;
+      settings.memory_tracker = memory_tracker;
+      MemoryLimitSentry memory_limit_sentry(
+          memory_tracker, settings.memory_limit_mb,
+          i == 0 ? &load_cancel : &profile_cancel);
+      report->success =
+          !(i == 0 && HandleCancel(settings, kPhaseLoad, report, logger)) &&
+          WriteUsd(gltf, gltf_stream.get(), src_dir, src_name,
+                   profile.dst_usd_path.c_str(), settings, &shared, logger,
+                   report);
+      report->src_dependencies = gltf_stream->GetSourcePaths();
+      report->src_missing_dependencies =
+          gltf_stream->GetMissingSourcePaths();
+      report->peak_rss = GetPeakRss();
+      RecordMemoryPeaks(*memory_tracker, report);
+      if (!report->success) {
+        success = false;
+      }
+    }
+  }
+  ConvertReport& first_report = (*reports)[0];
+  first_report.stats.phase_seconds[kPhaseLoad] =
+      load_stats.phase_seconds[kPhaseLoad];
+  first_report.stats.bytes_read += GetFileSize(src_gltf_path);
+  return success;
+}
 }  // namespace ufg
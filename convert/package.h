@@ -17,9 +17,12 @@
 #ifndef UFG_CONVERT_PACKAGE_H_
 #define UFG_CONVERT_PACKAGE_H_
 
+#include <string>
+#include <vector>
 #include "common/common.h"
 #include "common/config.h"
 #include "common/logging.h"
+#include "convert/convert_report.h"
 
 namespace ufg {
 // Register plugins at the given path.
@@ -27,8 +30,28 @@ namespace ufg {
 // path.
 bool RegisterPlugins(const std::string& path, Logger* logger);
 
+// Convert glTF to USD.
+// * If report is set, it's populated with conversion statistics.
 bool ConvertGltfToUsd(const char* src_gltf_path, const char* dst_usd_path,
-                      const ConvertSettings& settings, Logger* logger);
+                      const ConvertSettings& settings, Logger* logger,
+                      ConvertReport* report = nullptr);
+
+// Output path and settings for one target of a multi-profile conversion.
+struct ConvertProfile {
+  std::string dst_usd_path;
+  ConvertSettings settings;
+};
+
+// Convert glTF to multiple USD targets (e.g. high, medium, and low quality
+// variants), loading the glTF once and sharing settings-independent data
+// (buffers, meshes, and decoded source images) between targets.
+// * Loader settings are taken from the first profile.
+// * Each profile must write to a different directory.
+// * If reports is set, it's populated with a report for each profile.
+bool ConvertGltfToUsdProfiles(const char* src_gltf_path,
+                              const std::vector<ConvertProfile>& profiles,
+                              Logger* logger,
+                              std::vector<ConvertReport>* reports = nullptr);
 }  // namespace ufg
 
 #endif  // UFG_CONVERT_PACKAGE_H_
@@ -16,6 +16,9 @@
 
 #include "convert/texturator.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "gltf/disk_util.h"
 #include "process/float_image.h"
 #include "process/math.h"
@@ -78,23 +81,26 @@ struct UsageInfo {
   // Color space for source and destination RGB components. A is always linear.
   ColorSpace src_rgb_color_space;
   ColorSpace dst_rgb_color_space;
+  // Relative importance of preserving resolution, used when allocating the
+  // image size budget with limit_total_image_weighted.
+  float budget_weight;
 };
 
-#define TEXUSG(suffix, comps, rel, src, dst) \
-  {suffix, comps, kRelevance##rel, kColorSpace##src, kColorSpace##dst}
+#define TEXUSG(suffix, comps, rel, src, dst, weight) \
+  {suffix, comps, kRelevance##rel, kColorSpace##src, kColorSpace##dst, weight}
 const UsageInfo kUsageInfos[] = {
-    TEXUSG(""        , 4, RGBA, Srgb  , Srgb  ),  // kUsageDefault
-    TEXUSG("_lin"    , 4, RGBA, Srgb  , Linear),  // kUsageLinear
-    TEXUSG("_base"   , 4, RGBA, Srgb  , Srgb  ),  // kUsageDiffToBase
-    TEXUSG(""        , 3, RGB , Linear, Linear),  // kUsageNorm
-    TEXUSG("_occl"   , 1, R   , Linear, Linear),  // kUsageOccl
-    TEXUSG("_metal"  , 1, B   , Linear, Linear),  // kUsageMetal
-    TEXUSG("_rough"  , 1, G   , Linear, Linear),  // kUsageRough
-    TEXUSG("_spec"   , 3, RGB , Srgb  , Srgb  ),  // kUsageSpec
-    TEXUSG("_metal"  , 3, RGB , Srgb  , Linear),  // kUsageSpecToMetal
-    TEXUSG("_gloss"  , 1, A   , Linear, Linear),  // kUsageGloss
-    TEXUSG("_rough"  , 1, A   , Linear, Linear),  // kUsageGlossToRough
-    TEXUSG("_unlit_a", 4, A   , Srgb  , Srgb  ),  // kUsageUnlitA
+    TEXUSG(""        , 4, RGBA, Srgb  , Srgb  , 1.00f),  // kUsageDefault
+    TEXUSG("_lin"    , 4, RGBA, Srgb  , Linear, 0.50f),  // kUsageLinear
+    TEXUSG("_base"   , 4, RGBA, Srgb  , Srgb  , 1.00f),  // kUsageDiffToBase
+    TEXUSG(""        , 3, RGB , Linear, Linear, 0.75f),  // kUsageNorm
+    TEXUSG("_occl"   , 1, R   , Linear, Linear, 0.25f),  // kUsageOccl
+    TEXUSG("_metal"  , 1, B   , Linear, Linear, 0.50f),  // kUsageMetal
+    TEXUSG("_rough"  , 1, G   , Linear, Linear, 0.50f),  // kUsageRough
+    TEXUSG("_spec"   , 3, RGB , Srgb  , Srgb  , 0.50f),  // kUsageSpec
+    TEXUSG("_metal"  , 3, RGB , Srgb  , Linear, 0.50f),  // kUsageSpecToMetal
+    TEXUSG("_gloss"  , 1, A   , Linear, Linear, 0.50f),  // kUsageGloss
+    TEXUSG("_rough"  , 1, A   , Linear, Linear, 0.50f),  // kUsageGlossToRough
+    TEXUSG("_unlit_a", 4, A   , Srgb  , Srgb  , 0.50f),  // kUsageUnlitA
 };
 #undef TEXUSG
 static_assert(UFG_ARRAY_SIZE(kUsageInfos) == Texturator::kUsageCount, "");
@@ -248,6 +254,78 @@ std::string GetSrcName(const Gltf& gltf, Gltf::Id image_id,
   return std::string();
 }
 
+// Get the source channels that affect the output.
+RelevanceMask GetRelevanceMask(Texturator::Usage usage, uint32_t pass_mask) {
+  RelevanceMask relevance_mask = kUsageInfos[usage].relevance_mask;
+  if (pass_mask & kPassFlagRemoveAlpha) {
+    relevance_mask &= ~kRelevanceA;
+  }
+  return relevance_mask;
+}
+
+// Return true if all source channels relevant to the output are solid, in which
+// case the output is also solid.
+// * Solidity comes from Image::GetContents, so accidental alpha on edge pixels
+//   is ignored the same way it is for texture classification.
+bool IsSolidForUsage(const Image::Content (&contents)[kColorChannelCount],
+                     Texturator::Usage usage, uint32_t pass_mask) {
+  if (contents[kColorChannelR] == Image::kContentCount) {
+    // Contents not determined.
+    return false;
+  }
+  return Image::AreChannelsSolid(GetRelevanceMask(usage, pass_mask), contents);
+}
+
+// Return true if the source can be processed from a single pixel of its solid
+// color, with the same output as processing the whole image.
+// * This is stricter than IsSolidForUsage: edge pixels ignored for accidental
+//   alpha still affect full-size processing (e.g. resizing blends them
+//   inward), so they must also match the solid color.
+bool CanProcessAsSolid(
+    const Image& image, const Image::Content (&contents)[kColorChannelCount],
+    const Image::Component (&solid_color)[kColorChannelCount],
+    Texturator::Usage usage, uint32_t pass_mask) {
+  if (!IsSolidForUsage(contents, usage, pass_mask)) {
+    return false;
+  }
+  const size_t width = image.GetWidth();
+  const size_t height = image.GetHeight();
+  if (image.GetChannelCount() != kColorChannelCount || width == 0 ||
+      height == 0) {
+    // Edges are only ignored for RGBA images.
+    return true;
+  }
+  const RelevanceMask relevance_mask = GetRelevanceMask(usage, pass_mask);
+  const Image::Component* const data = image.GetData();
+  const auto is_solid_pixel = [&](size_t x, size_t y) {
+    const Image::Component* const pixel =
+        data + (y * width + x) * kColorChannelCount;
+    for (uint32_t i = 0; i != kColorChannelCount; ++i) {
+      if ((relevance_mask & (1 << i)) && pixel[i] != solid_color[i]) {
+        return false;
+      }
+    }
+    return true;
+  };
+  for (size_t x = 0; x != width; ++x) {
+    if (!is_solid_pixel(x, 0) || !is_solid_pixel(x, height - 1)) {
+      return false;
+    }
+  }
+  for (size_t y = 0; y != height; ++y) {
+    if (!is_solid_pixel(0, y) || !is_solid_pixel(width - 1, y)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Determine if processing reduced a larger source image to a solid 1x1 output.
+bool IsReducedToSolid(const Image& src_image, const Image& dst_image) {
+  return (src_image.GetWidth() != 1 || src_image.GetHeight() != 1) &&
+         dst_image.GetWidth() == 1 && dst_image.GetHeight() == 1;
+}
+
 void ApplyFloatPasses(const Texturator::Args& args, uint32_t pass_mask,
                       size_t width, size_t height, FloatImage* image) {
   if (pass_mask & kPassFlagScaleBias) {
@@ -322,6 +400,16 @@ void Texturator::Clear() {
   bias_ids_.clear();
   jobs_.clear();
   written_.clear();
+  deferred_outputs_.clear();
+  fixed_file_size_ = 0;
+  renamed_.clear();
+  format_saved_size_ = 0;
+  solid_counted_.clear();
+  image_coverages_.clear();
+
+  // Discard failures left by an interrupted conversion.
+  writer_.Stop();
+  writer_.Flush();
 }
 
 void Texturator::Begin(ConvertContext* cc) {
@@ -329,23 +417,34 @@ void Texturator::Begin(ConvertContext* cc) {
 }
 
 void Texturator::End() {
-  // Apply global resize scale.
-  const float global_scale = ChooseGlobalScale();
-  if (global_scale != 1.0f) {
-    for (Job& job : jobs_) {
-      const size_t op_count = job.type == kJobAddSpecToMetal ? 2 : 1;
-      for (size_t op_index = 0; op_index != op_count; ++op_index) {
-        Op& op = job.ops[op_index];
-        if (op.src->image) {
-          const Image& image = *op.src->image;
-          const uint32_t src_width = image.GetWidth();
-          const uint32_t src_height = image.GetHeight();
-          GetDstSize(src_width, src_height, op.args.resize, global_scale,
-                     &op.resize_width, &op.resize_height);
-          if (op.resize_width != src_width || op.resize_height != src_height) {
-            op.pass_mask |= kPassFlagResize;
-            op.direct_copy = false;
-          }
+  // Apply resize scale to fit the decompressed size limit.
+  std::vector<float> job_scales;
+  if (cc_->settings.limit_total_image_weighted) {
+    ChooseJobScales(&job_scales);
+  } else {
+    job_scales.assign(jobs_.size(), ChooseGlobalScale());
+  }
+  for (const float job_scale : job_scales) {
+    cc_->stats.image_scale = std::min(cc_->stats.image_scale, job_scale);
+  }
+  for (size_t job_index = 0; job_index != jobs_.size(); ++job_index) {
+    const float job_scale = job_scales[job_index];
+    if (job_scale == 1.0f) {
+      continue;
+    }
+    Job& job = jobs_[job_index];
+    const size_t op_count = job.type == kJobAddSpecToMetal ? 2 : 1;
+    for (size_t op_index = 0; op_index != op_count; ++op_index) {
+      Op& op = job.ops[op_index];
+      if (op.src->image) {
+        const Image& image = *op.src->image;
+        const uint32_t src_width = image.GetWidth();
+        const uint32_t src_height = image.GetHeight();
+        GetDstSize(src_width, src_height, op.args.resize, job_scale,
+                   &op.resize_width, &op.resize_height);
+        if (op.resize_width != src_width || op.resize_height != src_height) {
+          op.pass_mask |= kPassFlagResize;
+          op.direct_copy = false;
         }
       }
     }
@@ -368,10 +467,17 @@ void Texturator::End() {
     return;
   }
 
+  // Encoded images are handed to a background writer, so encoding the next
+  // image overlaps with writing the previous one.
+  writer_.Start(
+      cc_->settings.write_queue_limit,
+      static_cast<OutputWriter::FsyncPolicy>(cc_->settings.fsync_policy));
+  OutputWriter::StopSentry writer_sentry(&writer_);
+
   // Process jobs sequentially.
   // Note, this could be multithreaded but there are several issues that make it
   // impractical currently:
-  // - The logging and IO caching are not thread-safe.
+  // - The IO caching is not thread-safe.
   // - There are a limited number of textures, so we don't get high utilization
   //   by processing them in parallel. To get better utilization, we need to
   //   break up the images themselves into smaller sections.
@@ -379,8 +485,14 @@ void Texturator::End() {
   //   a process basis, so multithreading within each process helps very little
   //   (and in some cases may be detrimental).
   for (const Job& job : jobs_) {
+    CheckCancel(cc_->settings.cancel_token);
     ProcessJob(job);
   }
+
+  if (IsDeferringOutputs()) {
+    WriteDeferredOutputs();
+  }
+  FlushWrites();
 }
 
 const std::string& Texturator::Add(Gltf::Id image_id, const Args& args) {
@@ -475,6 +587,44 @@ bool Texturator::IsAlphaFullyTransparent(
   return a <= kColorTol;
 }
 
+bool Texturator::GetSolidValue(Gltf::Id image_id, const Args& args,
+                               ColorF* out_value) {
+  Src* const src = FindOrAddSrc(image_id);
+  if (!src) {
+    return false;
+  }
+  EnsureComponentContent(image_id, src);
+  if (!src->image) {
+    return false;
+  }
+  Op op(image_id, args);
+  GetDstSuffix(args, image_id, src, &op);
+  if (!IsSolidForUsage(src->rgba_contents, args.usage, op.pass_mask)) {
+    return false;
+  }
+
+  // Run the same passes used to generate the texture, on a single pixel, so the
+  // value matches what would be sampled from the written texture.
+  Image solid_src_image;
+  solid_src_image.Create1x1(src->solid_color, src->image->GetChannelCount());
+  const std::unique_ptr<Image> image = ProcessImage(
+      solid_src_image, args, op.pass_mask & ~kPassFlagResize, 0, 0);
+  const uint32_t channel_count = image->GetChannelCount();
+  const bool is_srgb = channel_count >= 3 &&
+      kUsageInfos[args.usage].dst_rgb_color_space == kColorSpaceSrgb;
+  std::vector<float> value;
+  image->ToFloat(is_srgb, &value);
+  *out_value = ColorF::kOne;
+  for (uint32_t i = 0; i != channel_count; ++i) {
+    out_value->c[i] = value[i];
+  }
+  // Materials may reference the same image many times, so only count it once.
+  if (solid_counted_.insert(image_id).second) {
+    ++cc_->stats.images_solid;
+  }
+  return true;
+}
+
 Texturator::ColorId Texturator::GetColorId(
     const ColorF& color, const ColorI& identity, ColorIdMap* color_id_map) {
   const ColorI q = Quantize(color);
@@ -587,11 +737,16 @@ const std::string& Texturator::AddFallback(Fallback fallback) {
     image.Create1x1(info.color);
   }
 
+  // Fallbacks are encoded in memory so their size counts towards the image file
+  // size limit.
   const std::string dst_path = Gltf::JoinPath(cc_->dst_dir, dst_name);
   if (PrepareWrite(dst_path)) {
-    if (!image.Write(dst_path.c_str(), cc_->settings, cc_->logger)) {
+    std::vector<uint8_t> data;
+    if (!image.EncodePng(cc_->settings, &data, cc_->logger) ||
+        !GltfDiskWriteBinary(dst_path, data.data(), data.size())) {
       Log<UFG_ERROR_IO_WRITE_IMAGE>(dst_path.c_str());
     }
+    fixed_file_size_ += data.size();
   }
   return dst_name;
 }
@@ -604,23 +759,61 @@ void Texturator::LoadSrc(Gltf::Id image_id, Src* src) const {
   Gltf::Image::MimeType named_mime_type;
   src->name = GetSrcName(*cc_->gltf, image_id, &named_mime_type);
   UFG_ASSERT_LOGIC(!src->name.empty());
-  size_t size;
-  Gltf::Image::MimeType mime_type;
-  const uint8_t* const data =
-      cc_->gltf_cache.GetImageData(image_id, &size, &mime_type);
-  if (!data) {
-    src->state = kStateMissing;
+
+  // Reuse the decoded image if it was loaded by a prior conversion.
+  std::map<Gltf::Id, std::shared_ptr<const Image>>& images =
+      cc_->shared->images;
+  const auto found = images.find(image_id);
+  if (found != images.end()) {
+    src->image = found->second;
+    src->state = src->image ? kStateLoaded : kStateMissing;
+    if (!src->image) {
+      // Report the failure again, so each conversion's log is complete.
+      const std::vector<Message>& errors = cc_->shared->image_errors[image_id];
+      if (errors.empty()) {
+        GltfLog<GLTF_ERROR_MISSING_IMAGE>(cc_->logger, "", src->name.c_str());
+      }
+      for (const Message& message : errors) {
+        cc_->logger->Add(message);
+      }
+    }
     return;
   }
-  std::unique_ptr<Image> image(new Image());
-  {
-    Logger::NameSentry name_sentry(cc_->logger, src->name);
-    if (!image->Read(data, size, mime_type, cc_->logger)) {
-      src->state = kStateMissing;
-      return;
+
+  // Use the image decoded in the background if it was prefetched, otherwise
+  // load it now.
+  // * Messages are collected so they can be repeated if the load fails.
+  std::shared_ptr<Image> image;
+  GltfVectorLogger load_logger;
+  if (!cc_->image_prefetcher ||
+      !cc_->image_prefetcher->Take(image_id, src->name, &load_logger, &image)) {
+    size_t size;
+    Gltf::Image::MimeType mime_type;
+    const uint8_t* const data =
+        cc_->gltf_cache->GetImageData(image_id, &size, &mime_type);
+    if (data) {
+      image.reset(new Image());
+      Logger::NameSentry name_sentry(&load_logger, src->name);
+      if (!image->Read(data, size, mime_type, &load_logger)) {
+        image.reset();
+      }
     }
   }
-  src->image = std::move(image);
+  for (const Message& message : load_logger.GetMessages()) {
+    cc_->logger->Add(message);
+  }
+  if (!image) {
+    images[image_id] = nullptr;
+    cc_->shared->image_errors[image_id] = load_logger.GetMessages();
+    src->state = kStateMissing;
+    return;
+  }
+  ++cc_->stats.images_decoded;
+  cc_->shared->image_memory.Add(
+      static_cast<size_t>(image->GetWidth()) * image->GetHeight() *
+      image->GetChannelCount() * sizeof(Image::Component));
+  src->image = image;
+  images[image_id] = std::move(image);
   src->state = kStateLoaded;
 }
 
@@ -631,7 +824,7 @@ Texturator::Src* Texturator::FindOrAddSrc(Gltf::Id image_id) {
     return nullptr;
   }
   const auto src_insert_result = srcs_.insert(std::make_pair(image_id, Src()));
-  if (src_insert_result.second && !cc_->gltf_cache.ImageExists(image_id)) {
+  if (src_insert_result.second && !cc_->gltf_cache->ImageExists(image_id)) {
     Gltf::Image::MimeType mime_type;
     const std::string src_name = GetSrcName(*cc_->gltf, image_id, &mime_type);
     GltfLog<GLTF_ERROR_MISSING_IMAGE>(cc_->logger, "", src_name.c_str());
@@ -654,7 +847,7 @@ const std::string* Texturator::AddDst(Gltf::Id image_id, const Args& args,
   Src& src = src_insert_result.first->second;
   if (src_insert_result.second) {
     // Verify the source file exists.
-    if (!cc_->gltf_cache.ImageExists(image_id)) {
+    if (!cc_->gltf_cache->ImageExists(image_id)) {
       GltfLog<GLTF_ERROR_MISSING_IMAGE>(cc_->logger, "", src_name.c_str());
       return nullptr;
     }
@@ -694,6 +887,7 @@ const std::string* Texturator::AddDst(Gltf::Id image_id, const Args& args,
   }
   out_op->is_new = true;
 
+  out_op->dst_name = dst_name;
   out_op->dst_path = Gltf::JoinPath(cc_->dst_dir, dst_name);
   if (dst_suffix.empty() && dst_mime_type == mime_type) {
     if (cc_->settings.limit_total_image_decompressed_size != 0) {
@@ -702,7 +896,7 @@ const std::string* Texturator::AddDst(Gltf::Id image_id, const Args& args,
       LoadSrc(image_id, &src);
     }
     out_op->direct_copy = true;
-    out_op->need_copy = !cc_->gltf_cache.IsImageAtPath(
+    out_op->need_copy = !cc_->gltf_cache->IsImageAtPath(
         image_id, cc_->dst_dir.c_str(), dst_name.c_str());
     return &dst_name;
   }
@@ -712,6 +906,9 @@ const std::string* Texturator::AddDst(Gltf::Id image_id, const Args& args,
     return nullptr;
   }
 
+  // Determine source contents up front so solid sources can be processed from
+  // a single pixel.
+  EnsureComponentContent(image_id, &src);
   return &dst_name;
 }
 
@@ -896,9 +1093,105 @@ float Texturator::ChooseGlobalScale() const {
   return scale_power * scale_increment;
 }
 
+float Texturator::GetJobBudgetWeight(const Job& job) const {
+  // Weight by usage and the UV-space area referencing the image, so textures
+  // covering more of the model retain more resolution.
+  // * Images without coverage info (e.g. referenced only by meshes lacking
+  //   UVs) are given a nominal coverage of the full texture.
+  static constexpr float kCoverageMin = 1.0f / 1024.0f;
+  const size_t op_count = job.type == kJobAddSpecToMetal ? 2 : 1;
+  float weight = 0.0f;
+  for (size_t op_index = 0; op_index != op_count; ++op_index) {
+    const Op& op = job.ops[op_index];
+    const auto found = image_coverages_.find(op.image_id);
+    const float coverage =
+        found == image_coverages_.end() ? 1.0f : found->second;
+    weight += kUsageInfos[op.args.usage].budget_weight *
+              std::max(coverage, kCoverageMin);
+  }
+  return weight;
+}
+
+void Texturator::ChooseJobScales(std::vector<float>* out_scales) const {
+  const size_t job_count = jobs_.size();
+  out_scales->assign(job_count, 1.0f);
+  const size_t decompressed_limit =
+      cc_->settings.limit_total_image_decompressed_size;
+  if (decompressed_limit == 0) {
+    return;
+  }
+
+  std::vector<double> full_sizes(job_count);
+  std::vector<double> weights(job_count);
+  double full_total = 0.0;
+  for (size_t job_index = 0; job_index != job_count; ++job_index) {
+    full_sizes[job_index] = static_cast<double>(
+        EstimateDecompressedJobSize(jobs_[job_index], 1.0f));
+    weights[job_index] = GetJobBudgetWeight(jobs_[job_index]);
+    full_total += full_sizes[job_index];
+  }
+  if (full_total <= decompressed_limit) {
+    return;
+  }
+
+  // Allocate the budget proportionally to weight, capped at each job's full
+  // size, with the surplus from capped jobs redistributed to the rest
+  // (water-filling). Jobs are visited in order of increasing size-per-weight,
+  // so this completes in a single pass.
+  std::vector<size_t> order(job_count);
+  for (size_t job_index = 0; job_index != job_count; ++job_index) {
+    order[job_index] = job_index;
+  }
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return full_sizes[a] * weights[b] < full_sizes[b] * weights[a];
+  });
+
+  // The estimated size isn't exactly proportional to scale^2 due to alignment
+  // and size clamping, so reduce the budget until the estimate fits.
+  static constexpr size_t kAttemptMax = 8;
+  double budget = static_cast<double>(decompressed_limit);
+  size_t decompressed_total = 0;
+  for (size_t attempt = 0; attempt != kAttemptMax; ++attempt) {
+    double budget_remain = budget;
+    double weight_remain = 0.0;
+    for (const double weight : weights) {
+      weight_remain += weight;
+    }
+    for (const size_t job_index : order) {
+      const double full_size = full_sizes[job_index];
+      const double weight = weights[job_index];
+      const double share = weight_remain > 0.0
+                               ? budget_remain * weight / weight_remain
+                               : 0.0;
+      const double size = std::min(full_size, std::max(share, 0.0));
+      (*out_scales)[job_index] =
+          full_size > 0.0 ? static_cast<float>(std::sqrt(size / full_size))
+                          : 1.0f;
+      budget_remain -= size;
+      weight_remain -= weight;
+    }
+
+    decompressed_total = 0;
+    for (size_t job_index = 0; job_index != job_count; ++job_index) {
+      decompressed_total += EstimateDecompressedJobSize(
+          jobs_[job_index], (*out_scales)[job_index]);
+    }
+    if (decompressed_total <= decompressed_limit) {
+      return;
+    }
+    budget *= static_cast<double>(decompressed_limit) / decompressed_total;
+  }
+  Log<UFG_WARN_TEXTURE_LIMIT>(
+      job_count, decompressed_limit, decompressed_total);
+}
+
+void Texturator::AddImageCoverage(Gltf::Id image_id, float uv_area) {
+  image_coverages_[image_id] += uv_area;
+}
+
 bool Texturator::PrepareWrite(const std::string& dst_path) {
   UFG_ASSERT_LOGIC(!dst_path.empty());
-  if (cc_->gltf_cache.IsSourcePath(dst_path.c_str())) {
+  if (cc_->gltf_cache->IsSourcePath(dst_path.c_str())) {
     Log<UFG_ERROR_STOMP>(dst_path.c_str());
     return false;
   }
@@ -910,27 +1203,19 @@ bool Texturator::PrepareWrite(const std::string& dst_path) {
   return true;
 }
 
-void Texturator::ProcessAdd(const Op& op) {
-  // Copy the original file to the destination if it doesn't require any
-  // processing.
-  if (op.direct_copy) {
-    UFG_ASSERT(op.pass_mask == 0);
-    if (op.need_copy) {
-      cc_->gltf_cache.CopyImage(op.image_id, op.dst_path);
-    }
-    return;
-  }
-
-  const uint32_t pass_mask = op.pass_mask;
-  const Args& args = op.args;
-
-  // Generating new image.  Apply conversions.
+std::unique_ptr<Image> Texturator::ProcessImage(
+    const Image& src_image, const Args& args, uint32_t pass_mask,
+    uint32_t resize_width, uint32_t resize_height) const {
   std::unique_ptr<Image> image =
-      CopyImageByUsage(*op.src->image, args.usage, pass_mask);
+      CopyImageByUsage(src_image, args.usage, pass_mask);
+  if (pass_mask & kPassFlagResize) {
+    ++cc_->stats.images_resized;
+  }
   if (pass_mask & kPassMaskFloat) {
     const UsageInfo& usage_info = kUsageInfos[args.usage];
-    FloatImage float_image(*image, usage_info.src_rgb_color_space);
-    ApplyFloatPasses(args, pass_mask, op.resize_width, op.resize_height,
+    FloatImage float_image(*image, usage_info.src_rgb_color_space,
+                           cc_->settings.memory_tracker);
+    ApplyFloatPasses(args, pass_mask, resize_width, resize_height,
                      &float_image);
     float_image.CopyTo(usage_info.dst_rgb_color_space, &*image);
   }
@@ -956,11 +1241,330 @@ void Texturator::ProcessAdd(const Op& op) {
     // Shrink solid textures to 1x1 to save space.
     image->Create1x1(dst_solid_color, image->GetChannelCount());
   }
+  return image;
+}
 
-  const bool is_norm = args.usage == kUsageNorm;
-  if (!image->Write(op.dst_path.c_str(), cc_->settings, cc_->logger, is_norm)) {
+bool Texturator::IsDeferringOutputs() const {
+  return cc_->settings.limit_total_image_file_size != 0 ||
+         cc_->settings.pick_smaller_image_format;
+}
+
+bool Texturator::WriteImage(const Op& op, std::unique_ptr<Image> image,
+                            bool is_norm) {
+  if (IsDeferringOutputs()) {
+    // Defer encoding until all images are processed, so the format and JPG
+    // quality can be chosen based on encoded sizes.
+    deferred_outputs_.push_back(DeferredOutput());
+    DeferredOutput& output = deferred_outputs_.back();
+    output.dst_name = op.dst_name;
+    output.dst_path = op.dst_path;
+    output.is_jpg = !Gltf::StringEndsWithCI(op.dst_path.c_str(), ".png");
+    output.is_norm = is_norm;
+    output.image = std::move(image);
+    return true;
+  }
+  const ConvertSettings& settings = cc_->settings;
+  const bool is_jpg = !Gltf::StringEndsWithCI(op.dst_path.c_str(), ".png");
+  std::vector<uint8_t> data;
+  const bool success =
+      is_jpg ? image->EncodeJpg(settings,
+                                is_norm ? settings.jpg_quality_norm
+                                        : settings.jpg_quality,
+                                is_norm, &data, cc_->logger)
+             : image->EncodePng(settings, &data, cc_->logger);
+  if (!success) {
+    // Encoding stops early without an error if cancelled.
+    CheckCancel(settings.cancel_token);
     Log<UFG_ERROR_IO_WRITE_IMAGE>(op.dst_path.c_str());
+    return false;
+  }
+
+  // Write errors are logged by FlushWrites.
+  writer_.Write(op.dst_path, &data);
+  return true;
+}
+
+size_t Texturator::RunEncodeTasks(std::vector<EncodeTask>* tasks,
+                                  Scheduler* scheduler) const {
+  const ConvertSettings& settings = cc_->settings;
+
+  // Tasks log to their own buffers, which are forwarded in task order as tasks
+  // complete. This thread waits on the tasks, so it doesn't log concurrently.
+  SequencedLogger sequenced_logger(cc_->logger);
+  for (EncodeTask& task : *tasks) {
+    EncodeTask* const task_ptr = &task;
+    sequenced_logger.Begin(&task.logger);
+    scheduler->Schedule([task_ptr, &settings, &sequenced_logger]() {
+      EncodeTask& task = *task_ptr;
+
+      // Skip remaining work once cancelled. This can't throw here, because the
+      // scheduler must be stopped before unwinding.
+      const bool cancelled =
+          settings.cancel_token && settings.cancel_token->IsCancelled();
+      if (!cancelled) {
+        const DeferredOutput& output = *task.output;
+        Logger::NameSentry name_sentry(&task.logger, output.dst_path);
+        const bool success =
+            task.is_jpg
+                ? output.image->EncodeJpg(settings, task.jpg_quality,
+                                          output.is_norm, &task.data,
+                                          &task.logger)
+                : output.image->EncodePng(settings, &task.data, &task.logger);
+        if (!success) {
+          task.data.clear();
+        }
+      }
+      sequenced_logger.End(&task.logger);
+    });
+  }
+  scheduler->WaitForAllComplete();
+
+  size_t total = 0;
+  for (const EncodeTask& task : *tasks) {
+    total += task.data.size();
+  }
+  return total;
+}
+
+int Texturator::GetJpgQuality(const DeferredOutput& output,
+                              int jpg_quality) const {
+  if (!output.is_norm) {
+    return jpg_quality;
   }
+  // Maintain the relative quality of normal-maps.
+  const ConvertSettings& settings = cc_->settings;
+  return Clamp(jpg_quality + settings.jpg_quality_norm - settings.jpg_quality,
+               1, 100);
+}
+
+void Texturator::ChooseSmallerFormats(Scheduler* scheduler) {
+  // Encode opaque images in both formats. Images with alpha must remain PNG.
+  std::vector<EncodeTask> tasks;
+  tasks.reserve(2 * deferred_outputs_.size());
+  for (DeferredOutput& output : deferred_outputs_) {
+    if (output.image->GetChannelCount() == kColorChannelCount) {
+      continue;
+    }
+    for (const bool is_jpg : {false, true}) {
+      tasks.push_back(EncodeTask());
+      EncodeTask& task = tasks.back();
+      task.output = &output;
+      task.is_jpg = is_jpg;
+      task.jpg_quality = GetJpgQuality(output, cc_->settings.jpg_quality);
+    }
+  }
+  RunEncodeTasks(&tasks, scheduler);
+
+  size_t changed_count = 0;
+  size_t saved_size = 0;
+  for (size_t i = 0; i != tasks.size(); i += 2) {
+    EncodeTask& png_task = tasks[i];
+    EncodeTask& jpg_task = tasks[i + 1];
+    if (png_task.data.empty() || jpg_task.data.empty()) {
+      // Encoding failed. Just leave the output as-is.
+      continue;
+    }
+    DeferredOutput& output = *png_task.output;
+    EncodeTask& old_task = output.is_jpg ? jpg_task : png_task;
+    EncodeTask& new_task = output.is_jpg ? png_task : jpg_task;
+    if (new_task.data.size() >= old_task.data.size() ||
+        !RenameOutput(new_task.is_jpg, &output)) {
+      output.data.swap(old_task.data);
+      continue;
+    }
+    saved_size += old_task.data.size() - new_task.data.size();
+    ++changed_count;
+    output.data.swap(new_task.data);
+  }
+  format_saved_size_ += saved_size;
+  if (changed_count != 0) {
+    Log<UFG_INFO_IMAGE_FORMAT_SAVED>(saved_size, changed_count);
+  }
+}
+
+bool Texturator::RenameOutput(bool is_jpg, DeferredOutput* output) {
+  const Gltf::Image::MimeType mime_type =
+      is_jpg ? Gltf::Image::kMimeJpeg : Gltf::Image::kMimePng;
+  std::string new_name = output->dst_name;
+  SetImageExtension(mime_type, &new_name);
+  const std::string new_path = Gltf::JoinPath(cc_->dst_dir, new_name);
+  if (cc_->gltf_cache->IsSourcePath(new_path.c_str())) {
+    return false;
+  }
+  if (!dsts_.insert(new_name).second) {
+    // Another output already has this name.
+    return false;
+  }
+  for (std::string& written_path : written_) {
+    if (written_path == output->dst_path) {
+      written_path = new_path;
+    }
+  }
+  dsts_.erase(output->dst_name);
+  renamed_[output->dst_name] = new_name;
+  output->dst_name = new_name;
+  output->dst_path = new_path;
+  output->is_jpg = is_jpg;
+  return true;
+}
+
+void Texturator::EncodeRemainingOutputs(Scheduler* scheduler) {
+  std::vector<EncodeTask> tasks;
+  for (DeferredOutput& output : deferred_outputs_) {
+    if (output.data.empty()) {
+      tasks.push_back(EncodeTask());
+      EncodeTask& task = tasks.back();
+      task.output = &output;
+      task.is_jpg = output.is_jpg;
+      task.jpg_quality = GetJpgQuality(output, cc_->settings.jpg_quality);
+    }
+  }
+  RunEncodeTasks(&tasks, scheduler);
+  for (EncodeTask& task : tasks) {
+    task.output->data.swap(task.data);
+  }
+}
+
+size_t Texturator::EncodeJpgOutputs(int jpg_quality, Scheduler* scheduler,
+                                    std::vector<EncodeTask>* out_tasks) {
+  out_tasks->clear();
+  for (DeferredOutput& output : deferred_outputs_) {
+    if (output.is_jpg) {
+      out_tasks->push_back(EncodeTask());
+      EncodeTask& task = out_tasks->back();
+      task.output = &output;
+      task.is_jpg = true;
+      task.jpg_quality = GetJpgQuality(output, jpg_quality);
+    }
+  }
+  return RunEncodeTasks(out_tasks, scheduler);
+}
+
+void Texturator::LimitJpgQuality(Scheduler* scheduler) {
+  const ConvertSettings& settings = cc_->settings;
+  const size_t limit = settings.limit_total_image_file_size;
+
+  // PNG and copied image sizes don't depend on JPG quality.
+  EncodeRemainingOutputs(scheduler);
+  size_t fixed_size = fixed_file_size_;
+  size_t jpg_size = 0;
+  for (const DeferredOutput& output : deferred_outputs_) {
+    (output.is_jpg ? jpg_size : fixed_size) += output.data.size();
+  }
+  if (fixed_size + jpg_size <= limit) {
+    return;
+  }
+
+  // Binary search for the highest JPG quality that fits the limit, encoding
+  // all JPGs in parallel for each candidate quality.
+  const int quality_max = settings.jpg_quality;
+  const int quality_min =
+      std::min(settings.jpg_quality_min, settings.jpg_quality);
+  std::vector<EncodeTask> best_tasks;
+  jpg_size = EncodeJpgOutputs(quality_min, scheduler, &best_tasks);
+  int quality = quality_min;
+  if (fixed_size + jpg_size <= limit) {
+    // Invariant: quality_lo fits, quality_hi does not.
+    int quality_lo = quality_min;
+    int quality_hi = quality_max;
+    std::vector<EncodeTask> tasks;
+    while (quality_hi - quality_lo > 1) {
+      const int quality_mid = (quality_lo + quality_hi) / 2;
+      const size_t size = EncodeJpgOutputs(quality_mid, scheduler, &tasks);
+      if (fixed_size + size <= limit) {
+        quality_lo = quality_mid;
+        jpg_size = size;
+        best_tasks.swap(tasks);
+      } else {
+        quality_hi = quality_mid;
+      }
+    }
+    quality = quality_lo;
+  }
+  for (EncodeTask& task : best_tasks) {
+    task.output->data.swap(task.data);
+  }
+
+  const size_t total = fixed_size + jpg_size;
+  if (total > limit) {
+    Log<UFG_WARN_IMAGE_FILE_LIMIT>(limit, total);
+  } else {
+    Log<UFG_INFO_IMAGE_FILE_LIMIT>(quality, limit, total);
+  }
+}
+
+void Texturator::WriteDeferredOutputs() {
+  Scheduler scheduler;
+  scheduler.Start(Scheduler::GetDefaultWorkerCount());
+  if (cc_->settings.pick_smaller_image_format) {
+    ChooseSmallerFormats(&scheduler);
+  }
+  if (cc_->settings.limit_total_image_file_size != 0) {
+    LimitJpgQuality(&scheduler);
+  } else {
+    EncodeRemainingOutputs(&scheduler);
+  }
+  scheduler.Stop();
+  CheckCancel(cc_->settings.cancel_token);
+
+  for (DeferredOutput& output : deferred_outputs_) {
+    if (output.data.empty()) {
+      // Encoding failed. The error is already logged.
+      continue;
+    }
+    writer_.Write(output.dst_path, &output.data);
+  }
+  deferred_outputs_.clear();
+}
+
+void Texturator::FlushWrites() {
+  for (const std::string& path : writer_.Flush()) {
+    Log<UFG_ERROR_IO_WRITE_IMAGE>(path.c_str());
+  }
+}
+
+void Texturator::ProcessAdd(const Op& op) {
+  // Copy the original file to the destination if it doesn't require any
+  // processing.
+  if (op.direct_copy) {
+    UFG_ASSERT(op.pass_mask == 0);
+    ++cc_->stats.images_copied;
+    if (op.need_copy) {
+      cc_->gltf_cache->CopyImage(op.image_id, op.dst_path);
+    }
+    if (IsDeferringOutputs()) {
+      size_t size;
+      Gltf::Image::MimeType mime_type;
+      if (cc_->gltf_cache->GetImageData(op.image_id, &size, &mime_type)) {
+        fixed_file_size_ += size;
+      }
+    }
+    return;
+  }
+
+  uint32_t pass_mask = op.pass_mask;
+  const Args& args = op.args;
+
+  // If all relevant source channels are solid, the result is also solid, so
+  // just process a single pixel rather than the whole image.
+  const Image* src_image = op.src->image.get();
+  Image solid_src_image;
+  if (CanProcessAsSolid(*src_image, op.src->rgba_contents,
+                        op.src->solid_color, args.usage, pass_mask)) {
+    solid_src_image.Create1x1(op.src->solid_color,
+                              src_image->GetChannelCount());
+    src_image = &solid_src_image;
+    pass_mask &= ~kPassFlagResize;
+  }
+
+  std::unique_ptr<Image> image = ProcessImage(
+      *src_image, args, pass_mask, op.resize_width, op.resize_height);
+  if (IsReducedToSolid(*op.src->image, *image)) {
+    ++cc_->stats.images_solid;
+  }
+
+  const bool is_norm = args.usage == kUsageNorm;
+  WriteImage(op, std::move(image), is_norm);
 }
 
 void Texturator::ProcessAddSpecToMetal(const Op& spec_op, const Op& diff_op) {
@@ -970,49 +1574,87 @@ void Texturator::ProcessAddSpecToMetal(const Op& spec_op, const Op& diff_op) {
   const Args& diff_args = diff_op.args;
   const bool diff_is_constant = diff_op.is_constant;
 
+  uint32_t spec_pass_mask = spec_op.pass_mask;
+  uint32_t diff_pass_mask = diff_op.pass_mask;
+  const Image* spec_src_image =
+      spec_is_constant ? nullptr : spec_op.src->image.get();
+  const Image* diff_src_image =
+      diff_is_constant ? nullptr : diff_op.src->image.get();
+
+  // If both sources are solid (or constant), the results are also solid, so
+  // just process a single pixel rather than whole images.
+  const bool spec_is_solid =
+      spec_is_constant ||
+      CanProcessAsSolid(*spec_src_image, spec_op.src->rgba_contents,
+                        spec_op.src->solid_color, spec_args.usage,
+                        spec_pass_mask);
+  const bool diff_is_solid =
+      diff_is_constant ||
+      CanProcessAsSolid(*diff_src_image, diff_op.src->rgba_contents,
+                        diff_op.src->solid_color, diff_args.usage,
+                        diff_pass_mask);
+  Image solid_spec_src_image;
+  Image solid_diff_src_image;
+  if (spec_is_solid && diff_is_solid) {
+    if (spec_src_image) {
+      solid_spec_src_image.Create1x1(spec_op.src->solid_color,
+                                     spec_src_image->GetChannelCount());
+      spec_src_image = &solid_spec_src_image;
+    }
+    if (diff_src_image) {
+      solid_diff_src_image.Create1x1(diff_op.src->solid_color,
+                                     diff_src_image->GetChannelCount());
+      diff_src_image = &solid_diff_src_image;
+    }
+    spec_pass_mask &= ~kPassFlagResize;
+    diff_pass_mask &= ~kPassFlagResize;
+  }
+
   // Get specular color in transformed linear space.
-  const uint32_t spec_pass_mask = spec_op.pass_mask;
   std::unique_ptr<Image> spec_image =
-      spec_is_constant ? WhiteImageByUsage(*diff_op.src->image, spec_args.usage)
-                       : CopyImageByUsage(*spec_op.src->image, spec_args.usage,
+      spec_is_constant ? WhiteImageByUsage(*diff_src_image, spec_args.usage)
+                       : CopyImageByUsage(*spec_src_image, spec_args.usage,
                                           spec_pass_mask);
   UFG_ASSERT_LOGIC(spec_image->GetChannelCount() == 3);
-  FloatImage spec_float_image(*spec_image, kColorSpaceSrgb);
+  FloatImage spec_float_image(*spec_image, kColorSpaceSrgb,
+                              cc_->settings.memory_tracker);
   ApplyFloatPasses(spec_args, spec_pass_mask, spec_op.resize_width,
                    spec_op.resize_height, &spec_float_image);
 
   // Get diffuse color in transformed linear space.
-  const uint32_t diff_pass_mask = diff_op.pass_mask;
   std::unique_ptr<Image> diff_image =
-      diff_is_constant ? WhiteImageByUsage(*spec_op.src->image, diff_args.usage)
-                       : CopyImageByUsage(*diff_op.src->image, diff_args.usage,
+      diff_is_constant ? WhiteImageByUsage(*spec_src_image, diff_args.usage)
+                       : CopyImageByUsage(*diff_src_image, diff_args.usage,
                                           diff_pass_mask);
-  FloatImage diff_float_image(*diff_image, kColorSpaceSrgb);
+  FloatImage diff_float_image(*diff_image, kColorSpaceSrgb,
+                              cc_->settings.memory_tracker);
   ApplyFloatPasses(diff_args, diff_pass_mask, diff_op.resize_width,
                    diff_op.resize_height, &diff_float_image);
 
   // Convert specular+diffuse --> metallic+base.
-  FloatImage metal_float_image;
+  FloatImage metal_float_image(cc_->settings.memory_tracker);
   FloatImage::ConvertSpecDiffToMetalBase(
       spec_float_image, &diff_float_image, &metal_float_image);
 
   // Write metallic texture.
+  bool is_reduced_to_solid = spec_op.is_new || diff_op.is_new;
   if (spec_op.is_new) {
     UFG_ASSERT_LOGIC(!spec_op.direct_copy);
-    Image metal_image;
+    std::unique_ptr<Image> metal_image(new Image());
     // According to the spec, the metallic channel is stored as linear. However,
     // the SpecGlossVsMetalRough reference sample has metallic values in sRGB,
     // so the two models do not look quite alike. I'm assuming this is just an
     // error in the sample, so I'm sticking to the spec.
-    metal_float_image.CopyTo(kColorSpaceLinear, &metal_image);
+    metal_float_image.CopyTo(kColorSpaceLinear, &*metal_image);
     Image::Component metal_dst_solid_color[kColorChannelCount];
-    if (metal_image.AreChannelsSolid(cc_->settings.fix_accidental_alpha,
-                                     metal_dst_solid_color)) {
-      metal_image.Create1x1(metal_dst_solid_color, 1);
+    if (metal_image->AreChannelsSolid(cc_->settings.fix_accidental_alpha,
+                                      metal_dst_solid_color)) {
+      metal_image->Create1x1(metal_dst_solid_color, 1);
     }
-    if (!metal_image.Write(
-            spec_op.dst_path.c_str(), cc_->settings, cc_->logger)) {
-      Log<UFG_ERROR_IO_WRITE_IMAGE>(spec_op.dst_path.c_str());
+    is_reduced_to_solid = IsReducedToSolid(
+        spec_is_constant ? *diff_op.src->image : *spec_op.src->image,
+        *metal_image);
+    if (!WriteImage(spec_op, std::move(metal_image), false)) {
       return;
     }
   }
@@ -1020,23 +1662,32 @@ void Texturator::ProcessAddSpecToMetal(const Op& spec_op, const Op& diff_op) {
   // Write base texture.
   if (diff_op.is_new) {
     UFG_ASSERT_LOGIC(!diff_op.direct_copy);
-    Image base_image;
-    diff_float_image.CopyTo(kColorSpaceSrgb, &base_image);
+    std::unique_ptr<Image> base_image(new Image());
+    diff_float_image.CopyTo(kColorSpaceSrgb, &*base_image);
     if (diff_pass_mask & kPassFlagAlphaCutoff) {
-      base_image.ApplyAlphaCutoff(
+      base_image->ApplyAlphaCutoff(
           Image::FloatToComponent(diff_args.alpha_cutoff));
     }
     Image::Component base_dst_solid_color[kColorChannelCount];
-    if (base_image.AreChannelsSolid(cc_->settings.fix_accidental_alpha,
-                                    base_dst_solid_color)) {
-      base_image.Create1x1(base_dst_solid_color, diff_image->GetChannelCount());
+    if (base_image->AreChannelsSolid(cc_->settings.fix_accidental_alpha,
+                                     base_dst_solid_color)) {
+      base_image->Create1x1(base_dst_solid_color,
+                            diff_image->GetChannelCount());
     }
-    if (!base_image.Write(
-            diff_op.dst_path.c_str(), cc_->settings, cc_->logger)) {
-      Log<UFG_ERROR_IO_WRITE_IMAGE>(diff_op.dst_path.c_str());
+    is_reduced_to_solid =
+        is_reduced_to_solid &&
+        IsReducedToSolid(
+            diff_is_constant ? *spec_op.src->image : *diff_op.src->image,
+            *base_image);
+    if (!WriteImage(diff_op, std::move(base_image), false)) {
       return;
     }
   }
+
+  // Both outputs come from the same job, so count them once.
+  if (is_reduced_to_solid) {
+    ++cc_->stats.images_solid;
+  }
 }
 
 void Texturator::ProcessJob(const Job& job) {
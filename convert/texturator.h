@@ -21,7 +21,10 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 #include "common/common_util.h"
+#include "common/output_writer.h"
+#include "common/scheduler.h"
 #include "convert/convert_context.h"
 #include "gltf/gltf.h"
 #include "process/color.h"
@@ -81,11 +84,31 @@ class Texturator {
   //   cannot be loaded.
   int GetSolidAlpha(Gltf::Id image_id);
 
+  // Accumulate UV-space area referencing an image, used to weight the image
+  // size budget with limit_total_image_weighted.
+  void AddImageCoverage(Gltf::Id image_id, float uv_area);
+
+  // Determine if the texture generated for an image is a solid color, and if
+  // so get its linear value as it would be sampled from the texture.
+  // * This does not add the texture, so the caller can use the value in place
+  //   of a texture reference.
+  bool GetSolidValue(Gltf::Id image_id, const Args& args, ColorF* out_value);
+
   // Return true if textured alpha is effectively opaque.
   bool IsAlphaOpaque(Gltf::Id image_id, float scale, float bias);
   // Return true if textured alpha is fully transparent (solid 0).
   bool IsAlphaFullyTransparent(Gltf::Id image_id, float scale, float bias);
 
+  // Get images renamed due to format changes by pick_smaller_image_format,
+  // mapping the name returned by Add() to the name written.
+  // * This is only valid after End().
+  const std::map<std::string, std::string>& GetRenamed() const {
+    return renamed_;
+  }
+
+  // Get the total number of bytes saved by pick_smaller_image_format.
+  size_t GetFormatSavedSize() const { return format_saved_size_; }
+
   const std::vector<std::string>& GetWritten() const { return written_; }
   const std::vector<std::string>& GetCreatedDirectories() const {
     return created_dirs_;
@@ -111,7 +134,27 @@ class Texturator {
     Image::Component solid_color[kColorChannelCount] =
         {0, 0, 0, Image::kComponentMax};
     NormalContent normal_content = kNormalUnknown;
+    std::shared_ptr<const Image> image;
+  };
+
+  // Processed image whose encoding is deferred until all images are processed,
+  // so the format and JPG quality can be chosen based on encoded sizes.
+  struct DeferredOutput {
+    std::string dst_name;
+    std::string dst_path;
+    bool is_jpg = false;
+    bool is_norm = false;
     std::unique_ptr<Image> image;
+    std::vector<uint8_t> data;
+  };
+
+  // Encoding of a deferred output, run on a worker thread.
+  struct EncodeTask {
+    DeferredOutput* output = nullptr;
+    bool is_jpg = false;
+    int jpg_quality = 0;
+    std::vector<uint8_t> data;
+    SequencedLogger::Task logger;
   };
 
   using ColorId = int;
@@ -132,6 +175,7 @@ class Texturator {
     uint32_t pass_mask = 0;
     uint32_t resize_width = 0;
     uint32_t resize_height = 0;
+    std::string dst_name;
     std::string dst_path;
 
     Op() {}
@@ -157,6 +201,16 @@ class Texturator {
   std::vector<Job> jobs_;
   std::vector<std::string> written_;
   std::vector<std::string> created_dirs_;
+  std::vector<DeferredOutput> deferred_outputs_;
+  // Size of output images whose encoding doesn't depend on JPG quality (direct
+  // copies and fallbacks), counted towards limit_total_image_file_size.
+  size_t fixed_file_size_ = 0;
+  std::map<std::string, std::string> renamed_;
+  size_t format_saved_size_ = 0;
+  std::map<Gltf::Id, float> image_coverages_;
+  // Images already counted as solid by GetSolidValue.
+  std::set<Gltf::Id> solid_counted_;
+  OutputWriter writer_;
 
   // Convert a color to a unique identifier from its quantized value, used to
   // uniquely name a transformed texture (without having to encode 4x floats
@@ -180,7 +234,26 @@ class Texturator {
                      Src* src, uint32_t* out_width, uint32_t* out_height) const;
   size_t EstimateDecompressedJobSize(const Job& job, float global_scale) const;
   float ChooseGlobalScale() const;
+  float GetJobBudgetWeight(const Job& job) const;
+  void ChooseJobScales(std::vector<float>* out_scales) const;
   bool PrepareWrite(const std::string& dst_path);
+  std::unique_ptr<Image> ProcessImage(const Image& src_image,
+                                      const Args& args, uint32_t pass_mask,
+                                      uint32_t resize_width,
+                                      uint32_t resize_height) const;
+  bool IsDeferringOutputs() const;
+  bool WriteImage(const Op& op, std::unique_ptr<Image> image, bool is_norm);
+  size_t RunEncodeTasks(std::vector<EncodeTask>* tasks,
+                        Scheduler* scheduler) const;
+  int GetJpgQuality(const DeferredOutput& output, int jpg_quality) const;
+  bool RenameOutput(bool is_jpg, DeferredOutput* output);
+  void ChooseSmallerFormats(Scheduler* scheduler);
+  void EncodeRemainingOutputs(Scheduler* scheduler);
+  size_t EncodeJpgOutputs(int jpg_quality, Scheduler* scheduler,
+                          std::vector<EncodeTask>* out_tasks);
+  void LimitJpgQuality(Scheduler* scheduler);
+  void WriteDeferredOutputs();
+  void FlushWrites();
   void ProcessAdd(const Op& op);
   void ProcessAddSpecToMetal(const Op& spec_op, const Op& diff_op);
   void ProcessJob(const Job& job);
@@ -216,11 +216,20 @@ void ReformatVectors(Gltf::Accessor::ComponentType component_type,
 }  // namespace
 
 void GltfCache::Reset(const Gltf* gltf, GltfStream* stream) {
+  for (size_t i = 0; i != MemoryObserver::kTypeCount; ++i) {
+    if (memory_observer_ && bytes_held_[i] != 0) {
+      memory_observer_->OnMemoryChange(
+          static_cast<MemoryObserver::Type>(i),
+          -static_cast<ptrdiff_t>(bytes_held_[i]));
+    }
+    bytes_held_[i] = 0;
+  }
   gltf_ = gltf;
   stream_ = stream;
   buffer_entries_.clear();
   image_entries_.clear();
   accessor_entries_.clear();
+  bytes_read_ = 0;
   if (gltf) {
     buffer_entries_.resize(gltf->buffers.size());
     image_entries_.resize(gltf->images.size());
@@ -228,6 +237,25 @@ void GltfCache::Reset(const Gltf* gltf, GltfStream* stream) {
   }
 }
 
+void GltfCache::SetMemoryObserver(MemoryObserver* observer) {
+  if (observer == memory_observer_) {
+    return;
+  }
+  for (size_t i = 0; i != MemoryObserver::kTypeCount; ++i) {
+    const MemoryObserver::Type type = static_cast<MemoryObserver::Type>(i);
+    const ptrdiff_t bytes = static_cast<ptrdiff_t>(bytes_held_[i]);
+    if (bytes != 0) {
+      if (memory_observer_) {
+        memory_observer_->OnMemoryChange(type, -bytes);
+      }
+      if (observer) {
+        observer->OnMemoryChange(type, bytes);
+      }
+    }
+  }
+  memory_observer_ = observer;
+}
+
 const uint8_t* GltfCache::GetBufferData(Gltf::Id buffer_id, size_t* out_size) {
   const Gltf::Buffer* const buffer = Gltf::GetById(gltf_->buffers, buffer_id);
   if (!buffer) {
@@ -238,6 +266,8 @@ const uint8_t* GltfCache::GetBufferData(Gltf::Id buffer_id, size_t* out_size) {
   if (!entry.loaded) {
     stream_->ReadBuffer(*gltf_, buffer_id, 0, 0, &entry.data);
     entry.loaded = true;
+    bytes_read_ += entry.data.size();
+    AddBytesHeld(MemoryObserver::kTypeFile, entry.data.size());
   }
   *out_size = entry.data.size();
   return entry.data.empty() ? nullptr : entry.data.data();
@@ -259,6 +289,23 @@ const uint8_t* GltfCache::GetViewData(Gltf::Id view_id, size_t* out_size) {
   return buffer_data + view->byteOffset;
 }
 
+void GltfCache::SetImageData(Gltf::Id image_id, std::vector<uint8_t>* data,
+                             Gltf::Image::MimeType mime_type) {
+  const Gltf::Image* const image = Gltf::GetById(gltf_->images, image_id);
+  if (!image || image->bufferView != Gltf::Id::kNull) {
+    return;
+  }
+  ImageEntry& entry = image_entries_[Gltf::IdToIndex(image_id)];
+  if (entry.loaded) {
+    return;
+  }
+  entry.data.swap(*data);
+  entry.mime_type = mime_type;
+  entry.loaded = true;
+  bytes_read_ += entry.data.size();
+  AddBytesHeld(MemoryObserver::kTypeFile, entry.data.size());
+}
+
 const uint8_t* GltfCache::GetImageData(Gltf::Id image_id, size_t* out_size,
                                        Gltf::Image::MimeType* out_mime_type) {
   *out_size = 0;
@@ -274,6 +321,8 @@ const uint8_t* GltfCache::GetImageData(Gltf::Id image_id, size_t* out_size,
     if (!entry.loaded) {
       stream_->ReadImage(*gltf_, image_id, &entry.data, &entry.mime_type);
       entry.loaded = true;
+      bytes_read_ += entry.data.size();
+      AddBytesHeld(MemoryObserver::kTypeFile, entry.data.size());
     }
     *out_size = entry.data.size();
     *out_mime_type = entry.mime_type;
@@ -341,25 +390,23 @@ const Dst* GltfCache::Access(
 
   Content& content = accessor_entry->contents[kDstComponentType];
   if (content.state == Content::kStateUncached) {
-    const size_t sparse_count = accessor.sparse.count;
-    const bool is_sparse = sparse_count != 0;
+    SparseEntry* const sparse_entry =
+        GetSparseEntry(accessor, accessor_entry);
+    const bool is_sparse = sparse_entry != nullptr;
     GetViewContent<Dst>(accessor.bufferView, accessor.byteOffset,
                         component_type, vec_count, component_count,
                         accessor.normalized, is_sparse, &content);
 
     // Apply deltas for sparse buffers.
     if (is_sparse) {
-      Content indices_content;
-      const uint32_t* const indices = GetViewContent<uint32_t>(
-          accessor.sparse.indices.bufferView,
-          accessor.sparse.indices.byteOffset,
-          accessor.sparse.indices.componentType, sparse_count, 1, false, false,
-          &indices_content);
-      Content deltas_content;
-      const Dst* const deltas = GetViewContent<Dst>(
-          accessor.sparse.values.bufferView, accessor.sparse.values.byteOffset,
-          component_type, sparse_count, component_count, accessor.normalized,
-          false, &deltas_content);
+      const Gltf::Accessor::Sparse& sparse = accessor.sparse;
+      const size_t sparse_count = sparse.count;
+      const uint32_t* const indices =
+          GetContentAs<uint32_t>(sparse_entry->indices);
+      const Dst* const deltas = GetCachedViewContent<Dst>(
+          sparse.values.bufferView, sparse.values.byteOffset, component_type,
+          sparse_count, component_count, accessor.normalized,
+          &sparse_entry->values[kDstComponentType]);
       if (indices && deltas) {
         if (content.state == Content::kStateNull) {
           // Default zero-fill the buffer.
@@ -372,11 +419,18 @@ const Dst* GltfCache::Access(
         const Dst* delta = deltas;
         for (size_t i = 0; i != sparse_count; ++i, delta += component_count) {
           const size_t vec_index = indices[i];
+          if (vec_index >= vec_count) {
+            // Error already reported during glTF validation.
+            continue;
+          }
           Dst* const vec = dst + vec_index * component_count;
           std::copy(delta, delta + component_count, vec);
         }
       }
     }
+    if (content.state == Content::kStateReformatted) {
+      AddBytesHeld(MemoryObserver::kTypeContent, content.reformatted.size());
+    }
   }
 
   return GetContentAs<Dst>(content);
@@ -399,6 +453,92 @@ template const uint32_t* GltfCache::Access(
 template const    float* GltfCache::Access(
     Gltf::Id accessor_id, size_t* out_count, size_t* out_component_count);
 
+template <typename Dst>
+bool GltfCache::AccessSparse(Gltf::Id accessor_id, SparseView<Dst>* out_view) {
+  constexpr Gltf::Accessor::ComponentType kDstComponentType =
+      AccessorTypeInfo<Dst>::kComponentType;
+  *out_view = SparseView<Dst>();
+  AccessorEntry* const accessor_entry =
+      Gltf::GetById(accessor_entries_, accessor_id);
+  if (!accessor_entry) {
+    return false;
+  }
+  const Gltf::Accessor& accessor =
+      *Gltf::GetById(gltf_->accessors, accessor_id);
+  SparseEntry* const sparse_entry = GetSparseEntry(accessor, accessor_entry);
+  const size_t component_count = Gltf::GetComponentCount(accessor.type);
+  if (!sparse_entry || !sparse_entry->indices_ordered ||
+      component_count > SparseView<Dst>::kComponentMax) {
+    // Dense accessor, or one we can't overlay in order.
+    out_view->base = Access<Dst>(accessor_id, &out_view->vec_count,
+                                 &out_view->component_count);
+    return out_view->base != nullptr;
+  }
+
+  // Reference the base and substitutions separately, so only the
+  // substitutions (and a base needing reformatting) are held in memory.
+  const Gltf::Accessor::Sparse& sparse = accessor.sparse;
+  out_view->vec_count = accessor.count;
+  out_view->component_count = component_count;
+  out_view->base = GetCachedViewContent<Dst>(
+      accessor.bufferView, accessor.byteOffset, accessor.componentType,
+      accessor.count, component_count, accessor.normalized,
+      &sparse_entry->bases[kDstComponentType]);
+  const Dst* const values = GetCachedViewContent<Dst>(
+      sparse.values.bufferView, sparse.values.byteOffset,
+      accessor.componentType, sparse.count, component_count,
+      accessor.normalized, &sparse_entry->values[kDstComponentType]);
+  if (values) {
+    out_view->sparse_count = sparse.count;
+    out_view->sparse_indices = GetContentAs<uint32_t>(sparse_entry->indices);
+    out_view->sparse_values = values;
+  }
+  return out_view->base || out_view->sparse_count != 0;
+}
+
+template bool GltfCache::AccessSparse(
+    Gltf::Id accessor_id, SparseView<int8_t>* out_view);
+template bool GltfCache::AccessSparse(
+    Gltf::Id accessor_id, SparseView<uint8_t>* out_view);
+template bool GltfCache::AccessSparse(
+    Gltf::Id accessor_id, SparseView<int16_t>* out_view);
+template bool GltfCache::AccessSparse(
+    Gltf::Id accessor_id, SparseView<uint16_t>* out_view);
+template bool GltfCache::AccessSparse(
+    Gltf::Id accessor_id, SparseView<int32_t>* out_view);
+template bool GltfCache::AccessSparse(
+    Gltf::Id accessor_id, SparseView<uint32_t>* out_view);
+template bool GltfCache::AccessSparse(
+    Gltf::Id accessor_id, SparseView<float>* out_view);
+
+GltfCache::SparseEntry* GltfCache::GetSparseEntry(
+    const Gltf::Accessor& accessor, AccessorEntry* accessor_entry) {
+  if (accessor_entry->sparse) {
+    return accessor_entry->sparse.get();
+  }
+  const Gltf::Accessor::Sparse& sparse = accessor.sparse;
+  if (sparse.count == 0) {
+    return nullptr;
+  }
+  accessor_entry->sparse.reset(new SparseEntry());
+  SparseEntry& entry = *accessor_entry->sparse;
+  const uint32_t* const indices = GetCachedViewContent<uint32_t>(
+      sparse.indices.bufferView, sparse.indices.byteOffset,
+      sparse.indices.componentType, sparse.count, 1, false, &entry.indices);
+
+  // Sparse views are merged in a single pass, which requires in-range indices
+  // in strictly increasing order (as the spec requires).
+  if (indices) {
+    const size_t count = sparse.count;
+    bool ordered = indices[count - 1] < accessor.count;
+    for (size_t i = 1; i != count && ordered; ++i) {
+      ordered = indices[i - 1] < indices[i];
+    }
+    entry.indices_ordered = ordered;
+  }
+  return accessor_entry->sparse.get();
+}
+
 template <typename Dst>
 const Dst* GltfCache::GetViewContent(
     Gltf::Id view_id, size_t offset,
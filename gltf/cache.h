@@ -17,6 +17,9 @@
 #ifndef GLTF_CACHE_H_
 #define GLTF_CACHE_H_
 
+#include <stddef.h>
+#include <algorithm>
+#include <memory>
 #include <string>
 #include <vector>
 #include "gltf.h"  // NOLINT: Silence relative path warning.
@@ -26,13 +29,35 @@
 // Utility to load and cache bin and image files.
 class GltfCache {
  public:
+  // Notified as the cache allocates and frees data, for memory accounting.
+  class MemoryObserver {
+   public:
+    enum Type : uint8_t {
+      kTypeFile,     // Buffer and image files.
+      kTypeContent,  // Accessor data reformatted to a requested type.
+      kTypeCount
+    };
+    virtual ~MemoryObserver() {}
+    virtual void OnMemoryChange(Type type, ptrdiff_t delta) = 0;
+  };
+
   explicit GltfCache(const Gltf* gltf = nullptr, GltfStream* stream = nullptr)
       : gltf_(nullptr), stream_(nullptr) {
     Reset(gltf, stream);
   }
+  ~GltfCache() { Reset(); }
 
   void Reset(const Gltf* gltf = nullptr, GltfStream* stream = nullptr);
 
+  // Set the memory observer, which isn't owned and must outlive the cache.
+  // * Bytes already held are moved from the old observer to the new one.
+  void SetMemoryObserver(MemoryObserver* observer);
+
+  // Get the bytes currently held for a type of data.
+  size_t GetBytesHeld(MemoryObserver::Type type) const {
+    return bytes_held_[type];
+  }
+
   const uint8_t* GetBufferData(Gltf::Id buffer_id, size_t* out_size);
   const uint8_t* GetBufferData(Gltf::Id buffer_id) {
     size_t size;
@@ -58,13 +83,67 @@ class GltfCache {
 
   bool CopyImage(Gltf::Id image_id, const std::string& dst_path);
 
+  // Store data for a URI-based image that was read directly through the
+  // stream (e.g. on another thread), so it isn't read again. The data is
+  // swapped out of *data. This has no effect if the image is already loaded.
+  void SetImageData(Gltf::Id image_id, std::vector<uint8_t>* data,
+                    Gltf::Image::MimeType mime_type);
+
+  GltfStream* GetStream() const { return stream_; }
+
+  // Total size of buffer and image files read through the cache.
+  size_t GetBytesRead() const { return bytes_read_; }
+
+  // Accessor data as a base array overlaid with sparse substitutions, so it can
+  // be read without materializing a modified copy of the whole accessor.
+  template <typename Dst>
+  struct SparseView {
+    static constexpr size_t kComponentMax = 16;
+    size_t vec_count = 0;
+    size_t component_count = 0;
+    const Dst* base = nullptr;  // Null if base values are implicitly zero.
+    size_t sparse_count = 0;
+    const uint32_t* sparse_indices = nullptr;  // Strictly increasing.
+    const Dst* sparse_values = nullptr;
+
+    // Call fn(vec_index, components) for each vector in order.
+    template <typename Fn>
+    void ForEach(Fn fn) const {
+      Dst zero[kComponentMax] = {};
+      const Dst* const sparse_end =
+          sparse_values + sparse_count * component_count;
+      const Dst* sparse_it = sparse_values;
+      const uint32_t* index_it = sparse_indices;
+      for (size_t vi = 0; vi != vec_count; ++vi) {
+        const Dst* vec = base ? base + vi * component_count : zero;
+        if (sparse_it != sparse_end && *index_it == vi) {
+          vec = sparse_it;
+          sparse_it += component_count;
+          ++index_it;
+        }
+        fn(vi, vec);
+      }
+    }
+  };
+
   // Get accessor data as an array, reformatting if necessary.
   // * This returns an array of scalars with length
   //   out_vec_count*out_component_count.
+  // * Sparse accessors are materialized into a cached copy. Prefer
+  //   AccessSparse to read large sparse accessors.
   template <typename Dst>
   const Dst* Access(Gltf::Id accessor_id,
                     size_t* out_vec_count, size_t* out_component_count);
 
+  // Get accessor data as a sparse view, reformatting the base and substitutions
+  // if necessary. Memory held scales with the substitution count, unless the
+  // base needs reformatting.
+  // * Sparse indices that aren't strictly increasing fall back to a dense view
+  //   of the materialized accessor.
+  // * Returns false if the accessor data is unavailable.
+  template <typename Dst>
+  bool AccessSparse(Gltf::Id accessor_id, SparseView<Dst>* out_view);
+
  private:
   struct BufferEntry {
     bool loaded = false;
@@ -90,8 +169,17 @@ class GltfCache {
     std::vector<uint8_t> reformatted;
   };
 
+  // Cached parts of a sparse accessor, allocated on first access.
+  struct SparseEntry {
+    bool indices_ordered = false;
+    Content indices;
+    Content bases[Gltf::Accessor::kComponentCount];
+    Content values[Gltf::Accessor::kComponentCount];
+  };
+
   struct AccessorEntry {
     Content contents[Gltf::Accessor::kComponentCount];
+    std::unique_ptr<SparseEntry> sparse;
   };
 
   const Gltf* gltf_;
@@ -99,6 +187,16 @@ class GltfCache {
   std::vector<BufferEntry> buffer_entries_;
   std::vector<ImageEntry> image_entries_;
   std::vector<AccessorEntry> accessor_entries_;
+  size_t bytes_read_ = 0;
+  size_t bytes_held_[MemoryObserver::kTypeCount] = {};
+  MemoryObserver* memory_observer_ = nullptr;
+
+  void AddBytesHeld(MemoryObserver::Type type, size_t bytes) {
+    bytes_held_[type] += bytes;
+    if (memory_observer_ && bytes != 0) {
+      memory_observer_->OnMemoryChange(type, static_cast<ptrdiff_t>(bytes));
+    }
+  }
 
   template <typename Dst>
   const Dst* GetContentAs(const Content& content) {
@@ -117,6 +215,26 @@ class GltfCache {
     return static_cast<const Dst*>(data);
   }
 
+  // Get cached content, loading it on first access.
+  template <typename Dst>
+  const Dst* GetCachedViewContent(
+      Gltf::Id view_id, size_t offset,
+      Gltf::Accessor::ComponentType component_type,
+      size_t vec_count, size_t component_count,
+      bool normalized, Content* content) {
+    if (content->state == Content::kStateUncached) {
+      GetViewContent<Dst>(view_id, offset, component_type, vec_count,
+                          component_count, normalized, false, content);
+      if (content->state == Content::kStateReformatted) {
+        AddBytesHeld(MemoryObserver::kTypeContent, content->reformatted.size());
+      }
+    }
+    return GetContentAs<Dst>(*content);
+  }
+
+  SparseEntry* GetSparseEntry(const Gltf::Accessor& accessor,
+                              AccessorEntry* accessor_entry);
+
   template <typename Dst>
   const Dst* GetViewContent(
       Gltf::Id view_id, size_t offset,
@@ -0,0 +1,402 @@
+/*
+ * Copyright 2019 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "disk_batch_reader.h"  // NOLINT: Silence relative path warning.
+
+#include <algorithm>
+#include "disk_util.h"  // NOLINT: Silence relative path warning.
+#include "internal_util.h"  // NOLINT: Silence relative path warning.
+
+// io_uring opcodes for open and read were added in Linux 5.6.
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/version.h>
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 6, 0)
+#define GLTF_HAVE_IO_URING 1
+#endif  // LINUX_VERSION_CODE >= KERNEL_VERSION(5, 6, 0)
+#endif  // __has_include(<linux/io_uring.h>)
+#endif  // defined(__linux__) && defined(__has_include)
+
+#if GLTF_HAVE_IO_URING
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // GLTF_HAVE_IO_URING
+
+namespace {
+bool ReadFileBlocking(GltfDiskFileRead* read) {
+  GltfDiskFileSentry file(read->path.c_str(), "rb");
+  if (!file.fp) {
+    return false;
+  }
+  const size_t size = GetFileSize(file.fp);
+  std::vector<uint8_t> data(size);
+  if (fread(data.data(), 1, size, file.fp) != size) {
+    return false;
+  }
+  read->data.swap(data);
+  return true;
+}
+
+#if GLTF_HAVE_IO_URING
+// Maximum number of operations in flight.
+constexpr unsigned kQueueDepth = 64;
+
+// Maximum size of a single read operation.
+constexpr size_t kReadSizeMax = 1 << 30;
+
+// Minimal io_uring wrapper using raw syscalls, to avoid a dependency on
+// liburing.
+class IoRing {
+ public:
+  IoRing() {}
+  ~IoRing() { Close(); }
+  bool Init(unsigned entries);
+
+  // Unmap and close the ring, cancelling any outstanding operations.
+  void Close();
+
+  // Get a cleared submission queue entry, or null if the queue is full.
+  io_uring_sqe* GetSqe();
+
+  // Submit queued entries, and wait for at least wait_count completions.
+  bool Submit(unsigned wait_count);
+
+  // Wait for at least wait_count completions without submitting.
+  bool Wait(unsigned wait_count);
+
+  // Number of submitted entries the kernel has consumed (started).
+  unsigned GetConsumedCount() const {
+    return __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) - sq_head_begin_;
+  }
+
+  // Pop a completion, returning false if none are available.
+  bool PopCqe(uint64_t* out_user_data, int* out_res);
+
+ private:
+  int fd_ = -1;
+  void* sq_ring_ = MAP_FAILED;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ = MAP_FAILED;
+  size_t cq_ring_size_ = 0;
+  io_uring_sqe* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+  unsigned* sq_head_ = nullptr;
+  unsigned* sq_tail_ = nullptr;
+  unsigned* sq_array_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned sq_entries_ = 0;
+  unsigned sq_local_tail_ = 0;
+  unsigned sq_head_begin_ = 0;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  io_uring_cqe* cqes_ = nullptr;
+
+  static void* Map(int fd, size_t size, off_t offset) {
+    return mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE, fd, offset);
+  }
+  template <typename T>
+  static T* Offset(void* base, uint32_t offset) {
+    return reinterpret_cast<T*>(static_cast<uint8_t*>(base) + offset);
+  }
+};
+
+void IoRing::Close() {
+  if (sqes_) {
+    munmap(sqes_, sqes_size_);
+    sqes_ = nullptr;
+  }
+  if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  cq_ring_ = MAP_FAILED;
+  if (sq_ring_ != MAP_FAILED) {
+    munmap(sq_ring_, sq_ring_size_);
+    sq_ring_ = MAP_FAILED;
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+}
+
+bool IoRing::Init(unsigned entries) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+  if (fd_ < 0) {
+    return false;
+  }
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ =
+      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sq_ring_ = Map(fd_, sq_ring_size_, IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    return false;
+  }
+  cq_ring_ = single_mmap ? sq_ring_
+                         : Map(fd_, cq_ring_size_, IORING_OFF_CQ_RING);
+  if (cq_ring_ == MAP_FAILED) {
+    return false;
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void* const sqes = Map(fd_, sqes_size_, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    return false;
+  }
+  sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+  sq_head_ = Offset<unsigned>(sq_ring_, params.sq_off.head);
+  sq_tail_ = Offset<unsigned>(sq_ring_, params.sq_off.tail);
+  sq_array_ = Offset<unsigned>(sq_ring_, params.sq_off.array);
+  sq_mask_ = *Offset<unsigned>(sq_ring_, params.sq_off.ring_mask);
+  sq_entries_ = params.sq_entries;
+  sq_local_tail_ = *sq_tail_;
+  sq_head_begin_ = *sq_head_;
+  cq_head_ = Offset<unsigned>(cq_ring_, params.cq_off.head);
+  cq_tail_ = Offset<unsigned>(cq_ring_, params.cq_off.tail);
+  cq_mask_ = *Offset<unsigned>(cq_ring_, params.cq_off.ring_mask);
+  cqes_ = Offset<io_uring_cqe>(cq_ring_, params.cq_off.cqes);
+  return true;
+}
+
+io_uring_sqe* IoRing::GetSqe() {
+  const unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+  if (sq_local_tail_ - head >= sq_entries_) {
+    return nullptr;
+  }
+  const unsigned index = sq_local_tail_ & sq_mask_;
+  io_uring_sqe* const sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sq_array_[index] = index;
+  ++sq_local_tail_;
+  return sqe;
+}
+
+bool IoRing::Submit(unsigned wait_count) {
+  __atomic_store_n(sq_tail_, sq_local_tail_, __ATOMIC_RELEASE);
+  const unsigned to_submit =
+      sq_local_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+  const unsigned flags = wait_count ? IORING_ENTER_GETEVENTS : 0;
+  for (;;) {
+    const long result = syscall(__NR_io_uring_enter, fd_, to_submit,  // NOLINT
+                                wait_count, flags, nullptr, 0);
+    if (result >= 0) {
+      return true;
+    }
+    if (errno != EINTR) {
+      return false;
+    }
+  }
+}
+
+bool IoRing::Wait(unsigned wait_count) {
+  for (;;) {
+    const long result = syscall(__NR_io_uring_enter, fd_, 0,  // NOLINT
+                                wait_count, IORING_ENTER_GETEVENTS, nullptr, 0);
+    if (result >= 0) {
+      return true;
+    }
+    if (errno != EINTR) {
+      return false;
+    }
+  }
+}
+
+bool IoRing::PopCqe(uint64_t* out_user_data, int* out_res) {
+  const unsigned head = *cq_head_;
+  if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+    return false;
+  }
+  const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+  *out_user_data = cqe.user_data;
+  *out_res = cqe.res;
+  __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+// Read files through io_uring, setting success for each file read.
+// * Files that fail for any reason are left for the caller to retry with
+//   blocking reads.
+size_t ReadFilesIoUring(std::vector<GltfDiskFileRead>* reads) {
+  const size_t count = reads->size();
+  IoRing ring;
+  if (!ring.Init(std::min(static_cast<unsigned>(count), kQueueDepth))) {
+    return 0;
+  }
+
+  // Submit opens for all files, as many at a time as the queue allows.
+  std::vector<int> fds(count, -1);
+  size_t next = 0;
+  size_t in_flight = 0;
+  unsigned open_count = 0;
+  bool ring_ok = true;
+  while (next != count || in_flight != 0) {
+    for (; next != count; ++next) {
+      io_uring_sqe* const sqe = ring.GetSqe();
+      if (!sqe) {
+        break;
+      }
+      sqe->opcode = IORING_OP_OPENAT;
+      sqe->fd = AT_FDCWD;
+      sqe->addr = reinterpret_cast<uintptr_t>((*reads)[next].path.c_str());
+      sqe->open_flags = O_RDONLY | O_CLOEXEC;
+      sqe->user_data = next;
+      ++in_flight;
+    }
+    if (!ring.Submit(1)) {
+      ring_ok = false;
+      break;
+    }
+    uint64_t index;
+    int res;
+    while (ring.PopCqe(&index, &res)) {
+      --in_flight;
+      ++open_count;
+      fds[index] = res;
+    }
+  }
+  if (!ring_ok) {
+    // Opens the kernel already started may still complete, so collect their
+    // files to be closed below rather than leaking them with the ring.
+    for (;;) {
+      uint64_t index;
+      int res;
+      while (ring.PopCqe(&index, &res)) {
+        ++open_count;
+        fds[index] = res;
+      }
+      if (open_count == ring.GetConsumedCount() || !ring.Wait(1)) {
+        break;
+      }
+    }
+  }
+
+  // Allocate buffers, then submit reads. Each file has at most one read in
+  // flight, and short reads are resubmitted for the remainder.
+  std::vector<size_t> offsets(count, 0);
+  std::vector<size_t> pending;
+  for (size_t i = 0; i != count; ++i) {
+    struct stat info;
+    if (ring_ok && fds[i] >= 0 && fstat(fds[i], &info) == 0) {
+      (*reads)[i].data.resize(static_cast<size_t>(info.st_size));
+      pending.push_back(i);
+    }
+  }
+  size_t read_count = 0;
+  in_flight = 0;
+  while (ring_ok && (!pending.empty() || in_flight != 0)) {
+    while (!pending.empty()) {
+      const size_t i = pending.back();
+      GltfDiskFileRead& read = (*reads)[i];
+      if (offsets[i] == read.data.size()) {
+        // Empty (or completely read) file.
+        read.success = true;
+        ++read_count;
+        pending.pop_back();
+        continue;
+      }
+      io_uring_sqe* const sqe = ring.GetSqe();
+      if (!sqe) {
+        break;
+      }
+      const size_t size =
+          std::min(read.data.size() - offsets[i], kReadSizeMax);
+      sqe->opcode = IORING_OP_READ;
+      sqe->fd = fds[i];
+      sqe->addr = reinterpret_cast<uintptr_t>(read.data.data() + offsets[i]);
+      sqe->len = static_cast<uint32_t>(size);
+      sqe->off = offsets[i];
+      sqe->user_data = i;
+      ++in_flight;
+      pending.pop_back();
+    }
+    if (in_flight == 0) {
+      break;
+    }
+    if (!ring.Submit(1)) {
+      ring_ok = false;
+      break;
+    }
+    uint64_t index;
+    int res;
+    while (ring.PopCqe(&index, &res)) {
+      --in_flight;
+      GltfDiskFileRead& read = (*reads)[index];
+      if (res > 0) {
+        offsets[index] += static_cast<size_t>(res);
+        pending.push_back(index);
+      } else if (res == 0) {
+        // The file was truncated after we got its size.
+        read.data.resize(offsets[index]);
+        pending.push_back(index);
+      } else if (res == -EINTR || res == -EAGAIN) {
+        pending.push_back(index);
+      } else {
+        read.data.clear();
+      }
+    }
+  }
+
+  if (!ring_ok) {
+    // Operations may still reference buffers, so tear down the ring (which
+    // cancels them) before dropping partial results.
+    ring.Close();
+    read_count = 0;
+    for (GltfDiskFileRead& read : *reads) {
+      read.success = false;
+      read.data.clear();
+    }
+  }
+  for (const int fd : fds) {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+  return read_count;
+}
+#endif  // GLTF_HAVE_IO_URING
+}  // namespace
+
+size_t GltfDiskReadFiles(std::vector<GltfDiskFileRead>* reads) {
+  size_t uring_count = 0;
+#if GLTF_HAVE_IO_URING
+  if (!reads->empty()) {
+    uring_count = ReadFilesIoUring(reads);
+  }
+#endif  // GLTF_HAVE_IO_URING
+  if (uring_count != reads->size()) {
+    for (GltfDiskFileRead& read : *reads) {
+      if (!read.success) {
+        read.success = ReadFileBlocking(&read);
+      }
+    }
+  }
+  return uring_count;
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2019 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GLTF_DISK_BATCH_READER_H_
+#define GLTF_DISK_BATCH_READER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// A whole file to read with GltfDiskReadFiles.
+struct GltfDiskFileRead {
+  std::string path;
+  std::vector<uint8_t> data;
+  bool success = false;
+};
+
+// Read whole files in a single batch.
+// * On Linux, opens and reads for all files are submitted to io_uring together,
+//   so the kernel services them concurrently rather than paying a round-trip
+//   per syscall. This mostly helps cold caches and network filesystems.
+// * If io_uring is unavailable (e.g. an old kernel, or disabled by a sandbox),
+//   files are read one at a time with blocking reads.
+// * Returns the number of files read via io_uring.
+size_t GltfDiskReadFiles(std::vector<GltfDiskFileRead>* reads);
+
+#endif  // GLTF_DISK_BATCH_READER_H_
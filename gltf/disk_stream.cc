@@ -16,7 +16,9 @@
 
 #include "disk_stream.h"  // NOLINT: Silence relative path warning.
 
+#include <algorithm>
 #include <fstream>
+#include "disk_batch_reader.h"  // NOLINT: Silence relative path warning.
 #include "disk_util.h"  // NOLINT: Silence relative path warning.
 #include "image_parsing.h"  // NOLINT: Silence relative path warning.
 #include "internal_util.h"  // NOLINT: Silence relative path warning.
@@ -137,7 +139,11 @@ GltfDiskStream::GltfDiskStream(
 
 std::unique_ptr<std::istream> GltfDiskStream::GetGltfIStream() {
   std::unique_ptr<std::ifstream> is(new std::ifstream(gltf_path_));
-  return is->is_open() ? std::unique_ptr<std::istream>(is.release()) : nullptr;
+  if (!is->is_open()) {
+    return nullptr;
+  }
+  RecordPath(gltf_path_.c_str(), false);
+  return std::unique_ptr<std::istream>(is.release());
 }
 
 bool GltfDiskStream::BufferExists(const Gltf& gltf, Gltf::Id buffer_id) const {
@@ -151,7 +157,7 @@ bool GltfDiskStream::BufferExists(const Gltf& gltf, Gltf::Id buffer_id) const {
   if (buffer->uri.path.empty()) {
     return false;
   }
-  return FileExistsPossiblySanitized(path_prefix_, buffer->uri.path.c_str());
+  return ResourceExists(buffer->uri.path.c_str());
 }
 
 bool GltfDiskStream::ImageExists(const Gltf& gltf, Gltf::Id image_id) const {
@@ -169,7 +175,7 @@ bool GltfDiskStream::ImageExists(const Gltf& gltf, Gltf::Id image_id) const {
     if (image->uri.path.empty()) {
       return false;
     }
-    return FileExistsPossiblySanitized(path_prefix_, image->uri.path.c_str());
+    return ResourceExists(image->uri.path.c_str());
   } else {
     if (image->mimeType == Gltf::Image::kMimeUnset) {
       return false;
@@ -272,10 +278,34 @@ GltfStream::ImageAttributes GltfDiskStream::ReadImageAttributes(
     // File is specified by path.
     attrs.path = image->uri.path;
 
+    // Parse the header from memory if the file was preloaded.
+    {
+      std::lock_guard<std::mutex> lock(preload_mutex_);
+      const auto found = preloaded_.find(image->uri.path);
+      if (found != preloaded_.end()) {
+        const Preloaded& preloaded = found->second;
+        const char* const preloaded_rel_path =
+            preloaded.path.c_str() + path_prefix_.length();
+        if (image->uri.path != preloaded_rel_path) {
+          attrs.path = preloaded_rel_path;
+          attrs.unsanitized_path = image->uri.path;
+        }
+        attrs.exists = true;
+        attrs.file_type = Gltf::FindImageMimeTypeByUri(image->uri);
+        attrs.file_size = preloaded.data.size();
+        attrs.real_type = GltfParseImage(
+            preloaded.data.data(), preloaded.data.size(),
+            image->uri.path.c_str(), GetLogger(), &attrs.width, &attrs.height);
+        return attrs;
+      }
+    }
+
     // Open the file, sanitizing the path if necessary.
     std::string path = path_prefix_ + image->uri.path;
     GltfDiskFileSentry file(path.c_str(), "rb");
     if (!file.fp) {
+      RecordMissingPath(path.c_str());
+
       // Try again with the sanitized path.
       char* const sane_rel_path = &path[path_prefix_.length()];
       if (Gltf::SanitizePath(sane_rel_path)) {
@@ -288,6 +318,7 @@ GltfStream::ImageAttributes GltfDiskStream::ReadImageAttributes(
       attrs.unsanitized_path = image->uri.path;
     }
 
+    RecordPath(path.c_str(), false);
     attrs.exists = true;
     attrs.file_type = Gltf::FindImageMimeTypeByUri(image->uri);
     attrs.file_size = GetFileSize(file.fp);
@@ -338,9 +369,94 @@ bool GltfDiskStream::CopyImage(const Gltf& gltf, Gltf::Id image_id,
 
 bool GltfDiskStream::IsSourcePath(const char* path) const {
   const std::string key = GetCanonicalPath(path, true);
+  std::lock_guard<std::mutex> lock(paths_mutex_);
   return src_paths_.find(key) != src_paths_.end();
 }
 
+std::vector<std::string> GltfDiskStream::GetSourcePaths() const {
+  std::lock_guard<std::mutex> lock(paths_mutex_);
+  return std::vector<std::string>(read_paths_.begin(), read_paths_.end());
+}
+
+std::vector<std::string> GltfDiskStream::GetMissingSourcePaths() const {
+  std::lock_guard<std::mutex> lock(paths_mutex_);
+  return std::vector<std::string>(missing_paths_.begin(),
+                                  missing_paths_.end());
+}
+
+void GltfDiskStream::PreloadResources(const Gltf& gltf) {
+  // Gather unique paths of external files.
+  std::vector<std::string> rel_paths;
+  for (const Gltf::Buffer& buffer : gltf.buffers) {
+    if (buffer.uri.data_type == Gltf::Uri::kDataTypeNone &&
+        !buffer.uri.path.empty()) {
+      rel_paths.push_back(buffer.uri.path);
+    }
+  }
+  for (const Gltf::Image& image : gltf.images) {
+    if (image.bufferView == Gltf::Id::kNull &&
+        image.uri.data_type == Gltf::Uri::kDataTypeNone &&
+        !image.uri.path.empty()) {
+      rel_paths.push_back(image.uri.path);
+    }
+  }
+  std::sort(rel_paths.begin(), rel_paths.end());
+  rel_paths.erase(std::unique(rel_paths.begin(), rel_paths.end()),
+                  rel_paths.end());
+  if (rel_paths.empty()) {
+    return;
+  }
+
+  std::vector<GltfDiskFileRead> reads(rel_paths.size());
+  for (size_t i = 0; i != rel_paths.size(); ++i) {
+    reads[i].path = path_prefix_ + rel_paths[i];
+  }
+  GltfDiskReadFiles(&reads);
+
+  // Try again with sanitized paths for files that couldn't be read.
+  std::vector<GltfDiskFileRead> retries;
+  std::vector<size_t> retry_indices;
+  for (size_t i = 0; i != reads.size(); ++i) {
+    if (reads[i].success) {
+      continue;
+    }
+    if (!FileExists(reads[i].path.c_str())) {
+      RecordMissingPath(reads[i].path.c_str());
+    }
+    std::string path = reads[i].path;
+    char* const sane_rel_path = &path[path_prefix_.length()];
+    if (Gltf::SanitizePath(sane_rel_path)) {
+      retries.emplace_back();
+      retries.back().path = std::move(path);
+      retry_indices.push_back(i);
+    }
+  }
+  if (!retries.empty()) {
+    GltfDiskReadFiles(&retries);
+    for (size_t i = 0; i != retries.size(); ++i) {
+      reads[retry_indices[i]] = std::move(retries[i]);
+    }
+  }
+
+  // Files that still couldn't be read are skipped, so the error is reported
+  // when they're actually used.
+  std::lock_guard<std::mutex> lock(preload_mutex_);
+  for (size_t i = 0; i != reads.size(); ++i) {
+    GltfDiskFileRead& read = reads[i];
+    if (read.success) {
+      Preloaded& preloaded = preloaded_[rel_paths[i]];
+      preloaded.path = std::move(read.path);
+      preloaded.data.swap(read.data);
+    }
+  }
+}
+
+void GltfDiskStream::ReleasePreloadedResources() {
+  std::map<std::string, Preloaded> released;
+  std::lock_guard<std::mutex> lock(preload_mutex_);
+  released.swap(preloaded_);
+}
+
 bool GltfDiskStream::WriteBinary(const std::string& dst_path,
                                  const void* data, size_t size) {
   GltfDiskFileSentry file(dst_path.c_str(), "wb");
@@ -358,7 +474,11 @@ bool GltfDiskStream::WriteBinary(const std::string& dst_path,
 bool GltfDiskStream::GlbOpen(const char* path) {
   GlbClose();
   glb_file_ = fopen(path, "rb");
-  return glb_file_ != nullptr;
+  if (!glb_file_) {
+    return false;
+  }
+  RecordPath(path, false);
+  return true;
 }
 
 bool GltfDiskStream::GlbIsOpen() const {
@@ -419,9 +539,16 @@ bool GltfDiskStream::SanitizedPathsEqual(const char* dir0, const char* name0,
 bool GltfDiskStream::ReadBinary(
     const char* rel_path, size_t start, ptrdiff_t size,
     std::vector<uint8_t>* out_data) {
+  bool success;
+  if (ReadPreloaded(rel_path, start, size, out_data, &success)) {
+    return success;
+  }
+
   std::string path = path_prefix_ + rel_path;
   GltfDiskFileSentry file(path.c_str(), "rb");
   if (!file.fp) {
+    RecordMissingPath(path.c_str());
+
     // Try again with the sanitized path.
     char* const sane_rel_path = &path[path_prefix_.length()];
     if (Gltf::SanitizePath(sane_rel_path)) {
@@ -434,7 +561,7 @@ bool GltfDiskStream::ReadBinary(
   }
 
   // Record the source path for IsSourcePath checks.
-  src_paths_.insert(GetCanonicalPath(path.c_str(), true));
+  RecordPath(path.c_str(), true);
 
   if (size < 0) {
     const size_t file_size = GetFileSize(file.fp);
@@ -458,18 +585,118 @@ bool GltfDiskStream::ReadBinary(
   return true;
 }
 
+bool GltfDiskStream::IsPreloaded(const char* rel_path) const {
+  std::lock_guard<std::mutex> lock(preload_mutex_);
+  return preloaded_.find(rel_path) != preloaded_.end();
+}
+
+bool GltfDiskStream::ResourceExists(const char* rel_path) const {
+  if (IsPreloaded(rel_path)) {
+    return true;
+  }
+  const std::string path = path_prefix_ + rel_path;
+  if (!FileExists(path.c_str())) {
+    RecordMissingPath(path.c_str());
+    return FileExistsPossiblySanitized(path_prefix_, rel_path);
+  }
+  return true;
+}
+
+bool GltfDiskStream::ReadPreloaded(
+    const char* rel_path, size_t start, ptrdiff_t size,
+    std::vector<uint8_t>* out_data, bool* out_success) {
+  std::string path;
+  std::vector<uint8_t> data;
+  *out_success = false;
+  {
+    std::lock_guard<std::mutex> lock(preload_mutex_);
+    const auto found = preloaded_.find(rel_path);
+    if (found == preloaded_.end()) {
+      return false;
+    }
+    Preloaded& preloaded = found->second;
+    path = preloaded.path;
+    const size_t file_size = preloaded.data.size();
+    if (start > file_size) {
+      Log<GLTF_ERROR_IO_READ_LONG>(start, file_size, path.c_str());
+    } else if (size >= 0 && static_cast<size_t>(size) > file_size - start) {
+      Log<GLTF_ERROR_IO_READ>(size, start, path.c_str());
+    } else {
+      const size_t end = size < 0 ? file_size : start + size;
+      if (start == 0 && end == file_size) {
+        // The whole file is consumed, so release it rather than copying.
+        data.swap(preloaded.data);
+        preloaded_.erase(found);
+      } else {
+        data.assign(preloaded.data.begin() + start,
+                    preloaded.data.begin() + end);
+      }
+      *out_success = true;
+    }
+  }
+
+  // Record the source path for IsSourcePath checks.
+  RecordPath(path.c_str(), true);
+  if (*out_success) {
+    out_data->swap(data);
+  }
+  return true;
+}
+
+bool GltfDiskStream::TakePreloaded(const char* rel_path, std::string* out_path,
+                                   std::vector<uint8_t>* out_data) {
+  std::lock_guard<std::mutex> lock(preload_mutex_);
+  const auto found = preloaded_.find(rel_path);
+  if (found == preloaded_.end()) {
+    return false;
+  }
+  out_path->swap(found->second.path);
+  out_data->swap(found->second.data);
+  preloaded_.erase(found);
+  return true;
+}
+
 bool GltfDiskStream::CopyBinary(const char* src_rel_path,
                                 const char* dst_path) {
+  // Write preloaded contents rather than reading the file again. The copy
+  // consumes them, so they're released afterward.
+  std::string preloaded_path;
+  std::vector<uint8_t> preloaded_data;
+  if (TakePreloaded(src_rel_path, &preloaded_path, &preloaded_data)) {
+    RecordPath(preloaded_path.c_str(), true);
+    return WriteBinary(dst_path, preloaded_data.data(), preloaded_data.size());
+  }
+
   std::string src_path = path_prefix_ + src_rel_path;
   if (CopyBinaryFile(src_path.c_str(), dst_path)) {
-    src_paths_.insert(GetCanonicalPath(src_path.c_str(), true));
+    RecordPath(src_path.c_str(), true);
     return true;
   }
+  if (!FileExists(src_path.c_str())) {
+    RecordMissingPath(src_path.c_str());
+  }
+
   // Try again with the sanitized path.
   char* const sane_src_rel_path = &src_path[path_prefix_.length()];
   if (Gltf::SanitizePath(sane_src_rel_path)) {
-    src_paths_.insert(GetCanonicalPath(src_path.c_str(), true));
+    RecordPath(src_path.c_str(), true);
     return CopyBinaryFile(src_path.c_str(), dst_path);
   }
   return false;
 }
+
+void GltfDiskStream::RecordPath(const char* path, bool is_src) {
+  std::string src_key = is_src ? GetCanonicalPath(path, true) : std::string();
+  std::string read_key = GetCanonicalPath(path, false);
+  std::lock_guard<std::mutex> lock(paths_mutex_);
+  if (is_src) {
+    src_paths_.insert(std::move(src_key));
+  }
+  read_paths_.insert(std::move(read_key));
+}
+
+void GltfDiskStream::RecordMissingPath(const char* path) const {
+  std::string key = GetCanonicalPath(path, false);
+  std::lock_guard<std::mutex> lock(paths_mutex_);
+  missing_paths_.insert(std::move(key));
+}
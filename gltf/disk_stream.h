@@ -18,6 +18,8 @@
 #define GLTF_DISK_STREAM_H_
 
 #include <stdio.h>
+#include <map>
+#include <mutex>  // NOLINT: Unapproved C++11 header.
 #include <set>
 #include "stream.h"  // NOLINT: Silence relative path warning.
 
@@ -43,6 +45,10 @@ class GltfDiskStream : public GltfStream {
   bool CopyImage(const Gltf& gltf, Gltf::Id image_id,
                  const char* dst_path) override;
   bool IsSourcePath(const char* path) const override;
+  std::vector<std::string> GetSourcePaths() const override;
+  std::vector<std::string> GetMissingSourcePaths() const override;
+  void PreloadResources(const Gltf& gltf) override;
+  void ReleasePreloadedResources() override;
   bool WriteBinary(
       const std::string& dst_path, const void* data, size_t size) override;
 
@@ -69,15 +75,57 @@ class GltfDiskStream : public GltfStream {
  private:
   std::string gltf_path_;
   std::string path_prefix_;
+  // Paths are recorded under a mutex, so images may be read concurrently with
+  // other stream access.
+  mutable std::mutex paths_mutex_;
   std::set<std::string> src_paths_;
+  // Canonical paths of all files read, in their original case.
+  std::set<std::string> read_paths_;
+  // Canonical paths of referenced files that couldn't be found, before
+  // sanitization.
+  mutable std::set<std::string> missing_paths_;
   FILE* glb_file_;
 
+  // Contents of files read by PreloadResources, keyed by relative path as it
+  // appears in the glTF. Entries are released once their whole file has been
+  // read or copied, or by ReleasePreloadedResources.
+  struct Preloaded {
+    // Path the file was read from (sanitized if necessary).
+    std::string path;
+    std::vector<uint8_t> data;
+  };
+  mutable std::mutex preload_mutex_;
+  std::map<std::string, Preloaded> preloaded_;
+
+  bool IsPreloaded(const char* rel_path) const;
+
+  // Check if a referenced file exists, sanitizing the path if necessary.
+  bool ResourceExists(const char* rel_path) const;
+
+  // Read from preloaded file contents, with the same semantics as ReadBinary.
+  // * Returns false if the file wasn't preloaded, otherwise sets out_success
+  //   to the result of the read.
+  bool ReadPreloaded(const char* rel_path, size_t start, ptrdiff_t size,
+                     std::vector<uint8_t>* out_data, bool* out_success);
+
+  // Remove a preloaded file, taking its path and contents. Returns false if it
+  // wasn't preloaded.
+  bool TakePreloaded(const char* rel_path, std::string* out_path,
+                     std::vector<uint8_t>* out_data);
+
   // Read binary file, in the range [start, start+size).
   // * Set 'size' to -1 to read to the end of the file.
   bool ReadBinary(const char* rel_path, size_t start, ptrdiff_t size,
                   std::vector<uint8_t>* out_data);
 
   bool CopyBinary(const char* src_rel_path, const char* dst_path);
+
+  // Record a file read from disk. Source files are also recorded for
+  // IsSourcePath checks.
+  void RecordPath(const char* path, bool is_src);
+
+  // Record a referenced file that couldn't be found at its unsanitized path.
+  void RecordMissingPath(const char* path) const;
 };
 
 #endif  // GLTF_DISK_STREAM_H_
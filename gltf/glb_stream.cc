@@ -235,6 +235,22 @@ bool GltfGlbStream::IsSourcePath(const char* path) const {
   return impl_stream_->IsSourcePath(path);
 }
 
+std::vector<std::string> GltfGlbStream::GetSourcePaths() const {
+  return impl_stream_->GetSourcePaths();
+}
+
+std::vector<std::string> GltfGlbStream::GetMissingSourcePaths() const {
+  return impl_stream_->GetMissingSourcePaths();
+}
+
+void GltfGlbStream::PreloadResources(const Gltf& gltf) {
+  impl_stream_->PreloadResources(gltf);
+}
+
+void GltfGlbStream::ReleasePreloadedResources() {
+  impl_stream_->ReleasePreloadedResources();
+}
+
 bool GltfGlbStream::WriteBinary(const std::string& dst_path,
                                 const void* data, size_t size) {
   return impl_stream_->WriteBinary(dst_path, data, size);
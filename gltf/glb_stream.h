@@ -68,6 +68,10 @@ class GltfGlbStream : public GltfStream {
   bool CopyImage(const Gltf& gltf, Gltf::Id image_id,
                  const char* dst_path) override;
   bool IsSourcePath(const char* path) const override;
+  std::vector<std::string> GetSourcePaths() const override;
+  std::vector<std::string> GetMissingSourcePaths() const override;
+  void PreloadResources(const Gltf& gltf) override;
+  void ReleasePreloadedResources() override;
   bool WriteBinary(const std::string& dst_path,
                    const void* data, size_t size) override;
 
@@ -16,10 +16,33 @@
 
 #include "gltf.h"  // NOLINT: Silence relative path warning.
 
+#include <stddef.h>
+#include <new>
+
 #include "internal_util.h"  // NOLINT: Silence relative path warning.
 
 const Gltf::Accessor::Value Gltf::Accessor::kValueZero = {};
 
+Gltf::Name::Data* Gltf::Name::Create(const char* text, size_t length) {
+  if (length == 0) {
+    return nullptr;
+  }
+  void* const memory = ::operator new(offsetof(Data, text) + length + 1);
+  Data* const data = static_cast<Data*>(memory);
+  new (&data->refs) std::atomic<uint32_t>(1);
+  data->length = static_cast<uint32_t>(length);
+  memcpy(data->text, text, length);
+  data->text[length] = '\0';
+  return data;
+}
+
+void Gltf::Name::Release(Data* data) {
+  if (data && data->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    data->refs.~atomic();
+    ::operator delete(data);
+  }
+}
+
 const Gltf::Camera::Orthographic Gltf::Camera::Orthographic::kDefault = {};
 const Gltf::Camera::Perspective Gltf::Camera::Perspective::kDefault = {};
 
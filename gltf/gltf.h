@@ -19,6 +19,7 @@
 
 #include <stdint.h>
 #include <algorithm>
+#include <atomic>  // NOLINT: Unapproved C++11 header.
 #include <cstring>
 #include <set>
 #include <string>
@@ -26,8 +27,8 @@
 
 struct Gltf {
   // Integer identifier used for internal glTF index references.
-  enum class Id : uint16_t {
-    kNull = 0xffff
+  enum class Id : uint32_t {
+    kNull = 0xffffffffu
   };
 
   inline static constexpr size_t IdToIndex(Id id) {
@@ -89,6 +90,67 @@ struct Gltf {
     T value_;
   };
 
+  // Immutable element name, usable in place of a std::string.
+  // * An empty name is a null pointer, so unnamed elements don't pay for
+  //   string storage.
+  // * Copies share reference-counted storage, and the loader interns equal
+  //   names so they're stored once.
+  class Name {
+   public:
+    Name() : data_(nullptr) {}
+    Name(const std::string& text)  // NOLINT: Implicit conversion.
+        : data_(Create(text.data(), text.size())) {}
+    Name(const char* text)  // NOLINT: Implicit conversion.
+        : data_(Create(text, strlen(text))) {}
+    Name(const Name& other) : data_(other.data_) {
+      if (data_) {
+        data_->refs.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+    Name(Name&& other) noexcept : data_(other.data_) {
+      other.data_ = nullptr;
+    }
+    ~Name() { Release(data_); }
+    Name& operator=(Name other) {
+      std::swap(data_, other.data_);
+      return *this;
+    }
+
+    bool empty() const { return !data_; }
+    size_t size() const { return data_ ? data_->length : 0; }
+    size_t length() const { return size(); }
+    const char* c_str() const { return data_ ? data_->text : ""; }
+    std::string str() const { return std::string(c_str(), size()); }
+    operator std::string() const { return str(); }
+    void clear() { Name().Swap(this); }
+    void Swap(Name* other) { std::swap(data_, other->data_); }
+
+    friend bool operator==(const Name& a, const Name& b) {
+      return a.data_ == b.data_ ||
+             (a.size() == b.size() &&
+              memcmp(a.c_str(), b.c_str(), a.size()) == 0);
+    }
+    friend bool operator!=(const Name& a, const Name& b) { return !(a == b); }
+    friend bool operator<(const Name& a, const Name& b) {
+      const size_t a_size = a.size();
+      const size_t b_size = b.size();
+      const int diff =
+          memcmp(a.c_str(), b.c_str(), a_size < b_size ? a_size : b_size);
+      return diff < 0 || (diff == 0 && a_size < b_size);
+    }
+
+   private:
+    struct Data {
+      std::atomic<uint32_t> refs;
+      uint32_t length;
+      char text[1];
+    };
+    Data* data_;
+
+    static Data* Create(const char* text, size_t length);
+    static void Release(Data* data);
+  };
+
   struct Uri {
     // Used for non-data URIs.
     std::string path;
@@ -144,21 +206,21 @@ struct Gltf {
   // attribute in a buffer.
   struct Accessor {
     // [Optional] Accessor name.
-    std::string name;
+    Name name;
     // [Optional] The index of the bufferView. When not defined, accessor must
     // be initialized with zeros; `sparse` property or extensions could override
     // zeros with actual values.
     Id bufferView = Id::kNull;
+    // [Optional] The offset relative to the start of the bufferView in bytes.
+    // This must be a multiple of the size of the component datatype.
+    // * Requires bufferView.
+    uint32_t byteOffset = 0;
     // [Optional] Specifies whether integer data values should be normalized
     // (`true`) to [0, 1] (for unsigned types) or [-1, 1] (for signed types), or
     // converted directly (`false`) when they are accessed. This property is
     // defined only for accessors that contain vertex attributes or animation
     // output data.
     bool normalized = false;
-    // [Optional] The offset relative to the start of the bufferView in bytes.
-    // This must be a multiple of the size of the component datatype.
-    // * Requires bufferView.
-    uint32_t byteOffset = 0;
 
     // [Required] The datatype of components in the attribute. All valid values
     // correspond to WebGL enums. The corresponding typed arrays are
@@ -190,6 +252,11 @@ struct Gltf {
       kTypeCount
     } type = kTypeUnset;
 
+    // Set if the source has min or max. Only then are their values meaningful.
+    // * Declared with the other small fields, rather than with min and max, so
+    //   it packs into their padding.
+    bool has_min_max = false;
+
     // [Required] The number of attributes referenced by this accessor, not to
     // be confused with the number of bytes or number of components.
     uint32_t count = 0;
@@ -332,7 +399,7 @@ struct Gltf {
     };
 
     // [Optional] Animation name.
-    std::string name;
+    Name name;
 
     // [Required] An array of channels, each of which targets an animation's
     // sampler at a node's property. Different channels of the same animation
@@ -348,7 +415,7 @@ struct Gltf {
   // A buffer points to binary geometry, animation, or skins.
   struct Buffer {
     // [Optional] The name of the buffer.
-    std::string name;
+    Name name;
     // [Optional] The uri of the buffer. Relative paths are relative to the
     // .gltf file. Instead of referencing an external file, the uri can also be
     // a data-uri.
@@ -360,7 +427,7 @@ struct Gltf {
   // A view into a buffer generally representing a subset of the buffer.
   struct BufferView {
     // [Optional] The name of the buffer view.
-    std::string name;
+    Name name;
     // [Required] The index of the buffer.
     Id buffer = Id::kNull;
     // [Optional] The offset into the buffer in bytes.
@@ -384,7 +451,7 @@ struct Gltf {
   // to place the camera in the scene.
   struct Camera {
     // [Optional] The name of the camera.
-    std::string name;
+    Name name;
 
     // [Required] Specifies if the camera uses a perspective or orthographic
     // projection. Based on this, either the camera's `perspective` or
@@ -448,7 +515,7 @@ struct Gltf {
   // `bufferView` index. `mimeType` is required in the latter case.
   struct Image {
     // [Optional] Image name.
-    std::string name;
+    Name name;
     // [Optional] The uri of the image. Relative paths are relative to the .gltf
     // file. Instead of referencing an external file, the uri can also be a
     // data-uri. The image format must be jpg or png.
@@ -504,7 +571,7 @@ struct Gltf {
     };
 
     // [Optional] Material name.
-    std::string name;
+    Name name;
 
     // [Optional] A set of parameter values that are used to define the
     // metallic-roughness material model from Physically-Based Rendering (PBR)
@@ -757,7 +824,7 @@ struct Gltf {
     };
 
     // [Optional] Mesh name.
-    std::string name;
+    Name name;
     // [Required] An array of primitives, each defining geometry to be rendered
     // with a material.
     std::vector<Primitive> primitives;
@@ -777,7 +844,7 @@ struct Gltf {
   // may be present; `matrix` will not be present.
   struct Node {
     // [Optional] Node name.
-    std::string name;
+    Name name;
     // [Optional] The index of the camera referenced by this node.
     Id camera = Id::kNull;
     // [Optional] The index of the mesh in this node.
@@ -823,7 +890,7 @@ struct Gltf {
   // Texture sampler properties for filtering and wrapping modes.
   struct Sampler {
     // [Optional] Sampler name.
-    std::string name;
+    Name name;
 
     // [Optional] Magnification filter. Valid values correspond to WebGL enums:
     // `9728` (NEAREST) and `9729` (LINEAR).
@@ -867,7 +934,7 @@ struct Gltf {
   // The root nodes of a scene.
   struct Scene {
     // [Optional] Scene name.
-    std::string name;
+    Name name;
     // [Optional] The indices of each root node.
     std::vector<Id> nodes;
   };
@@ -875,7 +942,7 @@ struct Gltf {
   // Joints and matrices defining a skin.
   struct Skin {
     // [Optional] Skin name.
-    std::string name;
+    Name name;
     // [Optional] The index of the accessor containing the floating-point 4x4
     // inverse-bind matrices. The default is that each matrix is a 4x4 identity
     // matrix, which implies that inverse-bind matrices were pre-applied.
@@ -892,7 +959,7 @@ struct Gltf {
   // A texture and its sampler.
   struct Texture {
     // [Optional] Texture name.
-    std::string name;
+    Name name;
     // [Optional] The index of the sampler used by this texture. When undefined,
     // a sampler with repeat wrapping and auto filtering should be used.
     Id sampler = Id::kNull;
@@ -19,6 +19,7 @@
 #include <stdarg.h>
 
 #include <limits>
+#include <unordered_map>
 
 #include "internal_util.h"  // NOLINT: Silence relative path warning.
 #include "json.hpp"
@@ -391,6 +392,7 @@ class GltfLoader {
   GltfLoadSettings settings_;
   GltfLogger* logger_;
   GltfPathStack path_stack_;
+  std::unordered_map<std::string, Gltf::Name> names_;
 
   template <GltfWhat kWhat, typename ...Ts>
   void Log(Ts... args) {
@@ -614,6 +616,21 @@ class GltfLoader {
     *out = json.get<std::string>();
   }
 
+  void Load(const Json& json, Gltf::Name* out) {
+    if (!json.is_string()) {
+      Log<GLTF_ERROR_EXPECTED_STRING>();
+      return;
+    }
+    // Share storage between elements with the same name (e.g. duplicated
+    // material or node names from exporters).
+    const std::string& text = json.get_ref<const std::string&>();
+    Gltf::Name& interned = names_[text];
+    if (interned.empty()) {
+      interned = text;
+    }
+    *out = interned;
+  }
+
   void Load(const Json& json, bool* out) {
     if (!json.is_boolean()) {
       Log<GLTF_ERROR_EXPECTED_BOOL>();
@@ -705,9 +722,10 @@ class GltfLoader {
       Log<GLTF_ERROR_EXPECTED_ID>();
       return;
     }
-    const int32_t id = json.get<int32_t>();
-    if (id >= static_cast<int32_t>(Id::kNull)) {
-      Log<GLTF_ERROR_ID_OUT_OF_RANGE>(id, static_cast<int>(Id::kNull) - 1);
+    const int64_t id = json.get<int64_t>();
+    if (id >= static_cast<int64_t>(Id::kNull)) {
+      Log<GLTF_ERROR_ID_OUT_OF_RANGE>(static_cast<size_t>(id),
+                                      Gltf::IdToIndex(Id::kNull) - 1);
       return;
     }
     *out = id < 0 ? Id::kNull : static_cast<Id>(id);
@@ -921,6 +939,8 @@ class GltfLoader {
     LoadField(json, "componentType", kGltfSeverityError, &out->componentType);
     LoadField(json, "type", kGltfSeverityError, &out->type);
     LoadField(json, "count", kGltfSeverityError, &out->count);
+    out->has_min_max =
+        json.find("min") != json.end() || json.find("max") != json.end();
     LoadField(json, "min", kGltfSeverityNone, out->componentType, out->type,
               &out->min);
     LoadField(json, "max", kGltfSeverityNone, out->componentType, out->type,
@@ -26,6 +26,20 @@ struct GltfLoadSettings {
   // Null terminated array used to disable warnings for unrecognized glTF
   // extensions.
   std::vector<std::string> nowarn_extension_prefixes;
+
+  // Read all external bin and image files in a single batch after the glTF is
+  // loaded (see GltfStream::PreloadResources). On Linux this uses io_uring, so
+  // it mostly helps with cold caches and network filesystems, at the cost of
+  // holding resource files in memory until they're used.
+  bool preload_resources = false;
+
+  // Number of threads used to validate the glTF in GltfLoadAndValidate (0 for
+  // the hardware thread count).
+  size_t validate_thread_count = 1;
+
+  // Also validate buffer and accessor data in GltfLoadAndValidate (see
+  // GltfValidateData). This reads all buffers up-front.
+  bool validate_data = false;
 };
 
 // Load glTF from an input stream.
@@ -149,7 +149,82 @@ std::string GltfPathStack::GetPath() const {
   return path;
 }
 
+GltfAsyncLogger::GltfAsyncLogger(GltfLogger* target)
+    : target_(target), error_count_(0), busy_(false), stopping_(false) {
+  thread_ = std::thread(&GltfAsyncLogger::Run, this);
+}
+
+GltfAsyncLogger::~GltfAsyncLogger() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stopping_ = true;
+    add_or_stop_event_.notify_all();
+  }
+  thread_.join();
+}
+
+void GltfAsyncLogger::Add(const GltfMessage& message) {
+  if (message.GetSeverity() == kGltfSeverityError) {
+    error_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  queue_.push_back(message);
+  add_or_stop_event_.notify_all();
+}
+
+void GltfAsyncLogger::Flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!queue_.empty() || busy_) {
+    idle_event_.wait(lock);
+  }
+}
+
+void GltfAsyncLogger::Run() {
+  std::vector<GltfMessage> batch;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      busy_ = false;
+      if (queue_.empty()) {
+        idle_event_.notify_all();
+        if (stopping_) {
+          break;
+        }
+        add_or_stop_event_.wait(lock);
+        continue;
+      }
+      // Forward messages in batches so producers aren't blocked on the
+      // target.
+      batch.swap(queue_);
+      busy_ = true;
+    }
+    for (const GltfMessage& message : batch) {
+      target_->Add(message);
+    }
+    batch.clear();
+  }
+}
+
+void GltfSequencedLogger::Begin(Task* task) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  task->sequence_ = next_begin_++;
+  task->messages_.clear();
+}
+
+void GltfSequencedLogger::End(Task* task) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  ended_[task->sequence_].swap(task->messages_);
+  for (auto it = ended_.begin();
+       it != ended_.end() && it->first == next_forward_;
+       it = ended_.erase(it), ++next_forward_) {
+    for (const GltfMessage& message : it->second) {
+      target_->Add(message);
+    }
+  }
+}
+
 void GltfOnceLogger::Reset(GltfLogger* logger) {
+  std::unique_lock<std::mutex> lock(mutex_);
   logger_ = logger;
   map_.clear();
   entries_.clear();
@@ -157,6 +232,7 @@ void GltfOnceLogger::Reset(GltfLogger* logger) {
 
 void GltfOnceLogger::Add(
     const char* footer, const char* name, const GltfMessage& message) {
+  std::unique_lock<std::mutex> lock(mutex_);
   const auto insert_result = map_.insert(std::make_pair(message, Value()));
 
   // Add new entries to the ordered set.
@@ -175,6 +251,7 @@ void GltfOnceLogger::Add(
 void GltfOnceLogger::Flush() {
   static constexpr size_t kOnceNameMax = 3;
 
+  std::unique_lock<std::mutex> lock(mutex_);
   for (const Entry* const entry : entries_) {
     const GltfMessage& key = entry->first;
     const Value& value = entry->second;
@@ -216,5 +293,6 @@ void GltfOnceLogger::Flush() {
     logger_->Add(message);
   }
 
-  Reset(logger_);
+  map_.clear();
+  entries_.clear();
 }
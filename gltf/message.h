@@ -20,8 +20,13 @@
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <atomic>  // NOLINT: Unapproved C++11 header.
+#include <condition_variable>  // NOLINT: Unapproved C++11 header.
+#include <map>
+#include <mutex>  // NOLINT: Unapproved C++11 header.
 #include <set>
 #include <string>
+#include <thread>  // NOLINT: Unapproved C++11 header.
 #include <unordered_map>
 #include <vector>
 
@@ -315,7 +320,89 @@ class GltfVectorLogger : public GltfLogger {
   std::vector<GltfMessage> messages_;
 };
 
+// Logger that forwards messages to another logger on a background thread, so
+// callers don't block on output.
+// * Messages are forwarded in the order they're added.
+// * Errors are counted as messages are added, so GetErrorCount is up-to-date
+//   before messages are forwarded.
+// * The target is only called from the background thread.
+class GltfAsyncLogger : public GltfLogger {
+ public:
+  explicit GltfAsyncLogger(GltfLogger* target);
+  ~GltfAsyncLogger() override;
+
+  void Add(const GltfMessage& message) override;
+
+  size_t GetErrorCount() const override {
+    return error_count_.load(std::memory_order_relaxed);
+  }
+
+  // Wait until all added messages have been forwarded.
+  void Flush();
+
+ private:
+  GltfLogger* target_;
+  std::atomic<size_t> error_count_;
+  std::mutex mutex_;
+  std::condition_variable add_or_stop_event_;
+  std::condition_variable idle_event_;
+  std::vector<GltfMessage> queue_;
+  bool busy_;
+  bool stopping_;
+  std::thread thread_;
+
+  void Run();
+};
+
+// Collects messages from tasks running in parallel, and forwards them to
+// another logger in task order regardless of the order tasks complete in.
+// * Each task logs to its own buffer, so logging within a task doesn't lock.
+// * Tasks are ordered by the sequence they're begun in, so Begin should be
+//   called from a single thread (e.g. when scheduling) for deterministic
+//   output.
+// * Every begun task must be ended, otherwise messages from later tasks are
+//   never forwarded.
+class GltfSequencedLogger {
+ public:
+  // Per-task logger, valid between Begin and End.
+  class Task : public GltfLogger {
+   public:
+    void Add(const GltfMessage& message) override {
+      messages_.push_back(message);
+    }
+    size_t GetErrorCount() const override {
+      return GltfMessage::CountErrors(messages_);
+    }
+
+   private:
+    friend class GltfSequencedLogger;
+    size_t sequence_ = 0;
+    std::vector<GltfMessage> messages_;
+  };
+
+  explicit GltfSequencedLogger(GltfLogger* target)
+      : target_(target), next_begin_(0), next_forward_(0) {}
+
+  // Begin a task, assigning it the next sequence number.
+  void Begin(Task* task);
+
+  // End a task, forwarding its messages (and those of any later tasks waiting
+  // on it) once all earlier tasks have ended.
+  // * The target is called with an internal lock held, so it's never called
+  //   concurrently by this logger.
+  void End(Task* task);
+
+ private:
+  GltfLogger* target_;
+  std::mutex mutex_;
+  size_t next_begin_;
+  size_t next_forward_;
+  std::map<size_t, std::vector<GltfMessage>> ended_;
+};
+
 // Utility used to merge similar messages.
+// * This is thread-safe, so tasks may log to a shared instance. Messages are
+//   forwarded in the order they were first added.
 class GltfOnceLogger {
  public:
   GltfOnceLogger() : logger_(nullptr) {}
@@ -343,6 +430,7 @@ class GltfOnceLogger {
   using Map =
       std::unordered_map<GltfMessage, Value, MessageHasher, MessageEqual>;
   using Entry = Map::value_type;
+  std::mutex mutex_;
   GltfLogger* logger_;
   Map map_;
   std::vector<const Entry*> entries_;
@@ -101,6 +101,12 @@ GLTF_MSG1(ERROR, MORPH_NO_MESH             , "Node has %zu morph target weights
 GLTF_MSG2(ERROR, BAD_INV_BIND_FORMAT       , "Unsupported inverseBindMatrices type: %s[%s]", const char*, type, const char*, component)
 GLTF_MSG2(ERROR, SKIN_JOINT_BIND_MISMATCH  , "Mismatched number of joints(%zu) and inverseBindMatrices(%zu).", size_t, count_count, size_t, mat_count)
 GLTF_MSG1(ERROR, NODE_LOOP                 , "Node hierarchy contains loop: %s", const char*, loop)
+GLTF_MSG2(ERROR, BUFFER_DATA_SHORT         , "Buffer data size %zu is less than byteLength %zu.", size_t, size, size_t, byte_length)
+GLTF_MSG3(ERROR, VIEW_OUTSIDE_BUFFER_DATA  , "Buffer view range [%zu, %zu) exceeds buffer data size %zu.", size_t, begin, size_t, end, size_t, size)
+GLTF_MSG2(ERROR, ACCESSOR_NON_FINITE       , "Accessor contains %zu non-finite values (first at element %zu).", size_t, count, size_t, element)
+GLTF_MSG5(WARN , ACCESSOR_OUTSIDE_BOUNDS   , "Component %zu range [%f, %f] exceeds declared min/max [%f, %f].", size_t, component, float, min, float, max, float, declared_min, float, declared_max)
+GLTF_MSG2(ERROR, SPARSE_INDEX_OUT_OF_RANGE , "Sparse index %zu out of range (count=%zu).", size_t, index, size_t, count)
+GLTF_MSG2(ERROR, INDEX_OUT_OF_RANGE        , "Index %zu out of range (vertex count=%zu).", size_t, index, size_t, vert_count)
 GLTF_MSG3(WARN , SCALAR_OUT_OF_RANGE       , "Value %f out of range [%f, %f].", float, value, float, lower, float, upper)
 GLTF_MSG3(WARN , VECTOR_OUT_OF_RANGE       , "Value <%s> out of range [%f, %f].", const char*, value, float, lower, float, upper)
 GLTF_MSG1(ERROR, BAD_BUFFER_ID             , "Invalid buffer ID: %zu", size_t, buffer_index)
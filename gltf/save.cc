@@ -0,0 +1,654 @@
+/*
+ * Copyright 2019 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "save.h"  // NOLINT: Silence relative path warning.
+
+#include <algorithm>
+#include <limits>
+
+#include "glb_stream.h"  // NOLINT: Silence relative path warning.
+#include "internal_util.h"  // NOLINT: Silence relative path warning.
+#include "json.hpp"
+
+namespace {
+using Json = nlohmann::json;
+
+using Id = Gltf::Id;
+using Uri = Gltf::Uri;
+using Accessor = Gltf::Accessor;
+using Animation = Gltf::Animation;
+using Camera = Gltf::Camera;
+using Material = Gltf::Material;
+using Mesh = Gltf::Mesh;
+using Node = Gltf::Node;
+using Sampler = Gltf::Sampler;
+
+const char* const kUriDataTypePrefixes[] = {
+    nullptr,                                  // kDataTypeNone
+    "data:application/octet-stream;base64,",  // kDataTypeBin
+    "data:image/jpeg;base64,",                // kDataTypeImageJpeg
+    "data:image/png;base64,",                 // kDataTypeImagePng
+    "data:image/bmp;base64,",                 // kDataTypeImageBmp
+    "data:image/gif;base64,",                 // kDataTypeImageGif
+    "data:image/octet-stream;base64,",        // kDataTypeImageOther
+    "data:application/octet-stream;base64,",  // kDataTypeUnknown
+};
+static_assert(arraysize(kUriDataTypePrefixes) == Gltf::Uri::kDataTypeCount,
+              "");
+
+const char kBase64Chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+void EncodeBase64(const uint8_t* data, size_t size, std::string* out) {
+  out->reserve(out->size() + (size + 2) / 3 * 4);
+  size_t i = 0;
+  for (; i + 3 <= size; i += 3) {
+    const uint32_t v = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+    out->push_back(kBase64Chars[(v >> 18) & 0x3f]);
+    out->push_back(kBase64Chars[(v >> 12) & 0x3f]);
+    out->push_back(kBase64Chars[(v >> 6) & 0x3f]);
+    out->push_back(kBase64Chars[v & 0x3f]);
+  }
+  const size_t remain = size - i;
+  if (remain) {
+    const uint32_t v =
+        (data[i] << 16) | (remain == 2 ? (data[i + 1] << 8) : 0);
+    out->push_back(kBase64Chars[(v >> 18) & 0x3f]);
+    out->push_back(kBase64Chars[(v >> 12) & 0x3f]);
+    out->push_back(remain == 2 ? kBase64Chars[(v >> 6) & 0x3f] : '=');
+    out->push_back('=');
+  }
+}
+
+template <typename T, size_t kCount>
+Json ToJsonArray(const T (&values)[kCount]) {
+  return Json(std::vector<T>(values, values + kCount));
+}
+
+template <typename T, size_t kCount>
+bool IsArrayEqual(const T (&a)[kCount], const T (&b)[kCount]) {
+  return std::equal(a, a + kCount, b);
+}
+
+Json ToJson(const std::vector<Id>& ids) {
+  Json json = Json::array();
+  for (const Id id : ids) {
+    json.push_back(Gltf::IdToIndex(id));
+  }
+  return json;
+}
+
+class Saver {
+ public:
+  explicit Saver(const Gltf& gltf) : gltf_(gltf) {
+    // Mark accessors that require min/max, even if the source lacks them.
+    bounded_accessors_.resize(gltf.accessors.size(), false);
+    for (const Mesh& mesh : gltf.meshes) {
+      for (const Mesh::Primitive& prim : mesh.primitives) {
+        MarkBounded(prim.attributes);
+        for (const Mesh::AttributeSet& target : prim.targets) {
+          MarkBounded(target);
+        }
+      }
+    }
+    for (const Animation& animation : gltf.animations) {
+      for (const Animation::Sampler& sampler : animation.samplers) {
+        MarkBounded(sampler.input);
+      }
+    }
+  }
+
+  Json Save() {
+    Json json = Json::object();
+    json["asset"] = SaveAsset();
+    if (gltf_.scene != Id::kNull) {
+      json["scene"] = Gltf::IdToIndex(gltf_.scene);
+    }
+    SaveExtensionNames(gltf_.extensionsUsed, "extensionsUsed", &json);
+    SaveExtensionNames(gltf_.extensionsRequired, "extensionsRequired", &json);
+    SaveArray(gltf_.accessors, "accessors", &json);
+    SaveArray(gltf_.animations, "animations", &json);
+    SaveArray(gltf_.buffers, "buffers", &json);
+    SaveArray(gltf_.bufferViews, "bufferViews", &json);
+    SaveArray(gltf_.cameras, "cameras", &json);
+    SaveArray(gltf_.images, "images", &json);
+    SaveArray(gltf_.materials, "materials", &json);
+    SaveArray(gltf_.meshes, "meshes", &json);
+    SaveArray(gltf_.nodes, "nodes", &json);
+    SaveArray(gltf_.samplers, "samplers", &json);
+    SaveArray(gltf_.scenes, "scenes", &json);
+    SaveArray(gltf_.skins, "skins", &json);
+    SaveArray(gltf_.textures, "textures", &json);
+    return json;
+  }
+
+ private:
+  const Gltf& gltf_;
+  std::vector<bool> bounded_accessors_;
+
+  void MarkBounded(Id accessor_id) {
+    const size_t index = Gltf::IdToIndex(accessor_id);
+    if (index < bounded_accessors_.size()) {
+      bounded_accessors_[index] = true;
+    }
+  }
+
+  void MarkBounded(const Mesh::AttributeSet& attrs) {
+    const auto found = attrs.find(Mesh::kAttributePosition);
+    if (found != attrs.end()) {
+      MarkBounded(found->accessor);
+    }
+  }
+
+  static void SetName(const std::string& name, Json* json) {
+    if (!name.empty()) {
+      (*json)["name"] = name;
+    }
+  }
+
+  static void SetId(const char* key, Id id, Json* json) {
+    if (id != Id::kNull) {
+      (*json)[key] = Gltf::IdToIndex(id);
+    }
+  }
+
+  static void SetUri(const Uri& uri, Json* json) {
+    if (uri.data_type != Uri::kDataTypeNone) {
+      std::string text = kUriDataTypePrefixes[uri.data_type];
+      EncodeBase64(uri.data.data(), uri.data.size(), &text);
+      (*json)["uri"] = std::move(text);
+    } else if (!uri.path.empty()) {
+      (*json)["uri"] = uri.path;
+    }
+  }
+
+  static void SaveExtensionNames(const std::vector<Gltf::ExtensionId>& ids,
+                                 const char* key, Json* json) {
+    if (ids.empty()) {
+      return;
+    }
+    Json& names = (*json)[key] = Json::array();
+    for (const Gltf::ExtensionId id : ids) {
+      const char* const name = Gltf::GetEnumName(id);
+      if (name) {
+        names.push_back(name);
+      }
+    }
+  }
+
+  template <typename Value>
+  void SaveArray(const std::vector<Value>& values, const char* key,
+                 Json* json) {
+    if (values.empty()) {
+      return;
+    }
+    Json& array = (*json)[key] = Json::array();
+    for (size_t i = 0; i != values.size(); ++i) {
+      array.push_back(Save(values[i], i));
+    }
+  }
+
+  Json SaveAsset() const {
+    const Gltf::Asset& asset = gltf_.asset;
+    Json json = Json::object();
+    if (!asset.copyright.empty()) {
+      json["copyright"] = asset.copyright;
+    }
+    if (!asset.generator.empty()) {
+      json["generator"] = asset.generator;
+    }
+    json["version"] = asset.version.empty() ? "2.0" : asset.version;
+    if (!asset.minVersion.empty()) {
+      json["minVersion"] = asset.minVersion;
+    }
+    return json;
+  }
+
+  static Json SaveAccessorValue(const Accessor& accessor,
+                                const Accessor::Value& value) {
+    const size_t count = Gltf::GetComponentCount(accessor.type);
+    Json json = Json::array();
+    switch (Gltf::GetComponentFormat(accessor.componentType)) {
+    case Gltf::kComponentFormatSignedInt:
+      for (size_t i = 0; i != count; ++i) {
+        json.push_back(value.i[i]);
+      }
+      break;
+    case Gltf::kComponentFormatUnsignedInt:
+      for (size_t i = 0; i != count; ++i) {
+        json.push_back(value.u[i]);
+      }
+      break;
+    case Gltf::kComponentFormatFloat:
+    default:
+      for (size_t i = 0; i != count; ++i) {
+        json.push_back(value.f[i]);
+      }
+      break;
+    }
+    return json;
+  }
+
+  Json Save(const Accessor& accessor, size_t index) const {
+    Json json = Json::object();
+    SetName(accessor.name, &json);
+    SetId("bufferView", accessor.bufferView, &json);
+    if (accessor.byteOffset != 0) {
+      json["byteOffset"] = accessor.byteOffset;
+    }
+    json["componentType"] =
+        Gltf::kAccessorComponentTypeValues[accessor.componentType];
+    if (accessor.normalized) {
+      json["normalized"] = true;
+    }
+    json["count"] = accessor.count;
+    json["type"] = Gltf::GetEnumName(accessor.type);
+    if (accessor.has_min_max || bounded_accessors_[index]) {
+      json["min"] = SaveAccessorValue(accessor, accessor.min);
+      json["max"] = SaveAccessorValue(accessor, accessor.max);
+    }
+    const Accessor::Sparse& sparse = accessor.sparse;
+    if (sparse.count != 0) {
+      Json& sparse_json = json["sparse"] = Json::object();
+      sparse_json["count"] = sparse.count;
+      Json indices = Json::object();
+      SetId("bufferView", sparse.indices.bufferView, &indices);
+      if (sparse.indices.byteOffset != 0) {
+        indices["byteOffset"] = sparse.indices.byteOffset;
+      }
+      indices["componentType"] =
+          Gltf::kAccessorComponentTypeValues[sparse.indices.componentType];
+      sparse_json["indices"] = std::move(indices);
+      Json values = Json::object();
+      SetId("bufferView", sparse.values.bufferView, &values);
+      if (sparse.values.byteOffset != 0) {
+        values["byteOffset"] = sparse.values.byteOffset;
+      }
+      sparse_json["values"] = std::move(values);
+    }
+    return json;
+  }
+
+  Json Save(const Animation& animation, size_t index) const {
+    Json json = Json::object();
+    SetName(animation.name, &json);
+    Json& channels = json["channels"] = Json::array();
+    for (const Animation::Channel& channel : animation.channels) {
+      Json channel_json = Json::object();
+      SetId("sampler", channel.sampler, &channel_json);
+      Json target = Json::object();
+      SetId("node", channel.target.node, &target);
+      const char* const path = Gltf::GetEnumName(channel.target.path);
+      if (path) {
+        target["path"] = path;
+      }
+      channel_json["target"] = std::move(target);
+      channels.push_back(std::move(channel_json));
+    }
+    Json& samplers = json["samplers"] = Json::array();
+    for (const Animation::Sampler& sampler : animation.samplers) {
+      Json sampler_json = Json::object();
+      SetId("input", sampler.input, &sampler_json);
+      if (sampler.interpolation != Animation::Sampler::kInterpolationLinear) {
+        sampler_json["interpolation"] =
+            Gltf::GetEnumName(sampler.interpolation);
+      }
+      SetId("output", sampler.output, &sampler_json);
+      samplers.push_back(std::move(sampler_json));
+    }
+    return json;
+  }
+
+  Json Save(const Gltf::Buffer& buffer, size_t index) const {
+    Json json = Json::object();
+    SetName(buffer.name, &json);
+    SetUri(buffer.uri, &json);
+    json["byteLength"] = buffer.byteLength;
+    return json;
+  }
+
+  Json Save(const Gltf::BufferView& view, size_t index) const {
+    Json json = Json::object();
+    SetName(view.name, &json);
+    SetId("buffer", view.buffer, &json);
+    if (view.byteOffset != 0) {
+      json["byteOffset"] = view.byteOffset;
+    }
+    json["byteLength"] = view.byteLength;
+    if (view.byteStride != 0) {
+      json["byteStride"] = view.byteStride;
+    }
+    if (view.target != Gltf::BufferView::kTargetUnset) {
+      json["target"] = Gltf::kBufferViewTargetValues[view.target];
+    }
+    return json;
+  }
+
+  Json Save(const Camera& camera, size_t index) const {
+    Json json = Json::object();
+    SetName(camera.name, &json);
+    json["type"] = Gltf::GetEnumName(camera.type);
+    if (camera.type == Camera::kTypePerspective) {
+      const Camera::Perspective& persp = camera.perspective;
+      Json persp_json = Json::object();
+      if (persp.aspectRatio > 0.0f) {
+        persp_json["aspectRatio"] = persp.aspectRatio;
+      }
+      persp_json["yfov"] = persp.yfov;
+      if (persp.zfar > 0.0f) {
+        persp_json["zfar"] = persp.zfar;
+      }
+      persp_json["znear"] = persp.znear;
+      json["perspective"] = std::move(persp_json);
+    } else {
+      const Camera::Orthographic& ortho = camera.orthographic;
+      json["orthographic"] = {
+          {"xmag", ortho.xmag},
+          {"ymag", ortho.ymag},
+          {"zfar", ortho.zfar},
+          {"znear", ortho.znear},
+      };
+    }
+    return json;
+  }
+
+  Json Save(const Gltf::Image& image, size_t index) const {
+    Json json = Json::object();
+    SetName(image.name, &json);
+    SetUri(image.uri, &json);
+    if (image.mimeType != Gltf::Image::kMimeUnset &&
+        image.mimeType != Gltf::Image::kMimeOther) {
+      json["mimeType"] = Gltf::GetEnumName(image.mimeType);
+    }
+    SetId("bufferView", image.bufferView, &json);
+    return json;
+  }
+
+  static Json SaveTexture(const Material::Texture& texture) {
+    Json json = Json::object();
+    SetId("index", texture.index, &json);
+    if (texture.texCoord != 0) {
+      json["texCoord"] = texture.texCoord;
+    }
+    const Material::Texture::Transform& transform = texture.transform;
+    if (!transform.IsIdentity()) {
+      Json transform_json = Json::object();
+      if (transform.offset[0] != 0.0f || transform.offset[1] != 0.0f) {
+        transform_json["offset"] = ToJsonArray(transform.offset);
+      }
+      if (transform.rotation != 0.0f) {
+        transform_json["rotation"] = transform.rotation;
+      }
+      if (transform.scale[0] != 1.0f || transform.scale[1] != 1.0f) {
+        transform_json["scale"] = ToJsonArray(transform.scale);
+      }
+      json["extensions"][Gltf::GetEnumName(
+          Gltf::kExtensionTextureTransform)] = std::move(transform_json);
+    }
+    return json;
+  }
+
+  static void SetTexture(const char* key, const Material::Texture& texture,
+                         Json* json) {
+    if (texture.index != Id::kNull) {
+      (*json)[key] = SaveTexture(texture);
+    }
+  }
+
+  Json Save(const Material& material, size_t index) const {
+    static const Material kDefault;
+    const Material::Pbr& pbr = material.pbr;
+    Json json = Json::object();
+    SetName(material.name, &json);
+
+    Json pbr_json = Json::object();
+    if (!IsArrayEqual(pbr.baseColorFactor, kDefault.pbr.baseColorFactor)) {
+      pbr_json["baseColorFactor"] = ToJsonArray(pbr.baseColorFactor);
+    }
+    SetTexture("baseColorTexture", pbr.baseColorTexture, &pbr_json);
+    if (pbr.metallicFactor != kDefault.pbr.metallicFactor) {
+      pbr_json["metallicFactor"] = pbr.metallicFactor;
+    }
+    if (pbr.roughnessFactor != kDefault.pbr.roughnessFactor) {
+      pbr_json["roughnessFactor"] = pbr.roughnessFactor;
+    }
+    SetTexture("metallicRoughnessTexture", pbr.metallicRoughnessTexture,
+               &pbr_json);
+    json["pbrMetallicRoughness"] = std::move(pbr_json);
+
+    if (material.normalTexture.index != Id::kNull) {
+      Json normal = SaveTexture(material.normalTexture);
+      if (material.normalTexture.scale != 1.0f) {
+        normal["scale"] = material.normalTexture.scale;
+      }
+      json["normalTexture"] = std::move(normal);
+    }
+    if (material.occlusionTexture.index != Id::kNull) {
+      Json occlusion = SaveTexture(material.occlusionTexture);
+      if (material.occlusionTexture.strength != 1.0f) {
+        occlusion["strength"] = material.occlusionTexture.strength;
+      }
+      json["occlusionTexture"] = std::move(occlusion);
+    }
+    SetTexture("emissiveTexture", material.emissiveTexture, &json);
+    if (!IsArrayEqual(material.emissiveFactor, kDefault.emissiveFactor)) {
+      json["emissiveFactor"] = ToJsonArray(material.emissiveFactor);
+    }
+    if (material.alphaMode != Material::kAlphaModeOpaque) {
+      json["alphaMode"] = Gltf::GetEnumName(material.alphaMode);
+    }
+    if (material.alphaMode == Material::kAlphaModeMask &&
+        material.alphaCutoff != kDefault.alphaCutoff) {
+      json["alphaCutoff"] = material.alphaCutoff;
+    }
+    if (material.doubleSided) {
+      json["doubleSided"] = true;
+    }
+
+    if (pbr.specGloss) {
+      const Material::Pbr::SpecGloss& sg = *pbr.specGloss;
+      Json sg_json = Json::object();
+      sg_json["diffuseFactor"] = ToJsonArray(sg.diffuseFactor);
+      SetTexture("diffuseTexture", sg.diffuseTexture, &sg_json);
+      sg_json["specularFactor"] = ToJsonArray(sg.specularFactor);
+      sg_json["glossinessFactor"] = sg.glossinessFactor;
+      SetTexture("specularGlossinessTexture", sg.specularGlossinessTexture,
+                 &sg_json);
+      json["extensions"][Gltf::GetEnumName(Gltf::kExtensionSpecGloss)] =
+          std::move(sg_json);
+    }
+    if (material.unlit) {
+      json["extensions"][Gltf::GetEnumName(Gltf::kExtensionUnlit)] =
+          Json::object();
+    }
+    return json;
+  }
+
+  static Json SaveAttributes(const Mesh::AttributeSet& attrs) {
+    Json json = Json::object();
+    for (const Mesh::Attribute& attr : attrs) {
+      json[attr.ToString()] = Gltf::IdToIndex(attr.accessor);
+    }
+    return json;
+  }
+
+  Json Save(const Mesh& mesh, size_t index) const {
+    Json json = Json::object();
+    SetName(mesh.name, &json);
+    Json& prims = json["primitives"] = Json::array();
+    for (const Mesh::Primitive& prim : mesh.primitives) {
+      Json prim_json = Json::object();
+      prim_json["attributes"] = SaveAttributes(prim.attributes);
+      SetId("indices", prim.indices, &prim_json);
+      SetId("material", prim.material, &prim_json);
+      if (prim.mode != Mesh::Primitive::kModeTriangles) {
+        prim_json["mode"] = Gltf::kMeshPrimitiveModeValues[prim.mode];
+      }
+      if (!prim.targets.empty()) {
+        Json& targets = prim_json["targets"] = Json::array();
+        for (const Mesh::AttributeSet& target : prim.targets) {
+          targets.push_back(SaveAttributes(target));
+        }
+      }
+      if (prim.draco.bufferView != Id::kNull) {
+        Json draco = Json::object();
+        SetId("bufferView", prim.draco.bufferView, &draco);
+        draco["attributes"] = SaveAttributes(prim.draco.attributes);
+        prim_json["extensions"][Gltf::GetEnumName(Gltf::kExtensionDraco)] =
+            std::move(draco);
+      }
+      prims.push_back(std::move(prim_json));
+    }
+    if (!mesh.weights.empty()) {
+      json["weights"] = mesh.weights;
+    }
+    return json;
+  }
+
+  Json Save(const Node& node, size_t index) const {
+    static const Node kDefault;
+    Json json = Json::object();
+    SetName(node.name, &json);
+    SetId("camera", node.camera, &json);
+    SetId("mesh", node.mesh, &json);
+    SetId("skin", node.skin, &json);
+    if (node.is_matrix) {
+      json["matrix"] = ToJsonArray(node.matrix);
+    } else {
+      if (!IsArrayEqual(node.translation, kDefault.translation)) {
+        json["translation"] = ToJsonArray(node.translation);
+      }
+      if (!IsArrayEqual(node.rotation, kDefault.rotation)) {
+        json["rotation"] = ToJsonArray(node.rotation);
+      }
+      if (!IsArrayEqual(node.scale, kDefault.scale)) {
+        json["scale"] = ToJsonArray(node.scale);
+      }
+    }
+    if (!node.children.empty()) {
+      json["children"] = ToJson(node.children);
+    }
+    if (!node.weights.empty()) {
+      json["weights"] = node.weights;
+    }
+    return json;
+  }
+
+  Json Save(const Sampler& sampler, size_t index) const {
+    Json json = Json::object();
+    SetName(sampler.name, &json);
+    if (sampler.magFilter != Sampler::kMagFilterUnset) {
+      json["magFilter"] = Gltf::kSamplerMagFilterValues[sampler.magFilter];
+    }
+    if (sampler.minFilter != Sampler::kMinFilterUnset) {
+      json["minFilter"] = Gltf::kSamplerMinFilterValues[sampler.minFilter];
+    }
+    if (sampler.wrapS != Sampler::kWrapUnset) {
+      json["wrapS"] = Gltf::kSamplerWrapModeValues[sampler.wrapS];
+    }
+    if (sampler.wrapT != Sampler::kWrapUnset) {
+      json["wrapT"] = Gltf::kSamplerWrapModeValues[sampler.wrapT];
+    }
+    return json;
+  }
+
+  Json Save(const Gltf::Scene& scene, size_t index) const {
+    Json json = Json::object();
+    SetName(scene.name, &json);
+    if (!scene.nodes.empty()) {
+      json["nodes"] = ToJson(scene.nodes);
+    }
+    return json;
+  }
+
+  Json Save(const Gltf::Skin& skin, size_t index) const {
+    Json json = Json::object();
+    SetName(skin.name, &json);
+    SetId("inverseBindMatrices", skin.inverseBindMatrices, &json);
+    SetId("skeleton", skin.skeleton, &json);
+    json["joints"] = ToJson(skin.joints);
+    return json;
+  }
+
+  Json Save(const Gltf::Texture& texture, size_t index) const {
+    Json json = Json::object();
+    SetName(texture.name, &json);
+    SetId("sampler", texture.sampler, &json);
+    SetId("source", texture.source, &json);
+    return json;
+  }
+};
+
+void WriteU32(std::ostream& os, uint32_t value) {
+  // GLB is little-endian.
+  const uint8_t bytes[4] = {
+      static_cast<uint8_t>(value),
+      static_cast<uint8_t>(value >> 8),
+      static_cast<uint8_t>(value >> 16),
+      static_cast<uint8_t>(value >> 24)
+  };
+  os.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+}
+
+void WritePadding(std::ostream& os, size_t size, char pad) {
+  for (size_t i = size; i % 4 != 0; ++i) {
+    os.put(pad);
+  }
+}
+}  // namespace
+
+std::string GltfToJson(const Gltf& gltf, const GltfSaveSettings& settings) {
+  return Saver(gltf).Save().dump(settings.pretty ? 2 : -1);
+}
+
+bool GltfSave(std::ostream& os, const Gltf& gltf,
+              const GltfSaveSettings& settings) {
+  os << GltfToJson(gltf, settings);
+  return os.good();
+}
+
+bool GltfSaveGlb(std::ostream& os, const Gltf& gltf,
+                 const std::vector<uint8_t>& bin,
+                 const GltfSaveSettings& settings) {
+  const std::string json = GltfToJson(gltf, settings);
+  const size_t json_size = (json.size() + 3) & ~size_t(3);
+  const size_t bin_size = (bin.size() + 3) & ~size_t(3);
+  size_t total = sizeof(GlbFileHeader) + sizeof(GlbChunkHeader) + json_size;
+  if (!bin.empty()) {
+    total += sizeof(GlbChunkHeader) + bin_size;
+  }
+  if (total > std::numeric_limits<uint32_t>::max()) {
+    return false;
+  }
+
+  WriteU32(os, GlbFileHeader::kMagic);
+  WriteU32(os, GlbFileHeader::kVersion);
+  WriteU32(os, static_cast<uint32_t>(total));
+
+  // The JSON chunk is padded with spaces, the BIN chunk with zeros.
+  WriteU32(os, static_cast<uint32_t>(json_size));
+  WriteU32(os, GlbChunkHeader::kTypeJson);
+  os.write(json.data(), json.size());
+  WritePadding(os, json.size(), ' ');
+  if (!bin.empty()) {
+    WriteU32(os, static_cast<uint32_t>(bin_size));
+    WriteU32(os, GlbChunkHeader::kTypeBin);
+    os.write(reinterpret_cast<const char*>(bin.data()), bin.size());
+    WritePadding(os, bin.size(), '\0');
+  }
+  return os.good();
+}
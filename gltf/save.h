@@ -0,0 +1,47 @@
+/*
+ * Copyright 2019 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GLTF_SAVE_H_
+#define GLTF_SAVE_H_
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "gltf.h"  // NOLINT: Silence relative path warning.
+
+struct GltfSaveSettings {
+  // Indent the JSON for readability. Disable for smaller output.
+  bool pretty = true;
+};
+
+// Serialize glTF to JSON text.
+// * Buffers and images with data URIs are base64-encoded inline.
+// * Accessor min/max are written whenever the source has them
+//   (Accessor::has_min_max), and also where the spec requires them (POSITION
+//   attributes and animation sampler inputs).
+std::string GltfToJson(const Gltf& gltf, const GltfSaveSettings& settings);
+
+// Save glTF as JSON text to an output stream.
+bool GltfSave(std::ostream& os, const Gltf& gltf,
+              const GltfSaveSettings& settings);
+
+// Save glTF as binary GLB, with 'bin' stored in the BIN chunk. If 'bin' is
+// non-empty, the first buffer must have no URI (it refers to the BIN chunk).
+bool GltfSaveGlb(std::ostream& os, const Gltf& gltf,
+                 const std::vector<uint8_t>& bin,
+                 const GltfSaveSettings& settings);
+
+#endif  // GLTF_SAVE_H_
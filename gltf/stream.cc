@@ -85,6 +85,18 @@ bool GltfStream::IsSourcePath(const char* path) const {
   return false;
 }
 
+std::vector<std::string> GltfStream::GetSourcePaths() const {
+  return std::vector<std::string>();
+}
+
+std::vector<std::string> GltfStream::GetMissingSourcePaths() const {
+  return std::vector<std::string>();
+}
+
+void GltfStream::PreloadResources(const Gltf& gltf) {}
+
+void GltfStream::ReleasePreloadedResources() {}
+
 bool GltfStream::WriteBinary(
     const std::string& dst_path, const void* data, size_t size) {
   Log<GLTF_ERROR_NOT_IMPLEMENTED>("WriteBinary");
@@ -80,6 +80,25 @@ class GltfStream {
 
   virtual bool IsSourcePath(const char* path) const;
 
+  // Get canonical paths of the files read through this stream so far: the
+  // glTF or GLB itself, plus any bin and image files it references. Streams
+  // that aren't backed by files return an empty list.
+  virtual std::vector<std::string> GetSourcePaths() const;
+
+  // Get canonical paths of referenced files that were looked up but not found,
+  // so callers can detect when creating one would change the output.
+  virtual std::vector<std::string> GetMissingSourcePaths() const;
+
+  // Read all external bin and image files referenced by the glTF up front, in
+  // a single batch. Subsequent reads of those files are served from memory.
+  // Streams that aren't backed by files ignore this.
+  virtual void PreloadResources(const Gltf& gltf);
+
+  // Release preloaded file contents that weren't consumed by a full read or
+  // copy (e.g. files only read in part). Call once no more reads are expected;
+  // later reads fall back to disk.
+  virtual void ReleasePreloadedResources();
+
   virtual bool WriteBinary(const std::string& dst_path,
                            const void* data, size_t size);
 
@@ -16,6 +16,14 @@
 
 #include "validate.h"  // NOLINT: Silence relative path warning.
 
+#include <string.h>
+#include <atomic>  // NOLINT: Unapproved C++11 header.
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <thread>  // NOLINT: Unapproved C++11 header.
+#include <type_traits>
+#include "cache.h"  // NOLINT: Silence relative path warning.
 #include "internal_util.h"  // NOLINT: Silence relative path warning.
 
 namespace {
@@ -108,28 +116,41 @@ bool HasExtension(
 
 class GltfValidator {
  public:
-  void ValidateGltf(const Gltf& gltf, GltfLogger* logger) {
-    gltf_ = &gltf;
-    logger_ = logger;
-    ValidateField("asset", gltf.asset);
-    ValidateIdField("scene", gltf.scenes.size(), gltf.scene);
+  GltfValidator(const Gltf& gltf, GltfLogger* logger)
+      : gltf_(&gltf), logger_(logger) {}
+
+  // Validate fields outside the top-level element arrays.
+  void ValidateHeader() {
+    ValidateField("asset", gltf_->asset);
+    ValidateIdField("scene", gltf_->scenes.size(), gltf_->scene);
     ValidateExtensionsUsed();
     ValidateExtensionsRequired();
-    ValidateFieldArray("accessors", gltf.accessors);
-    ValidateFieldArray("animations", gltf.animations);
-    ValidateFieldArray("buffers", gltf.buffers);
-    ValidateFieldArray("bufferViews", gltf.bufferViews);
-    ValidateFieldArray("cameras", gltf.cameras);
-    ValidateFieldArray("images", gltf.images);
-    ValidateFieldArray("materials", gltf.materials);
-    ValidateFieldArray("meshes", gltf.meshes);
-    ValidateFieldArray("nodes", gltf.nodes);
-    ValidateFieldArray("samplers", gltf.samplers);
-    ValidateFieldArray("scenes", gltf.scenes);
-    ValidateFieldArray("skins", gltf.skins);
-    ValidateFieldArray("textures", gltf.textures);
-
-    CheckForNodeLoops();
+  }
+
+  // Validate elements [begin, end) of a top-level array.
+  template <typename Element>
+  void ValidateRange(const char* name, const std::vector<Element>& elements,
+                     size_t begin, size_t end) {
+    const GltfPathStack::Sentry path_sentry(&path_stack_, name);
+    for (size_t i = begin; i != end; ++i) {
+      const GltfPathStack::Sentry element_sentry(&path_stack_, i);
+      Validate(elements[i]);
+    }
+  }
+
+  void CheckForNodeLoops() {
+    const size_t node_count = gltf_->nodes.size();
+    std::vector<Id> visited_root_ids(node_count, Id::kNull);
+    std::vector<Id> node_path(node_count + 1);
+    for (size_t root_index = 0; root_index != node_count; ++root_index) {
+      if (visited_root_ids[root_index] != Id::kNull) {
+        continue;
+      }
+      const Id root_id = Gltf::IndexToId(root_index);
+      node_path[0] = root_id;
+      CheckForNodeLoopsAt(root_id, node_path.data(), node_path.data(),
+                          visited_root_ids.data());
+    }
   }
 
  private:
@@ -897,19 +918,393 @@ class GltfValidator {
       }
     }
   }
+};
 
-  void CheckForNodeLoops() {
-    const size_t node_count = gltf_->nodes.size();
-    std::vector<Id> visited_root_ids(node_count, Id::kNull);
-    std::vector<Id> node_path(node_count + 1);
-    for (size_t root_index = 0; root_index != node_count; ++root_index) {
-      if (visited_root_ids[root_index] != Id::kNull) {
+// Validation work that can run independently of other shards, logging to its
+// own logger.
+using Shard = std::function<void(GltfLogger* logger)>;
+
+// Maximum number of top-level elements structurally validated per shard.
+constexpr size_t kShardElementMax = 1024;
+
+// Maximum number of accessor components scanned per data validation shard.
+constexpr size_t kDataShardComponentMax = 1 << 20;
+
+// Relative tolerance used when comparing float data to declared min/max, to
+// allow for exporters writing bounds with limited precision.
+constexpr float kBoundsTolerance = 1.0e-4f;
+
+template <typename Element>
+void AddRangeShards(const Gltf& gltf, const char* name,
+                    const std::vector<Element>& elements,
+                    std::vector<Shard>* shards) {
+  const size_t count = elements.size();
+  for (size_t begin = 0; begin < count; begin += kShardElementMax) {
+    const size_t end = std::min(begin + kShardElementMax, count);
+    shards->push_back([&gltf, name, &elements, begin, end](GltfLogger* logger) {
+      GltfValidator(gltf, logger).ValidateRange(name, elements, begin, end);
+    });
+  }
+}
+
+// Run shards on up to thread_count threads, forwarding their messages to the
+// logger in shard order.
+void RunShards(const std::vector<Shard>& shards, size_t thread_count,
+               GltfLogger* logger) {
+  GltfSequencedLogger sequenced_logger(logger);
+  std::vector<GltfSequencedLogger::Task> tasks(shards.size());
+  for (GltfSequencedLogger::Task& task : tasks) {
+    sequenced_logger.Begin(&task);
+  }
+  std::atomic<size_t> next_index(0);
+  const auto run = [&]() {
+    for (;;) {
+      const size_t index = next_index++;
+      if (index >= shards.size()) {
+        break;
+      }
+      shards[index](&tasks[index]);
+      sequenced_logger.End(&tasks[index]);
+    }
+  };
+  if (thread_count == 0) {
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+  thread_count = std::min(thread_count, shards.size());
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < thread_count; ++i) {
+    threads.emplace_back(run);
+  }
+  run();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+// Buffer contents read for data validation.
+struct BufferData {
+  const uint8_t* data = nullptr;
+  size_t size = 0;
+};
+
+// Per-component range of accessor values, excluding non-finite values.
+template <typename T>
+struct ValueRange {
+  T min[Accessor::kComponentMax];
+  T max[Accessor::kComponentMax];
+  size_t non_finite_count = 0;
+  size_t first_non_finite = 0;
+};
+
+template <typename T>
+bool IsNonFinite(T value) {
+  return false;
+}
+
+bool IsNonFinite(float value) {
+  return !std::isfinite(value);
+}
+
+template <typename T>
+void ScanValues(const uint8_t* data, size_t stride, size_t count,
+                size_t component_count, ValueRange<T>* out) {
+  for (size_t c = 0; c != component_count; ++c) {
+    out->min[c] = std::numeric_limits<T>::max();
+    out->max[c] = std::numeric_limits<T>::lowest();
+  }
+  for (size_t i = 0; i != count; ++i, data += stride) {
+    for (size_t c = 0; c != component_count; ++c) {
+      // Buffer data isn't necessarily aligned, so copy rather than cast.
+      T value;
+      memcpy(&value, data + c * sizeof(T), sizeof(T));
+      if (IsNonFinite(value)) {
+        if (out->non_finite_count++ == 0) {
+          out->first_non_finite = i;
+        }
         continue;
       }
-      const Id root_id = Gltf::IndexToId(root_index);
-      node_path[0] = root_id;
-      CheckForNodeLoopsAt(root_id, node_path.data(), node_path.data(),
-                          visited_root_ids.data());
+      out->min[c] = std::min(out->min[c], value);
+      out->max[c] = std::max(out->max[c], value);
+    }
+  }
+}
+
+template <typename T>
+T GetBound(const Accessor::Value& value, size_t component) {
+  if (std::is_floating_point<T>::value) {
+    return static_cast<T>(value.f[component]);
+  } else if (std::is_signed<T>::value) {
+    return static_cast<T>(value.i[component]);
+  } else {
+    return static_cast<T>(value.u[component]);
+  }
+}
+
+template <typename T>
+bool IsOutsideBounds(T min, T max, T bound_min, T bound_max) {
+  return min < bound_min || max > bound_max;
+}
+
+bool IsOutsideBounds(float min, float max, float bound_min, float bound_max) {
+  const float min_tolerance =
+      kBoundsTolerance * std::max(1.0f, std::fabs(bound_min));
+  const float max_tolerance =
+      kBoundsTolerance * std::max(1.0f, std::fabs(bound_max));
+  return min < bound_min - min_tolerance || max > bound_max + max_tolerance;
+}
+
+class GltfDataValidator {
+ public:
+  GltfDataValidator(const Gltf& gltf, const std::vector<BufferData>& buffers,
+                    GltfLogger* logger)
+      : gltf_(&gltf), buffers_(&buffers), logger_(logger) {}
+
+  // Verify buffers and views fit the data actually read.
+  void ValidateBuffers() {
+    {
+      const GltfPathStack::Sentry path_sentry(&path_stack_, "buffers");
+      for (size_t i = 0; i != gltf_->buffers.size(); ++i) {
+        const GltfPathStack::Sentry element_sentry(&path_stack_, i);
+        const size_t byte_length = gltf_->buffers[i].byteLength;
+        const size_t size = (*buffers_)[i].size;
+        if (size < byte_length) {
+          Log<GLTF_ERROR_BUFFER_DATA_SHORT>(size, byte_length);
+        }
+      }
+    }
+    const GltfPathStack::Sentry path_sentry(&path_stack_, "bufferViews");
+    for (size_t i = 0; i != gltf_->bufferViews.size(); ++i) {
+      const GltfPathStack::Sentry element_sentry(&path_stack_, i);
+      const BufferView& view = gltf_->bufferViews[i];
+      const Buffer* const buffer = Gltf::GetById(gltf_->buffers, view.buffer);
+      if (!buffer) {
+        continue;
+      }
+      // Views exceeding the declared buffer size are reported by GltfValidate.
+      const size_t begin = view.byteOffset;
+      const size_t end = begin + view.byteLength;
+      const size_t size = (*buffers_)[Gltf::IdToIndex(view.buffer)].size;
+      if (end > size && end <= buffer->byteLength) {
+        Log<GLTF_ERROR_VIEW_OUTSIDE_BUFFER_DATA>(begin, end, size);
+      }
+    }
+  }
+
+  // Scan accessors [begin, end), storing the largest value of unsigned scalar
+  // accessors (for index range checks) in index_maxes.
+  void ValidateAccessors(size_t begin, size_t end, uint32_t* index_maxes) {
+    const GltfPathStack::Sentry path_sentry(&path_stack_, "accessors");
+    for (size_t i = begin; i != end; ++i) {
+      const GltfPathStack::Sentry element_sentry(&path_stack_, i);
+      ValidateAccessor(gltf_->accessors[i], &index_maxes[i]);
+    }
+  }
+
+  // Verify primitive indices are within the vertex count.
+  void ValidateIndices(const std::vector<uint32_t>& index_maxes) {
+    const GltfPathStack::Sentry path_sentry(&path_stack_, "meshes");
+    for (size_t mesh_index = 0; mesh_index != gltf_->meshes.size();
+         ++mesh_index) {
+      const GltfPathStack::Sentry mesh_sentry(&path_stack_, mesh_index);
+      const Mesh& mesh = gltf_->meshes[mesh_index];
+      const GltfPathStack::Sentry prims_sentry(&path_stack_, "primitives");
+      for (size_t prim_index = 0; prim_index != mesh.primitives.size();
+           ++prim_index) {
+        const Mesh::Primitive& prim = mesh.primitives[prim_index];
+        const Accessor* const indices =
+            Gltf::GetById(gltf_->accessors, prim.indices);
+        const auto pos_found =
+            prim.attributes.find(Mesh::kAttributePosition);
+        if (!indices || indices->count == 0 ||
+            prim.draco.bufferView != Id::kNull ||
+            pos_found == prim.attributes.end()) {
+          continue;
+        }
+        const Accessor* const pos =
+            Gltf::GetById(gltf_->accessors, pos_found->accessor);
+        const uint32_t index_max = index_maxes[Gltf::IdToIndex(prim.indices)];
+        if (pos && index_max >= pos->count) {
+          const GltfPathStack::Sentry prim_sentry(&path_stack_, prim_index);
+          const GltfPathStack::Sentry indices_sentry(&path_stack_, "indices");
+          Log<GLTF_ERROR_INDEX_OUT_OF_RANGE>(index_max, pos->count);
+        }
+      }
+    }
+  }
+
+ private:
+  const Gltf* gltf_;
+  const std::vector<BufferData>* buffers_;
+  GltfLogger* logger_;
+  GltfPathStack path_stack_;
+
+  template <GltfWhat kWhat, typename ...Ts>
+  void Log(Ts... args) {
+    const std::string path = path_stack_.GetPath();
+    GltfLog<kWhat>(logger_, path.c_str(), args...);
+  }
+
+  // Get data for count elements in a buffer view, or null if it's empty or
+  // doesn't fit in the buffer (which is reported elsewhere).
+  const uint8_t* GetElementData(Id view_id, size_t offset,
+                                size_t element_size, size_t count,
+                                size_t* out_stride) const {
+    const BufferView* const view = Gltf::GetById(gltf_->bufferViews, view_id);
+    if (!view || element_size == 0 || count == 0) {
+      return nullptr;
+    }
+    const size_t buffer_index = Gltf::IdToIndex(view->buffer);
+    if (buffer_index >= buffers_->size()) {
+      return nullptr;
+    }
+    const BufferData& buffer = (*buffers_)[buffer_index];
+    const size_t stride = view->byteStride ? view->byteStride : element_size;
+    const size_t begin = static_cast<size_t>(view->byteOffset) + offset;
+    const size_t size = (count - 1) * stride + element_size;
+    if (!buffer.data || stride < element_size || begin + size > buffer.size) {
+      return nullptr;
+    }
+    *out_stride = stride;
+    return buffer.data + begin;
+  }
+
+  template <typename T>
+  void ValidateValues(const Accessor& accessor, const uint8_t* data,
+                      size_t stride, size_t count, bool check_bounds,
+                      uint32_t* out_index_max) {
+    const size_t component_count = Gltf::GetComponentCount(accessor.type);
+    ValueRange<T> range;
+    ScanValues(data, stride, count, component_count, &range);
+    if (range.non_finite_count != 0) {
+      Log<GLTF_ERROR_ACCESSOR_NON_FINITE>(
+          range.non_finite_count, range.first_non_finite);
+    }
+    if (accessor.has_min_max && check_bounds) {
+      for (size_t c = 0; c != component_count; ++c) {
+        const T bound_min = GetBound<T>(accessor.min, c);
+        const T bound_max = GetBound<T>(accessor.max, c);
+        if (range.min[c] <= range.max[c] &&
+            IsOutsideBounds(range.min[c], range.max[c], bound_min, bound_max)) {
+          Log<GLTF_WARN_ACCESSOR_OUTSIDE_BOUNDS>(
+              c, static_cast<float>(range.min[c]),
+              static_cast<float>(range.max[c]), static_cast<float>(bound_min),
+              static_cast<float>(bound_max));
+        }
+      }
+    }
+    if (out_index_max && component_count == 1 &&
+        std::is_unsigned<T>::value) {
+      *out_index_max = static_cast<uint32_t>(range.max[0]);
+    }
+  }
+
+  void ValidateValues(const Accessor& accessor, const uint8_t* data,
+                      size_t stride, size_t count, bool check_bounds,
+                      uint32_t* out_index_max) {
+    switch (accessor.componentType) {
+    case Accessor::kComponentByte:
+      ValidateValues<int8_t>(accessor, data, stride, count, check_bounds,
+                             out_index_max);
+      break;
+    case Accessor::kComponentUnsignedByte:
+      ValidateValues<uint8_t>(accessor, data, stride, count, check_bounds,
+                              out_index_max);
+      break;
+    case Accessor::kComponentShort:
+      ValidateValues<int16_t>(accessor, data, stride, count, check_bounds,
+                              out_index_max);
+      break;
+    case Accessor::kComponentUnsignedShort:
+      ValidateValues<uint16_t>(accessor, data, stride, count, check_bounds,
+                               out_index_max);
+      break;
+    case Accessor::kComponentUnsignedInt:
+      ValidateValues<uint32_t>(accessor, data, stride, count, check_bounds,
+                               out_index_max);
+      break;
+    case Accessor::kComponentFloat:
+      ValidateValues<float>(accessor, data, stride, count, check_bounds,
+                            out_index_max);
+      break;
+    default:
+      break;
+    }
+  }
+
+  void ValidateSparse(const Accessor& accessor,
+                      const Accessor::Sparse& sparse) {
+    const GltfPathStack::Sentry path_sentry(&path_stack_, "sparse");
+    const size_t component_size =
+        Gltf::GetComponentSize(accessor.componentType);
+    const size_t component_count = Gltf::GetComponentCount(accessor.type);
+
+    // Verify indices reference elements within the accessor.
+    size_t indices_stride;
+    const uint8_t* const indices = GetElementData(
+        sparse.indices.bufferView, sparse.indices.byteOffset,
+        Gltf::GetComponentSize(sparse.indices.componentType), sparse.count,
+        &indices_stride);
+    if (indices) {
+      uint32_t index_max = 0;
+      switch (sparse.indices.componentType) {
+      case Accessor::kComponentUnsignedByte: {
+        ValueRange<uint8_t> range;
+        ScanValues(indices, indices_stride, sparse.count, 1, &range);
+        index_max = range.max[0];
+        break;
+      }
+      case Accessor::kComponentUnsignedShort: {
+        ValueRange<uint16_t> range;
+        ScanValues(indices, indices_stride, sparse.count, 1, &range);
+        index_max = range.max[0];
+        break;
+      }
+      case Accessor::kComponentUnsignedInt: {
+        ValueRange<uint32_t> range;
+        ScanValues(indices, indices_stride, sparse.count, 1, &range);
+        index_max = range.max[0];
+        break;
+      }
+      default:
+        // Bad sparse index format is reported by GltfLoad.
+        break;
+      }
+      if (index_max >= accessor.count) {
+        const GltfPathStack::Sentry indices_sentry(&path_stack_, "indices");
+        Log<GLTF_ERROR_SPARSE_INDEX_OUT_OF_RANGE>(index_max, accessor.count);
+      }
+    }
+
+    // Check substituted values, which are tightly packed.
+    size_t values_stride;
+    const uint8_t* const values = GetElementData(
+        sparse.values.bufferView, sparse.values.byteOffset,
+        component_size * component_count, sparse.count, &values_stride);
+    if (values) {
+      const GltfPathStack::Sentry values_sentry(&path_stack_, "values");
+      ValidateValues(accessor, values, component_size * component_count,
+                     sparse.count, false, nullptr);
+    }
+  }
+
+  void ValidateAccessor(const Accessor& accessor, uint32_t* out_index_max) {
+    const bool is_sparse = accessor.sparse.count != 0;
+    if (is_sparse) {
+      ValidateSparse(accessor, accessor.sparse);
+    }
+
+    // Accessors without a view are zero-filled (or Draco-compressed).
+    // * Bounds and index ranges of sparse accessors depend on substituted
+    //   values, so they're only checked for non-finite values.
+    const size_t element_size = Gltf::GetComponentSize(accessor.componentType) *
+                                Gltf::GetComponentCount(accessor.type);
+    size_t stride;
+    const uint8_t* const data =
+        GetElementData(accessor.bufferView, accessor.byteOffset, element_size,
+                       accessor.count, &stride);
+    if (data) {
+      ValidateValues(accessor, data, stride, accessor.count, !is_sparse,
+                     is_sparse ? nullptr : out_index_max);
     }
   }
 };
@@ -952,10 +1347,71 @@ bool VerifyResourcesExist(
 }
 }  // namespace
 
-bool GltfValidate(const Gltf& gltf, GltfLogger* logger) {
+bool GltfValidate(const Gltf& gltf, GltfLogger* logger, size_t thread_count) {
+  const size_t old_error_count = logger->GetErrorCount();
+  std::vector<Shard> shards;
+  shards.push_back([&gltf](GltfLogger* shard_logger) {
+    GltfValidator(gltf, shard_logger).ValidateHeader();
+  });
+  AddRangeShards(gltf, "accessors", gltf.accessors, &shards);
+  AddRangeShards(gltf, "animations", gltf.animations, &shards);
+  AddRangeShards(gltf, "buffers", gltf.buffers, &shards);
+  AddRangeShards(gltf, "bufferViews", gltf.bufferViews, &shards);
+  AddRangeShards(gltf, "cameras", gltf.cameras, &shards);
+  AddRangeShards(gltf, "images", gltf.images, &shards);
+  AddRangeShards(gltf, "materials", gltf.materials, &shards);
+  AddRangeShards(gltf, "meshes", gltf.meshes, &shards);
+  AddRangeShards(gltf, "nodes", gltf.nodes, &shards);
+  AddRangeShards(gltf, "samplers", gltf.samplers, &shards);
+  AddRangeShards(gltf, "scenes", gltf.scenes, &shards);
+  AddRangeShards(gltf, "skins", gltf.skins, &shards);
+  AddRangeShards(gltf, "textures", gltf.textures, &shards);
+  shards.push_back([&gltf](GltfLogger* shard_logger) {
+    GltfValidator(gltf, shard_logger).CheckForNodeLoops();
+  });
+  RunShards(shards, thread_count, logger);
+  const size_t new_error_count = logger->GetErrorCount();
+  return new_error_count == old_error_count;
+}
+
+bool GltfValidateData(const Gltf& gltf, GltfStream* gltf_stream,
+                      GltfLogger* logger, size_t thread_count) {
   const size_t old_error_count = logger->GetErrorCount();
-  GltfValidator validator;
-  validator.ValidateGltf(gltf, logger);
+
+  // Read all buffers up-front, so shards only read memory.
+  GltfCache cache(&gltf, gltf_stream);
+  std::vector<BufferData> buffers(gltf.buffers.size());
+  for (size_t i = 0; i != buffers.size(); ++i) {
+    buffers[i].data = cache.GetBufferData(Gltf::IndexToId(i), &buffers[i].size);
+  }
+  GltfDataValidator(gltf, buffers, logger).ValidateBuffers();
+
+  // Split accessors into shards of roughly equal data size.
+  const size_t accessor_count = gltf.accessors.size();
+  std::vector<uint32_t> index_maxes(accessor_count, 0);
+  std::vector<Shard> shards;
+  size_t begin = 0;
+  size_t component_total = 0;
+  for (size_t i = 0; i != accessor_count; ++i) {
+    const Accessor& accessor = gltf.accessors[i];
+    component_total +=
+        static_cast<size_t>(accessor.count) *
+        Gltf::GetComponentCount(accessor.type);
+    const size_t end = i + 1;
+    if (component_total >= kDataShardComponentMax ||
+        end - begin == kShardElementMax || end == accessor_count) {
+      shards.push_back([&gltf, &buffers, &index_maxes, begin, end](
+                           GltfLogger* shard_logger) {
+        GltfDataValidator(gltf, buffers, shard_logger)
+            .ValidateAccessors(begin, end, index_maxes.data());
+      });
+      begin = end;
+      component_total = 0;
+    }
+  }
+  RunShards(shards, thread_count, logger);
+
+  GltfDataValidator(gltf, buffers, logger).ValidateIndices(index_maxes);
   const size_t new_error_count = logger->GetErrorCount();
   return new_error_count == old_error_count;
 }
@@ -972,12 +1428,20 @@ bool GltfLoadAndValidate(
   if (!GltfLoad(*is, settings, &gltf, logger)) {
     return false;
   }
-  if (!GltfValidate(gltf, logger)) {
+  if (!GltfValidate(gltf, logger, settings.validate_thread_count)) {
     return false;
   }
+  if (settings.preload_resources) {
+    gltf_stream->PreloadResources(gltf);
+  }
   if (!VerifyResourcesExist(gltf_stream, gltf, logger)) {
     return false;
   }
+  if (settings.validate_data &&
+      !GltfValidateData(gltf, gltf_stream, logger,
+                        settings.validate_thread_count)) {
+    return false;
+  }
   gltf.Swap(out_gltf);
   return true;
 }
@@ -29,11 +29,28 @@
 //
 // Notable exceptions are:
 // 1) Any validation done earlier in GltfLoad is not repeated here.
-// 2) It does not perform inspection of binary resources (including Draco-
-//    compressed meshes).
+// 2) It does not perform inspection of binary resources (see
+//    GltfValidateData).
 // 3) Recoverable issues are treated as warnings rather than errors.
 // 4) Fields extraneous to conversion may be ignored.
-bool GltfValidate(const Gltf& gltf, GltfLogger* logger);
+//
+// Validation is split into shards (ranges of top-level array elements) run on
+// up to thread_count threads (0 for the hardware thread count). Messages are
+// forwarded in shard order, so they don't depend on the thread count.
+bool GltfValidate(const Gltf& gltf, GltfLogger* logger,
+                  size_t thread_count = 1);
+
+// Validate binary data referenced by the glTF, reading all buffers through the
+// stream. This checks that:
+// 1) Buffer views fit within the buffer data actually read.
+// 2) Float accessors don't contain NaN or infinite values.
+// 3) Accessor values are within their declared min/max (except for sparse
+//    accessors).
+// 4) Primitive indices and sparse indices are in range.
+// Draco-compressed data is not inspected. Accessors are checked in parallel
+// shards as with GltfValidate.
+bool GltfValidateData(const Gltf& gltf, GltfStream* gltf_stream,
+                      GltfLogger* logger, size_t thread_count = 1);
 
 bool GltfLoadAndValidate(
     GltfStream* gltf_stream, const char* name, const GltfLoadSettings& settings,
@@ -0,0 +1,892 @@
+/*
+ * Copyright 2019 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// Generates synthetic glTF/GLB scenes for scaling and stress benchmarks.
+//
+// Each scene dimension (node count and hierarchy shape, mesh count and vertex
+// count, instancing, skinning, animation, textures and Draco compression) is
+// controlled independently, so conversion time and memory can be charted as
+// one dimension scales while the others stay fixed.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "gltf/gltf.h"
+#include "gltf/save.h"
+
+#ifdef GLTF_GEN_DRACO
+#include "draco/compression/encode.h"
+#include "draco/mesh/mesh.h"
+#endif  // GLTF_GEN_DRACO
+
+namespace {
+using Id = Gltf::Id;
+using Accessor = Gltf::Accessor;
+using Animation = Gltf::Animation;
+using BufferView = Gltf::BufferView;
+using Mesh = Gltf::Mesh;
+using Node = Gltf::Node;
+
+const char kUsage[] =
+    "Usage: gltf_gen [options] <output .gltf/.glb path>\n"
+    "Options:\n"
+    "  --nodes <count>         Number of mesh nodes [default=1].\n"
+    "  --hierarchy <wide|deep> Place nodes under a single parent (wide) or in\n"
+    "                          a single parent-child chain (deep) "
+    "[default=wide].\n"
+    "  --meshes <count>        Number of unique meshes. Nodes reference "
+    "meshes\n"
+    "                          round-robin, so nodes > meshes instances them\n"
+    "                          [default=1].\n"
+    "  --vertices <count>      Vertices per mesh, rounded up to a square grid\n"
+    "                          [default=1024].\n"
+    "  --draco                 Compress meshes with "
+    "KHR_draco_mesh_compression.\n"
+    "  --joints <count>        Skin all meshes to a chain of joints "
+    "[default=0].\n"
+    "  --frames <count>        Animate joints (or nodes, if unskinned) with "
+    "this many\n"
+    "                          keyframes [default=0].\n"
+    "  --cubic                 Use CUBICSPLINE animation samplers instead of "
+    "LINEAR.\n"
+    "  --textures <count>      Number of unique textured materials "
+    "[default=0].\n"
+    "  --texture_size <size>   Texture width and height [default=256].\n"
+    "  --compact               Write JSON without indentation.\n";
+
+struct Options {
+  std::string out_path;
+  size_t node_count = 1;
+  bool deep = false;
+  size_t mesh_count = 1;
+  size_t vertex_count = 1024;
+  bool draco = false;
+  size_t joint_count = 0;
+  size_t frame_count = 0;
+  bool cubic = false;
+  size_t texture_count = 0;
+  size_t texture_size = 256;
+  GltfSaveSettings save_settings;
+};
+
+bool ParseCount(const char* name, const char* text, size_t min_value,
+                size_t* out_value) {
+  char* end = nullptr;
+  const unsigned long long value = strtoull(text, &end, 10);  // NOLINT
+  if (!*text || *end || value < min_value) {
+    fprintf(stderr, "ERROR: Invalid value for %s: %s\n", name, text);
+    return false;
+  }
+  *out_value = static_cast<size_t>(value);
+  return true;
+}
+
+bool ParseOptions(int argc, char* argv[], Options* options) {
+  for (int i = 1; i < argc; ++i) {
+    const char* const arg = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+      printf("%s", kUsage);
+      return false;
+    } else if (strcmp(arg, "--nodes") == 0 && has_value) {
+      if (!ParseCount(arg, argv[++i], 1, &options->node_count)) {
+        return false;
+      }
+    } else if (strcmp(arg, "--hierarchy") == 0 && has_value) {
+      const char* const shape = argv[++i];
+      if (strcmp(shape, "deep") == 0) {
+        options->deep = true;
+      } else if (strcmp(shape, "wide") == 0) {
+        options->deep = false;
+      } else {
+        fprintf(stderr, "ERROR: Unknown hierarchy: %s\n", shape);
+        return false;
+      }
+    } else if (strcmp(arg, "--meshes") == 0 && has_value) {
+      if (!ParseCount(arg, argv[++i], 1, &options->mesh_count)) {
+        return false;
+      }
+    } else if (strcmp(arg, "--vertices") == 0 && has_value) {
+      if (!ParseCount(arg, argv[++i], 3, &options->vertex_count)) {
+        return false;
+      }
+    } else if (strcmp(arg, "--draco") == 0) {
+      options->draco = true;
+    } else if (strcmp(arg, "--joints") == 0 && has_value) {
+      if (!ParseCount(arg, argv[++i], 0, &options->joint_count)) {
+        return false;
+      }
+    } else if (strcmp(arg, "--frames") == 0 && has_value) {
+      if (!ParseCount(arg, argv[++i], 0, &options->frame_count)) {
+        return false;
+      }
+    } else if (strcmp(arg, "--cubic") == 0) {
+      options->cubic = true;
+    } else if (strcmp(arg, "--textures") == 0 && has_value) {
+      if (!ParseCount(arg, argv[++i], 0, &options->texture_count)) {
+        return false;
+      }
+    } else if (strcmp(arg, "--texture_size") == 0 && has_value) {
+      if (!ParseCount(arg, argv[++i], 1, &options->texture_size)) {
+        return false;
+      }
+    } else if (strcmp(arg, "--compact") == 0) {
+      options->save_settings.pretty = false;
+    } else if (arg[0] == '-' && arg[1] == '-') {
+      fprintf(stderr, "ERROR: Unknown or incomplete option: %s\n", arg);
+      return false;
+    } else if (options->out_path.empty()) {
+      options->out_path = arg;
+    } else {
+      fprintf(stderr, "ERROR: Multiple output paths: %s\n", arg);
+      return false;
+    }
+  }
+  if (options->out_path.empty()) {
+    fprintf(stderr, "%s", kUsage);
+    return false;
+  }
+#ifndef GLTF_GEN_DRACO
+  if (options->draco) {
+    fprintf(stderr, "ERROR: gltf_gen was built without the Draco encoder.\n");
+    return false;
+  }
+#endif  // GLTF_GEN_DRACO
+  return true;
+}
+
+// Minimal PNG encoder using uncompressed (stored) deflate blocks, so the
+// generator doesn't depend on zlib. Image size is what matters for stress
+// inputs, not compression.
+class PngWriter {
+ public:
+  PngWriter() {
+    for (uint32_t n = 0; n != 256; ++n) {
+      uint32_t c = n;
+      for (int k = 0; k != 8; ++k) {
+        c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+      }
+      crc_table_[n] = c;
+    }
+  }
+
+  void Encode(size_t width, size_t height, const uint8_t* rgb,
+              std::vector<uint8_t>* out) const {
+    static const uint8_t kSignature[] = {
+        0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    out->assign(kSignature, kSignature + sizeof(kSignature));
+
+    std::vector<uint8_t> ihdr;
+    PutU32(static_cast<uint32_t>(width), &ihdr);
+    PutU32(static_cast<uint32_t>(height), &ihdr);
+    ihdr.push_back(8);  // Bit depth.
+    ihdr.push_back(2);  // Color type RGB.
+    ihdr.push_back(0);  // Compression.
+    ihdr.push_back(0);  // Filter.
+    ihdr.push_back(0);  // Interlace.
+    PutChunk("IHDR", ihdr, out);
+
+    // Each row is prefixed with filter type 0 (none).
+    const size_t row_size = 3 * width;
+    std::vector<uint8_t> raw;
+    raw.reserve((row_size + 1) * height);
+    for (size_t y = 0; y != height; ++y) {
+      raw.push_back(0);
+      const uint8_t* const row = rgb + y * row_size;
+      raw.insert(raw.end(), row, row + row_size);
+    }
+
+    // zlib stream of stored blocks, each at most 65535 bytes.
+    std::vector<uint8_t> idat = {0x78, 0x01};
+    const size_t kBlockMax = 0xffff;
+    size_t pos = 0;
+    do {
+      const size_t len = std::min(kBlockMax, raw.size() - pos);
+      const bool last = pos + len == raw.size();
+      idat.push_back(last ? 1 : 0);
+      idat.push_back(static_cast<uint8_t>(len));
+      idat.push_back(static_cast<uint8_t>(len >> 8));
+      idat.push_back(static_cast<uint8_t>(~len));
+      idat.push_back(static_cast<uint8_t>(~len >> 8));
+      idat.insert(idat.end(), raw.begin() + pos, raw.begin() + pos + len);
+      pos += len;
+    } while (pos != raw.size());
+    PutU32(Adler32(raw), &idat);
+    PutChunk("IDAT", idat, out);
+    PutChunk("IEND", std::vector<uint8_t>(), out);
+  }
+
+ private:
+  uint32_t crc_table_[256];
+
+  static void PutU32(uint32_t value, std::vector<uint8_t>* out) {
+    out->push_back(static_cast<uint8_t>(value >> 24));
+    out->push_back(static_cast<uint8_t>(value >> 16));
+    out->push_back(static_cast<uint8_t>(value >> 8));
+    out->push_back(static_cast<uint8_t>(value));
+  }
+
+  static uint32_t Adler32(const std::vector<uint8_t>& data) {
+    uint32_t a = 1, b = 0;
+    for (const uint8_t c : data) {
+      a = (a + c) % 65521;
+      b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+  }
+
+  void PutChunk(const char* type, const std::vector<uint8_t>& data,
+                std::vector<uint8_t>* out) const {
+    PutU32(static_cast<uint32_t>(data.size()), out);
+    const size_t crc_begin = out->size();
+    out->insert(out->end(), type, type + 4);
+    out->insert(out->end(), data.begin(), data.end());
+    uint32_t crc = 0xffffffffu;
+    for (size_t i = crc_begin; i != out->size(); ++i) {
+      crc = crc_table_[(crc ^ (*out)[i]) & 0xff] ^ (crc >> 8);
+    }
+    PutU32(crc ^ 0xffffffffu, out);
+  }
+};
+
+// Vertex data for a single grid mesh, spanning x=[-0.5, 0.5], y=[0, 1].
+struct GridMesh {
+  size_t vert_count = 0;
+  std::vector<float> pos;
+  std::vector<float> norm;
+  std::vector<float> uv;
+  std::vector<uint16_t> joints;
+  std::vector<float> weights;
+  std::vector<uint32_t> indices;
+  float pos_min[3];
+  float pos_max[3];
+};
+
+void BuildGridMesh(size_t vertex_count, size_t mesh_index, size_t joint_count,
+                   GridMesh* out) {
+  size_t side = static_cast<size_t>(ceil(sqrt(static_cast<double>(
+      vertex_count))));
+  side = std::max(side, static_cast<size_t>(2));
+  const size_t vert_count = side * side;
+  out->vert_count = vert_count;
+  out->pos.resize(3 * vert_count);
+  out->norm.resize(3 * vert_count);
+  out->uv.resize(2 * vert_count);
+
+  // Vary depth per mesh so meshes aren't identical.
+  const float depth = 0.25f * static_cast<float>(mesh_index % 8) / 8.0f;
+  const float step = 1.0f / static_cast<float>(side - 1);
+  for (size_t y = 0; y != side; ++y) {
+    for (size_t x = 0; x != side; ++x) {
+      const size_t vi = y * side + x;
+      const float u = x * step;
+      const float v = y * step;
+      float* const pos = &out->pos[3 * vi];
+      pos[0] = u - 0.5f;
+      pos[1] = v;
+      pos[2] = depth;
+      float* const norm = &out->norm[3 * vi];
+      norm[0] = 0.0f;
+      norm[1] = 0.0f;
+      norm[2] = 1.0f;
+      out->uv[2 * vi + 0] = u;
+      out->uv[2 * vi + 1] = 1.0f - v;
+    }
+  }
+  out->pos_min[0] = -0.5f;
+  out->pos_min[1] = 0.0f;
+  out->pos_min[2] = depth;
+  out->pos_max[0] = 0.5f;
+  out->pos_max[1] = 1.0f;
+  out->pos_max[2] = depth;
+
+  // Bind each vertex to the joint spanning its height.
+  if (joint_count > 0) {
+    out->joints.assign(4 * vert_count, 0);
+    out->weights.assign(4 * vert_count, 0.0f);
+    for (size_t vi = 0; vi != vert_count; ++vi) {
+      const float v = out->pos[3 * vi + 1];
+      const size_t joint = std::min(
+          static_cast<size_t>(v * joint_count), joint_count - 1);
+      out->joints[4 * vi] = static_cast<uint16_t>(joint);
+      out->weights[4 * vi] = 1.0f;
+    }
+  }
+
+  out->indices.reserve(6 * (side - 1) * (side - 1));
+  for (size_t y = 0; y + 1 < side; ++y) {
+    for (size_t x = 0; x + 1 < side; ++x) {
+      const uint32_t i00 = static_cast<uint32_t>(y * side + x);
+      const uint32_t i10 = i00 + 1;
+      const uint32_t i01 = i00 + static_cast<uint32_t>(side);
+      const uint32_t i11 = i01 + 1;
+      out->indices.insert(out->indices.end(), {i00, i10, i11});
+      out->indices.insert(out->indices.end(), {i00, i11, i01});
+    }
+  }
+}
+
+class Generator {
+ public:
+  explicit Generator(const Options& options) : options_(options) {}
+
+  bool Generate();
+  bool Write() const;
+
+ private:
+  struct ImageFile {
+    std::string path;
+    std::vector<uint8_t> data;
+  };
+
+  const Options& options_;
+  bool is_glb_ = false;
+  std::string out_dir_;
+  std::string out_stem_;
+  Gltf gltf_;
+  std::vector<uint8_t> bin_;
+  std::vector<ImageFile> image_files_;
+
+  static Id LastId(size_t count) { return Gltf::IndexToId(count - 1); }
+
+  Id AddView(const void* data, size_t size, BufferView::Target target) {
+    bin_.resize((bin_.size() + 3) & ~size_t(3), 0);
+    BufferView view;
+    view.buffer = Gltf::IndexToId(0);
+    view.byteOffset = static_cast<uint32_t>(bin_.size());
+    view.byteLength = static_cast<uint32_t>(size);
+    view.target = target;
+    const uint8_t* const bytes = static_cast<const uint8_t*>(data);
+    bin_.insert(bin_.end(), bytes, bytes + size);
+    gltf_.bufferViews.push_back(view);
+    return LastId(gltf_.bufferViews.size());
+  }
+
+  template <typename T>
+  Id AddView(const std::vector<T>& values, BufferView::Target target) {
+    return AddView(values.data(), values.size() * sizeof(T), target);
+  }
+
+  Id AddAccessor(Id view, Accessor::ComponentType component_type,
+                 Accessor::Type type, size_t count) {
+    Accessor accessor;
+    accessor.bufferView = view;
+    accessor.componentType = component_type;
+    accessor.type = type;
+    accessor.count = static_cast<uint32_t>(count);
+    gltf_.accessors.push_back(accessor);
+    return LastId(gltf_.accessors.size());
+  }
+
+  void AddTextures();
+  bool AddMesh(size_t mesh_index);
+  void AddPrimitive(const GridMesh& grid, Mesh::Primitive* prim);
+#ifdef GLTF_GEN_DRACO
+  bool AddDracoPrimitive(const GridMesh& grid, Mesh::Primitive* prim);
+#endif  // GLTF_GEN_DRACO
+  void AddNodes();
+  void AddSkin();
+  void AddAnimation();
+  bool CheckLimits() const;
+};
+
+bool Generator::Generate() {
+  const std::string& path = options_.out_path;
+  is_glb_ = Gltf::StringEndsWithCI(path.c_str(), ".glb");
+  Gltf::SplitPath(path, &out_dir_, &out_stem_);
+  const size_t ext_pos = out_stem_.find_last_of('.');
+  if (ext_pos != std::string::npos) {
+    out_stem_.resize(ext_pos);
+  }
+
+  // Ids are limited to the range below Id::kNull.
+  const size_t id_max = Gltf::IdToIndex(Id::kNull);
+  if (1 + options_.node_count + options_.joint_count > id_max ||
+      options_.mesh_count > id_max || options_.texture_count > id_max) {
+    fprintf(stderr, "ERROR: Too many nodes, meshes, or textures (max=%zu).\n",
+            id_max);
+    return false;
+  }
+  // JOINTS_0 is written as unsigned shorts.
+  if (options_.joint_count > 0xffff) {
+    fprintf(stderr, "ERROR: Too many joints (max=%d).\n", 0xffff);
+    return false;
+  }
+
+  gltf_.asset.version = "2.0";
+  gltf_.asset.generator = "gltf_gen";
+  if (options_.draco) {
+    gltf_.extensionsUsed.push_back(Gltf::kExtensionDraco);
+    gltf_.extensionsRequired.push_back(Gltf::kExtensionDraco);
+  }
+  gltf_.buffers.resize(1);
+  Gltf::Buffer& buffer = gltf_.buffers[0];
+  buffer.uri.data_type = Gltf::Uri::kDataTypeNone;
+  if (!is_glb_) {
+    buffer.uri.path = out_stem_ + ".bin";
+  }
+
+  AddTextures();
+  for (size_t i = 0; i != options_.mesh_count; ++i) {
+    if (!AddMesh(i) || !CheckLimits()) {
+      return false;
+    }
+  }
+  AddNodes();
+  if (options_.joint_count > 0) {
+    AddSkin();
+  }
+  if (options_.frame_count > 0) {
+    AddAnimation();
+  }
+  if (!CheckLimits()) {
+    return false;
+  }
+  if (bin_.size() > 0xffffffffu) {
+    fprintf(stderr, "ERROR: Buffer exceeds 4GiB.\n");
+    return false;
+  }
+  gltf_.buffers[0].byteLength = static_cast<uint32_t>(bin_.size());
+  return true;
+}
+
+void Generator::AddTextures() {
+  const size_t texture_count = options_.texture_count;
+  if (texture_count == 0) {
+    gltf_.materials.resize(1);
+    gltf_.materials[0].name = "material0";
+    return;
+  }
+
+  gltf_.samplers.resize(1);
+  gltf_.samplers[0].magFilter = Gltf::Sampler::kMagFilterLinear;
+  gltf_.samplers[0].minFilter = Gltf::Sampler::kMinFilterLinearMipmapLinear;
+
+  // Checkerboards with a distinct tint per texture.
+  const PngWriter png_writer;
+  const size_t size = options_.texture_size;
+  const size_t cell = std::max(size / 8, static_cast<size_t>(1));
+  std::vector<uint8_t> rgb(3 * size * size);
+  std::vector<uint8_t> png;
+  for (size_t ti = 0; ti != texture_count; ++ti) {
+    const uint8_t tint[3] = {
+        static_cast<uint8_t>(64 + (ti * 37) % 192),
+        static_cast<uint8_t>(64 + (ti * 71) % 192),
+        static_cast<uint8_t>(64 + (ti * 113) % 192)};
+    for (size_t y = 0; y != size; ++y) {
+      for (size_t x = 0; x != size; ++x) {
+        const bool on = ((x / cell) + (y / cell)) % 2 == 0;
+        uint8_t* const p = &rgb[3 * (y * size + x)];
+        for (size_t c = 0; c != 3; ++c) {
+          p[c] = on ? tint[c] : static_cast<uint8_t>(tint[c] / 4);
+        }
+      }
+    }
+    png_writer.Encode(size, size, rgb.data(), &png);
+
+    const std::string name = "texture" + std::to_string(ti);
+    Gltf::Image image;
+    image.name = name;
+    image.uri.data_type = Gltf::Uri::kDataTypeNone;
+    image.mimeType = Gltf::Image::kMimePng;
+    if (is_glb_) {
+      image.bufferView = AddView(png, BufferView::kTargetUnset);
+    } else {
+      image.uri.path = out_stem_ + "_" + name + ".png";
+      image_files_.push_back({Gltf::JoinPath(out_dir_, image.uri.path), png});
+    }
+    gltf_.images.push_back(image);
+
+    Gltf::Texture texture;
+    texture.name = name;
+    texture.sampler = Gltf::IndexToId(0);
+    texture.source = LastId(gltf_.images.size());
+    gltf_.textures.push_back(texture);
+
+    Gltf::Material material;
+    material.name = "material" + std::to_string(ti);
+    material.pbr.baseColorTexture.index = LastId(gltf_.textures.size());
+    material.pbr.metallicFactor = 0.0f;
+    gltf_.materials.push_back(material);
+  }
+}
+
+bool Generator::AddMesh(size_t mesh_index) {
+  GridMesh grid;
+  BuildGridMesh(options_.vertex_count, mesh_index, options_.joint_count,
+                &grid);
+
+  Mesh mesh;
+  mesh.name = "mesh" + std::to_string(mesh_index);
+  mesh.primitives.resize(1);
+  Mesh::Primitive& prim = mesh.primitives[0];
+  prim.material = Gltf::IndexToId(mesh_index % gltf_.materials.size());
+#ifdef GLTF_GEN_DRACO
+  if (options_.draco) {
+    if (!AddDracoPrimitive(grid, &prim)) {
+      return false;
+    }
+  } else {
+    AddPrimitive(grid, &prim);
+  }
+#else  // GLTF_GEN_DRACO
+  AddPrimitive(grid, &prim);
+#endif  // GLTF_GEN_DRACO
+  gltf_.meshes.push_back(std::move(mesh));
+  return true;
+}
+
+void Generator::AddPrimitive(const GridMesh& grid, Mesh::Primitive* prim) {
+  const size_t vert_count = grid.vert_count;
+  const Id pos_id = AddAccessor(
+      AddView(grid.pos, BufferView::kTargetArrayBuffer),
+      Accessor::kComponentFloat, Accessor::kTypeVec3, vert_count);
+  Accessor& pos = gltf_.accessors.back();
+  pos.has_min_max = true;
+  std::copy(grid.pos_min, grid.pos_min + 3, pos.min.f);
+  std::copy(grid.pos_max, grid.pos_max + 3, pos.max.f);
+  prim->attributes.insert(
+      Mesh::Attribute(Mesh::kSemanticPosition, 0, pos_id));
+  prim->attributes.insert(Mesh::Attribute(
+      Mesh::kSemanticNormal, 0,
+      AddAccessor(AddView(grid.norm, BufferView::kTargetArrayBuffer),
+                  Accessor::kComponentFloat, Accessor::kTypeVec3,
+                  vert_count)));
+  prim->attributes.insert(Mesh::Attribute(
+      Mesh::kSemanticTexcoord, 0,
+      AddAccessor(AddView(grid.uv, BufferView::kTargetArrayBuffer),
+                  Accessor::kComponentFloat, Accessor::kTypeVec2,
+                  vert_count)));
+  if (!grid.joints.empty()) {
+    prim->attributes.insert(Mesh::Attribute(
+        Mesh::kSemanticJoints, 0,
+        AddAccessor(AddView(grid.joints, BufferView::kTargetArrayBuffer),
+                    Accessor::kComponentUnsignedShort, Accessor::kTypeVec4,
+                    vert_count)));
+    prim->attributes.insert(Mesh::Attribute(
+        Mesh::kSemanticWeights, 0,
+        AddAccessor(AddView(grid.weights, BufferView::kTargetArrayBuffer),
+                    Accessor::kComponentFloat, Accessor::kTypeVec4,
+                    vert_count)));
+  }
+
+  // Use 16-bit indices where possible, as most exporters do.
+  if (vert_count <= 0xffff) {
+    const std::vector<uint16_t> indices16(
+        grid.indices.begin(), grid.indices.end());
+    prim->indices = AddAccessor(
+        AddView(indices16, BufferView::kTargetElementArrayBuffer),
+        Accessor::kComponentUnsignedShort, Accessor::kTypeScalar,
+        indices16.size());
+  } else {
+    prim->indices = AddAccessor(
+        AddView(grid.indices, BufferView::kTargetElementArrayBuffer),
+        Accessor::kComponentUnsignedInt, Accessor::kTypeScalar,
+        grid.indices.size());
+  }
+}
+
+#ifdef GLTF_GEN_DRACO
+bool Generator::AddDracoPrimitive(const GridMesh& grid,
+                                  Mesh::Primitive* prim) {
+  const size_t vert_count = grid.vert_count;
+  draco::Mesh draco_mesh;
+  draco_mesh.set_num_points(static_cast<uint32_t>(vert_count));
+
+  // Add a Draco attribute, plus the glTF accessor describing its decoded
+  // form. Accessors for Draco-compressed data have no bufferView.
+  const auto add_attribute = [&](
+      Mesh::Semantic semantic, draco::GeometryAttribute::Type draco_type,
+      draco::DataType data_type, size_t component_count, size_t value_size,
+      const void* values, Accessor::ComponentType component_type,
+      Accessor::Type type) {
+    draco::GeometryAttribute attr;
+    attr.Init(draco_type, nullptr, static_cast<int8_t>(component_count),
+              data_type, false,
+              static_cast<int64_t>(component_count * value_size), 0);
+    const int attr_id = draco_mesh.AddAttribute(
+        attr, true, static_cast<uint32_t>(vert_count));
+    draco::PointAttribute* const point_attr = draco_mesh.attribute(attr_id);
+    const uint8_t* const bytes = static_cast<const uint8_t*>(values);
+    for (size_t vi = 0; vi != vert_count; ++vi) {
+      point_attr->SetAttributeValue(
+          draco::AttributeValueIndex(static_cast<uint32_t>(vi)),
+          bytes + vi * component_count * value_size);
+    }
+    const Id accessor_id =
+        AddAccessor(Id::kNull, component_type, type, vert_count);
+    prim->attributes.insert(Mesh::Attribute(semantic, 0, accessor_id));
+    prim->draco.attributes.insert(Mesh::Attribute(
+        semantic, 0, Gltf::IndexToId(point_attr->unique_id())));
+    return accessor_id;
+  };
+
+  const Id pos_id = add_attribute(
+      Mesh::kSemanticPosition, draco::GeometryAttribute::POSITION,
+      draco::DT_FLOAT32, 3, sizeof(float), grid.pos.data(),
+      Accessor::kComponentFloat, Accessor::kTypeVec3);
+  Accessor& pos = *Gltf::GetById(gltf_.accessors, pos_id);
+  pos.has_min_max = true;
+  std::copy(grid.pos_min, grid.pos_min + 3, pos.min.f);
+  std::copy(grid.pos_max, grid.pos_max + 3, pos.max.f);
+  add_attribute(
+      Mesh::kSemanticNormal, draco::GeometryAttribute::NORMAL,
+      draco::DT_FLOAT32, 3, sizeof(float), grid.norm.data(),
+      Accessor::kComponentFloat, Accessor::kTypeVec3);
+  add_attribute(
+      Mesh::kSemanticTexcoord, draco::GeometryAttribute::TEX_COORD,
+      draco::DT_FLOAT32, 2, sizeof(float), grid.uv.data(),
+      Accessor::kComponentFloat, Accessor::kTypeVec2);
+  if (!grid.joints.empty()) {
+    add_attribute(
+        Mesh::kSemanticJoints, draco::GeometryAttribute::GENERIC,
+        draco::DT_UINT16, 4, sizeof(uint16_t), grid.joints.data(),
+        Accessor::kComponentUnsignedShort, Accessor::kTypeVec4);
+    add_attribute(
+        Mesh::kSemanticWeights, draco::GeometryAttribute::GENERIC,
+        draco::DT_FLOAT32, 4, sizeof(float), grid.weights.data(),
+        Accessor::kComponentFloat, Accessor::kTypeVec4);
+  }
+
+  const size_t tri_count = grid.indices.size() / 3;
+  for (size_t ti = 0; ti != tri_count; ++ti) {
+    draco::Mesh::Face face;
+    for (size_t corner = 0; corner != 3; ++corner) {
+      face[corner] = draco::PointIndex(grid.indices[3 * ti + corner]);
+    }
+    draco_mesh.AddFace(face);
+  }
+
+  draco::Encoder encoder;
+  encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION, 14);
+  encoder.SetAttributeQuantization(draco::GeometryAttribute::NORMAL, 10);
+  encoder.SetAttributeQuantization(draco::GeometryAttribute::TEX_COORD, 12);
+  draco::EncoderBuffer encoded;
+  const draco::Status status =
+      encoder.EncodeMeshToBuffer(draco_mesh, &encoded);
+  if (!status.ok()) {
+    fprintf(stderr, "ERROR: Draco encoding failed: %s\n",
+            status.error_msg());
+    return false;
+  }
+  prim->draco.bufferView =
+      AddView(encoded.data(), encoded.size(), BufferView::kTargetUnset);
+  prim->indices = AddAccessor(
+      Id::kNull, vert_count <= 0xffff ? Accessor::kComponentUnsignedShort
+                                      : Accessor::kComponentUnsignedInt,
+      Accessor::kTypeScalar, grid.indices.size());
+  return true;
+}
+#endif  // GLTF_GEN_DRACO
+
+void Generator::AddNodes() {
+  // Node 0 is the scene root, with mesh nodes under it either as direct
+  // children (wide) or as a single chain (deep).
+  const size_t node_count = options_.node_count;
+  gltf_.nodes.resize(1 + node_count);
+  gltf_.nodes[0].name = "root";
+  const size_t columns = static_cast<size_t>(ceil(sqrt(
+      static_cast<double>(node_count))));
+  for (size_t i = 0; i != node_count; ++i) {
+    const Id id = Gltf::IndexToId(1 + i);
+    Node& node = gltf_.nodes[1 + i];
+    node.name = "node" + std::to_string(i);
+    node.mesh = Gltf::IndexToId(i % options_.mesh_count);
+    if (options_.deep) {
+      node.translation[0] = i == 0 ? 0.0f : 0.25f;
+      gltf_.nodes[i].children.push_back(id);
+    } else {
+      node.translation[0] = 1.5f * static_cast<float>(i % columns);
+      node.translation[2] = -1.5f * static_cast<float>(i / columns);
+      gltf_.nodes[0].children.push_back(id);
+    }
+  }
+  gltf_.scenes.resize(1);
+  gltf_.scenes[0].nodes.push_back(Gltf::IndexToId(0));
+  gltf_.scene = Gltf::IndexToId(0);
+}
+
+void Generator::AddSkin() {
+  // Joints form a vertical chain under the root, one per mesh band.
+  const size_t joint_count = options_.joint_count;
+  const float step = 1.0f / static_cast<float>(joint_count);
+  const size_t first_joint = gltf_.nodes.size();
+  Gltf::Skin skin;
+  skin.name = "skin";
+  skin.skeleton = Gltf::IndexToId(first_joint);
+  std::vector<float> inverse_binds(16 * joint_count, 0.0f);
+  for (size_t ji = 0; ji != joint_count; ++ji) {
+    const Id id = Gltf::IndexToId(first_joint + ji);
+    Node joint;
+    joint.name = "joint" + std::to_string(ji);
+    joint.translation[1] = ji == 0 ? 0.0f : step;
+    gltf_.nodes.push_back(joint);
+    gltf_.nodes[ji == 0 ? 0 : first_joint + ji - 1].children.push_back(id);
+    skin.joints.push_back(id);
+
+    float* const m = &inverse_binds[16 * ji];
+    m[0] = m[5] = m[10] = m[15] = 1.0f;
+    m[13] = -step * static_cast<float>(ji);
+  }
+  skin.inverseBindMatrices = AddAccessor(
+      AddView(inverse_binds, BufferView::kTargetUnset),
+      Accessor::kComponentFloat, Accessor::kTypeMat4, joint_count);
+  gltf_.skins.push_back(skin);
+
+  const Id skin_id = LastId(gltf_.skins.size());
+  for (size_t i = 0; i != options_.node_count; ++i) {
+    gltf_.nodes[1 + i].skin = skin_id;
+  }
+}
+
+void Generator::AddAnimation() {
+  // Rotate each joint (or each mesh node, if there's no skin) about Z, with a
+  // per-target phase. All samplers share the same input times.
+  const size_t frame_count = options_.frame_count;
+  const bool cubic = options_.cubic;
+  const float kFps = 30.0f;
+  std::vector<float> times(frame_count);
+  for (size_t fi = 0; fi != frame_count; ++fi) {
+    times[fi] = static_cast<float>(fi) / kFps;
+  }
+  const Id input = AddAccessor(AddView(times, BufferView::kTargetUnset),
+                               Accessor::kComponentFloat,
+                               Accessor::kTypeScalar, frame_count);
+  Accessor& input_accessor = gltf_.accessors.back();
+  input_accessor.has_min_max = true;
+  input_accessor.min.f[0] = times.front();
+  input_accessor.max.f[0] = times.back();
+
+  std::vector<Id> targets;
+  if (options_.joint_count > 0) {
+    targets = gltf_.skins[0].joints;
+  } else {
+    for (size_t i = 0; i != options_.node_count; ++i) {
+      targets.push_back(Gltf::IndexToId(1 + i));
+    }
+  }
+
+  // Cubic spline outputs are (in-tangent, value, out-tangent) triples, with
+  // zero tangents here.
+  const size_t values_per_frame = cubic ? 3 : 1;
+  const size_t value_offset = cubic ? 1 : 0;
+  const float kTwoPi = 6.28318530718f;
+  const float kAmplitude = 0.3f;
+  Animation animation;
+  animation.name = "animation";
+  std::vector<float> rotations;
+  for (size_t ti = 0; ti != targets.size(); ++ti) {
+    rotations.assign(4 * values_per_frame * frame_count, 0.0f);
+    const float phase = static_cast<float>(ti) * 0.5f;
+    for (size_t fi = 0; fi != frame_count; ++fi) {
+      const float angle = kAmplitude * sinf(
+          kTwoPi * static_cast<float>(fi) / static_cast<float>(frame_count) +
+          phase);
+      float* const q =
+          &rotations[4 * (values_per_frame * fi + value_offset)];
+      q[2] = sinf(0.5f * angle);
+      q[3] = cosf(0.5f * angle);
+    }
+    Animation::Sampler sampler;
+    sampler.input = input;
+    sampler.interpolation =
+        cubic ? Animation::Sampler::kInterpolationCubicSpline
+              : Animation::Sampler::kInterpolationLinear;
+    sampler.output = AddAccessor(
+        AddView(rotations, BufferView::kTargetUnset),
+        Accessor::kComponentFloat, Accessor::kTypeVec4,
+        values_per_frame * frame_count);
+    animation.samplers.push_back(sampler);
+
+    Animation::Channel channel;
+    channel.sampler = LastId(animation.samplers.size());
+    channel.target.node = targets[ti];
+    channel.target.path = Animation::Channel::Target::kPathRotation;
+    animation.channels.push_back(channel);
+  }
+  gltf_.animations.push_back(std::move(animation));
+}
+
+bool Generator::CheckLimits() const {
+  const size_t id_max = Gltf::IdToIndex(Id::kNull);
+  if (gltf_.accessors.size() > id_max || gltf_.bufferViews.size() > id_max) {
+    fprintf(stderr, "ERROR: Too many accessors or bufferViews (max=%zu).\n",
+            id_max);
+    return false;
+  }
+  return true;
+}
+
+bool WriteFile(const std::string& path, const void* data, size_t size) {
+  std::ofstream os(path, std::ios::binary);
+  if (os.is_open()) {
+    os.write(static_cast<const char*>(data), size);
+  }
+  if (!os.good()) {
+    fprintf(stderr, "ERROR: Cannot write file: %s\n", path.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool Generator::Write() const {
+  const std::string& path = options_.out_path;
+  std::ofstream os(path, std::ios::binary);
+  if (!os.is_open()) {
+    fprintf(stderr, "ERROR: Cannot open file for write: %s\n", path.c_str());
+    return false;
+  }
+  const bool success =
+      is_glb_ ? GltfSaveGlb(os, gltf_, bin_, options_.save_settings)
+              : GltfSave(os, gltf_, options_.save_settings);
+  if (!success) {
+    fprintf(stderr, "ERROR: Cannot write file: %s\n", path.c_str());
+    return false;
+  }
+  if (!is_glb_) {
+    const std::string bin_path =
+        Gltf::JoinPath(out_dir_, gltf_.buffers[0].uri.path);
+    if (!WriteFile(bin_path, bin_.data(), bin_.size())) {
+      return false;
+    }
+  }
+  for (const ImageFile& image_file : image_files_) {
+    if (!WriteFile(image_file.path, image_file.data.data(),
+                   image_file.data.size())) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    return -1;
+  }
+  Generator generator(options);
+  if (!generator.Generate() || !generator.Write()) {
+    return 1;
+  }
+  return 0;
+}
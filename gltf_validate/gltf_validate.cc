@@ -0,0 +1,374 @@
+/*
+ * Copyright 2019 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// Validates glTF and GLB files in parallel, without converting them.
+//
+// This only depends on the gltf library (no USD), so validating a large corpus
+// doesn't pay USD startup costs, and files are validated concurrently on a
+// pool of worker threads. Messages are printed per-file in input order,
+// followed by per-tag message statistics, and optionally written as JSON.
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>  // NOLINT: Unapproved C++11 header.
+#include <chrono>  // NOLINT: Unapproved C++11 header.
+#include <condition_variable>  // NOLINT: Unapproved C++11 header.
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT: Unapproved C++11 header.
+#include <string>
+#include <thread>  // NOLINT: Unapproved C++11 header.
+#include <vector>
+#include "gltf/gltf.h"
+#include "gltf/load.h"
+#include "gltf/message.h"
+#include "gltf/stream.h"
+#include "gltf/validate.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+const char kUsage[] =
+    "Usage: gltf_validate [options] <gltf/glb paths...>\n"
+    "Options:\n"
+    "  --jobs <count>      Number of files validated concurrently "
+    "[default=hardware threads].\n"
+    "  --data              Also check buffer and accessor data (non-finite\n"
+    "                      values, min/max, and index ranges).\n"
+    "  --list <path>       Read additional paths from a file, one per line.\n"
+    "  --json <path>       Write per-file results and statistics as JSON.\n"
+    "  --nowarn_extension <prefix>\n"
+    "                      Disable warnings for unrecognized glTF extensions.\n"
+    "  --quiet             Only print files that have messages.\n";
+
+struct Options {
+  std::vector<std::string> paths;
+  size_t job_count = 0;
+  std::string json_path;
+  bool quiet = false;
+  GltfLoadSettings load_settings;
+};
+
+struct FileResult {
+  bool done = false;
+  bool success = false;
+  double seconds = 0.0;
+  std::vector<GltfMessage> messages;
+};
+
+struct Stats {
+  size_t file_count = 0;
+  size_t failed_count = 0;
+  size_t severity_counts[kGltfSeverityCount] = {};
+  std::map<std::string, size_t> tag_counts[kGltfSeverityCount];
+};
+
+std::string EscapeJson(const std::string& text) {
+  std::string escaped;
+  escaped.reserve(text.size());
+  for (const char c : text) {
+    switch (c) {
+    case '"':
+      escaped += "\\\"";
+      break;
+    case '\\':
+      escaped += "\\\\";
+      break;
+    case '\n':
+      escaped += "\\n";
+      break;
+    case '\t':
+      escaped += "\\t";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        char code[8];
+        snprintf(code, sizeof(code), "\\u%04x",
+                 static_cast<unsigned int>(static_cast<unsigned char>(c)));
+        escaped += code;
+      } else {
+        escaped += c;
+      }
+      break;
+    }
+  }
+  return escaped;
+}
+
+bool ReadPathList(const char* list_path, std::vector<std::string>* paths) {
+  std::ifstream is(list_path);
+  if (!is.is_open()) {
+    fprintf(stderr, "ERROR: Cannot open path list: %s\n", list_path);
+    return false;
+  }
+  std::string line;
+  while (std::getline(is, line)) {
+    while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) {
+      line.pop_back();
+    }
+    if (!line.empty()) {
+      paths->push_back(line);
+    }
+  }
+  return true;
+}
+
+bool ParseOptions(int argc, char* argv[], Options* options) {
+  for (int i = 1; i < argc; ++i) {
+    const char* const arg = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+      printf("%s", kUsage);
+      return false;
+    } else if (strcmp(arg, "--quiet") == 0) {
+      options->quiet = true;
+    } else if (strcmp(arg, "--data") == 0) {
+      options->load_settings.validate_data = true;
+    } else if (strcmp(arg, "--jobs") == 0 && has_value) {
+      const int job_count = atoi(argv[++i]);
+      options->job_count = job_count > 0 ? job_count : 0;
+    } else if (strcmp(arg, "--list") == 0 && has_value) {
+      if (!ReadPathList(argv[++i], &options->paths)) {
+        return false;
+      }
+    } else if (strcmp(arg, "--json") == 0 && has_value) {
+      options->json_path = argv[++i];
+    } else if (strcmp(arg, "--nowarn_extension") == 0 && has_value) {
+      options->load_settings.nowarn_extension_prefixes.push_back(argv[++i]);
+    } else if (arg[0] == '-' && arg[1] == '-') {
+      fprintf(stderr, "ERROR: Unknown or incomplete option: %s\n%s", arg,
+              kUsage);
+      return false;
+    } else {
+      options->paths.push_back(arg);
+    }
+  }
+  if (options->paths.empty()) {
+    fprintf(stderr, "%s", kUsage);
+    return false;
+  }
+  const size_t thread_count =
+      std::max(1u, std::thread::hardware_concurrency());
+  if (options->job_count == 0) {
+    options->job_count = thread_count;
+  }
+  options->job_count = std::min(options->job_count, options->paths.size());
+
+  // Spread any threads not used for concurrent files across validation of
+  // each file (e.g. when validating a single large file).
+  options->load_settings.validate_thread_count =
+      std::max<size_t>(1, thread_count / options->job_count);
+  return true;
+}
+
+void ValidateFile(const std::string& path, const GltfLoadSettings& settings,
+                  FileResult* result) {
+  const Clock::time_point start_time = Clock::now();
+  std::string dir, name;
+  Gltf::SplitPath(path, &dir, &name);
+  GltfVectorLogger logger;
+  const std::unique_ptr<GltfStream> stream =
+      GltfStream::Open(&logger, path.c_str(), dir.c_str());
+  if (stream) {
+    Gltf gltf;
+    result->success = GltfLoadAndValidate(stream.get(), path.c_str(), settings,
+                                          &gltf, &logger);
+  } else if (logger.GetErrorCount() == 0) {
+    logger.Add(GltfGetMessage<GLTF_ERROR_IO_OPEN_READ>("", path.c_str()));
+  }
+  result->messages = logger.GetMessages();
+  result->seconds =
+      std::chrono::duration<double>(Clock::now() - start_time).count();
+}
+
+void AddStats(const FileResult& result, Stats* stats) {
+  ++stats->file_count;
+  if (!result.success) {
+    ++stats->failed_count;
+  }
+  for (const GltfMessage& message : result.messages) {
+    const GltfSeverity severity = message.GetSeverity();
+    ++stats->severity_counts[severity];
+    ++stats->tag_counts[severity][message.what_info->name];
+  }
+}
+
+void PrintResult(const std::string& path, const FileResult& result,
+                 bool quiet) {
+  if (quiet && result.messages.empty()) {
+    return;
+  }
+  printf("%s\n", path.c_str());
+  GltfPrintMessages(result.messages, "  ", stdout);
+}
+
+void PrintStats(const Stats& stats, double seconds) {
+  static const char* const kStatsHeaders[] = {
+      "Info:",      // kGltfSeverityNone
+      "Warnings:",  // kGltfSeverityWarning
+      "Errors:",    // kGltfSeverityError
+  };
+  printf("\n------------------------------------\n"
+         "-- Message Statistics\n");
+  for (size_t severity = kGltfSeverityCount; severity-- != 0;) {
+    const std::map<std::string, size_t>& tag_counts =
+        stats.tag_counts[severity];
+    if (tag_counts.empty()) {
+      continue;
+    }
+    printf("%s\n", kStatsHeaders[severity]);
+    for (const auto& tag_count : tag_counts) {
+      printf("  %s(%zu)\n", tag_count.first.c_str(), tag_count.second);
+    }
+  }
+  printf("\n------------------------------------\n"
+         "-- Summary\n"
+         "Validated %zu files in %.2fs. %zu failed, %zu errors, "
+         "%zu warnings.\n",
+         stats.file_count, seconds, stats.failed_count,
+         stats.severity_counts[kGltfSeverityError],
+         stats.severity_counts[kGltfSeverityWarning]);
+}
+
+void WriteJsonResult(FILE* file, bool first, const std::string& path,
+                     const FileResult& result) {
+  static const char* const kSeverityNames[] = {
+      "info",     // kGltfSeverityNone
+      "warning",  // kGltfSeverityWarning
+      "error",    // kGltfSeverityError
+  };
+  size_t severity_counts[kGltfSeverityCount] = {};
+  for (const GltfMessage& message : result.messages) {
+    ++severity_counts[message.GetSeverity()];
+  }
+  fprintf(file, "%s    {\n", first ? "" : ",\n");
+  fprintf(file, "      \"path\": \"%s\",\n", EscapeJson(path).c_str());
+  fprintf(file, "      \"success\": %s,\n", result.success ? "true" : "false");
+  fprintf(file, "      \"errors\": %zu,\n",
+          severity_counts[kGltfSeverityError]);
+  fprintf(file, "      \"warnings\": %zu,\n",
+          severity_counts[kGltfSeverityWarning]);
+  fprintf(file, "      \"seconds\": %.6f,\n", result.seconds);
+  fprintf(file, "      \"messages\": [");
+  for (size_t i = 0; i != result.messages.size(); ++i) {
+    const GltfMessage& message = result.messages[i];
+    fprintf(file,
+            "%s\n        {\"severity\": \"%s\", \"tag\": \"%s\", "
+            "\"text\": \"%s\"}",
+            i == 0 ? "" : ",", kSeverityNames[message.GetSeverity()],
+            message.what_info->name,
+            EscapeJson(message.ToString(false, false)).c_str());
+  }
+  fprintf(file, "%s]\n    }", result.messages.empty() ? "" : "\n      ");
+}
+
+void WriteJsonStats(FILE* file, const Stats& stats, double seconds) {
+  fprintf(file, "\n  ],\n");
+  fprintf(file, "  \"summary\": {\n");
+  fprintf(file, "    \"files\": %zu,\n", stats.file_count);
+  fprintf(file, "    \"failed\": %zu,\n", stats.failed_count);
+  fprintf(file, "    \"errors\": %zu,\n",
+          stats.severity_counts[kGltfSeverityError]);
+  fprintf(file, "    \"warnings\": %zu,\n",
+          stats.severity_counts[kGltfSeverityWarning]);
+  fprintf(file, "    \"seconds\": %.3f,\n", seconds);
+  fprintf(file, "    \"tags\": {");
+  bool first = true;
+  for (size_t severity = kGltfSeverityCount; severity-- != 0;) {
+    for (const auto& tag_count : stats.tag_counts[severity]) {
+      fprintf(file, "%s\n      \"%s\": %zu", first ? "" : ",",
+              tag_count.first.c_str(), tag_count.second);
+      first = false;
+    }
+  }
+  fprintf(file, "%s}\n  }\n}\n", first ? "" : "\n    ");
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    return -1;
+  }
+
+  FILE* json_file = nullptr;
+  if (!options.json_path.empty()) {
+    json_file = fopen(options.json_path.c_str(), "w");
+    if (!json_file) {
+      fprintf(stderr, "ERROR: Cannot open file for write: %s\n",
+              options.json_path.c_str());
+      return -1;
+    }
+    fprintf(json_file, "{\n  \"files\": [\n");
+  }
+
+  // Workers claim files in order, and the main thread prints results in the
+  // same order as they complete, so output is deterministic.
+  const Clock::time_point start_time = Clock::now();
+  const std::vector<std::string>& paths = options.paths;
+  std::vector<FileResult> results(paths.size());
+  std::atomic<size_t> next_index(0);
+  std::mutex mutex;
+  std::condition_variable done_event;
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i != options.job_count; ++i) {
+    workers.emplace_back([&]() {
+      for (;;) {
+        const size_t index = next_index++;
+        if (index >= paths.size()) {
+          break;
+        }
+        FileResult result;
+        ValidateFile(paths[index], options.load_settings, &result);
+        std::lock_guard<std::mutex> lock(mutex);
+        results[index] = std::move(result);
+        results[index].done = true;
+        done_event.notify_one();
+      }
+    });
+  }
+
+  Stats stats;
+  for (size_t i = 0; i != paths.size(); ++i) {
+    FileResult result;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      done_event.wait(lock, [&]() { return results[i].done; });
+      result = std::move(results[i]);
+      results[i] = FileResult();
+    }
+    PrintResult(paths[i], result, options.quiet);
+    AddStats(result, &stats);
+    if (json_file) {
+      WriteJsonResult(json_file, i == 0, paths[i], result);
+    }
+  }
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+
+  const double seconds =
+      std::chrono::duration<double>(Clock::now() - start_time).count();
+  PrintStats(stats, seconds);
+  if (json_file) {
+    WriteJsonStats(json_file, stats, seconds);
+    fclose(json_file);
+  }
+  return stats.failed_count == 0 ? 0 : 1;
+}
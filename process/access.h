@@ -73,23 +73,20 @@ template <typename Dst>
 size_t CopyAccessorToScalars(
     const Gltf& gltf, Gltf::Id accessor_id, const std::vector<bool>& used,
     GltfCache* gltf_cache, std::vector<Dst>* out_scalars) {
-  size_t src_vec_count, component_count;
-  const Dst* src =
-      gltf_cache->Access<Dst>(accessor_id, &src_vec_count, &component_count);
-  if (!src) {
+  GltfCache::SparseView<Dst> view;
+  if (!gltf_cache->AccessSparse(accessor_id, &view)) {
     return 0;
   }
+  const size_t src_vec_count = view.vec_count;
+  const size_t component_count = view.component_count;
   UFG_ASSERT_FORMAT(src_vec_count == used.size());
   std::vector<Dst> scalars(src_vec_count * component_count);
-  std::vector<Dst> dst_buffer(src_vec_count * component_count);
   Dst* dst = scalars.data();
-  for (size_t i = 0; i != src_vec_count; ++i, src += component_count) {
-    if (!used[i]) {
-      continue;
+  view.ForEach([&](size_t i, const Dst* src) {
+    if (used[i]) {
+      dst = std::copy(src, src + component_count, dst);
     }
-    std::copy(src, src + component_count, dst);
-    dst += component_count;
-  }
+  });
   scalars.resize(dst - scalars.data());
   if (scalars.empty()) {
     return 0;
@@ -116,18 +113,17 @@ void CopyAccessorToVectors(
     const Gltf& gltf, Gltf::Id accessor_id,
     GltfCache* gltf_cache, std::vector<DstVec>* out_vecs) {
   using Handler = CopyAccessorHandler<float, DstVec>;
-  size_t vec_count, component_count;
-  const float* const scalars = gltf_cache->Access<float>(
-      accessor_id, &vec_count, &component_count);
-  UFG_ASSERT_FORMAT(component_count == Handler::kComponentCount);
-  out_vecs->resize(vec_count);
-  const float* src = scalars;
-  DstVec* dst = out_vecs->data();
-  for (size_t i = 0; i != vec_count; ++i) {
-    Handler::CopyVec(src, dst);
-    src += component_count;
-    ++dst;
+  GltfCache::SparseView<float> view;
+  if (!gltf_cache->AccessSparse(accessor_id, &view)) {
+    out_vecs->clear();
+    return;
   }
+  UFG_ASSERT_FORMAT(view.component_count == Handler::kComponentCount);
+  out_vecs->resize(view.vec_count);
+  DstVec* const dst = out_vecs->data();
+  view.ForEach([dst](size_t i, const float* src) {
+    Handler::CopyVec(src, dst + i);
+  });
 }
 
 template <typename Array>
@@ -137,21 +133,22 @@ void CopyAccessorToVectors(
   using Vec = typename Array::value_type;
   using Scalar = typename Vec::ScalarType;
   static_assert(sizeof(Vec) / sizeof(Scalar) == Vec::dimension, "");
-  size_t src_vec_count, component_count;
-  const Scalar* const scalars = gltf_cache->Access<Scalar>(
-      accessor_id, &src_vec_count, &component_count);
+  GltfCache::SparseView<Scalar> view;
+  if (!gltf_cache->AccessSparse(accessor_id, &view)) {
+    out_vecs->clear();
+    return;
+  }
+  const size_t src_vec_count = view.vec_count;
+  const size_t component_count = view.component_count;
   UFG_ASSERT_LOGIC(component_count == Vec::dimension);
-  const Scalar* src = scalars;
   out_vecs->resize(src_vec_count);
   if (src_vec_count > 0) {
     Scalar* dst = out_vecs->data()->data();
-    for (size_t i = 0; i != src_vec_count; ++i, src += component_count) {
-      if (!used[i]) {
-        continue;
+    view.ForEach([&](size_t i, const Scalar* src) {
+      if (used[i]) {
+        dst = std::copy(src, src + component_count, dst);
       }
-      std::copy(src, src + component_count, dst);
-      dst += component_count;
-    }
+    });
     const size_t dst_scalar_count = dst - out_vecs->data()->data();
     const size_t dst_vec_count = dst_scalar_count / Vec::dimension;
     out_vecs->resize(dst_vec_count);
@@ -16,11 +16,16 @@
 
 #include "process/animation.h"
 
+#include <utility>
 #include "process/access.h"
 #include "process/process_util.h"
 
 namespace ufg {
 namespace {
+// Approximate number of key comparisons made between checks for cancellation.
+// * Checking reads the clock, which costs more than a comparison.
+constexpr size_t kPruneComparesPerCancelCheck = 4096;
+
 // Find the next key time index that is <= t.
 inline int FindNextTimeBefore(const std::vector<float>& times, int start,
                               float t) {
@@ -72,6 +77,10 @@ inline bool ShouldPruneQuat(
   return e < kPruneRotationComponent;
 }
 
+inline bool ShouldPruneWeight(float p0, float p1, float p2, float s) {
+  return std::abs(Lerp(p0, p2, s) - p1) <= kPruneMorphWeight;
+}
+
 inline bool ShouldPruneScale(
     const GfVec3f& p0, const GfVec3f& p1, const GfVec3f& p2, float s) {
   const GfVec3f p = Lerp(p0, p2, s);
@@ -107,6 +116,7 @@ void NodeInfo::SetStatic(const Srt& srt) {
   translation_points.assign({ srt.translation });
   rotation_points.assign({ srt.rotation });
   scale_points.assign({ srt.scale });
+  weight_tracks.clear();
 }
 
 inline bool TranslationPrunerStream::ShouldPrune(
@@ -259,14 +269,51 @@ bool ScaleKeyPrunerStream::IsPrunedConstant() const {
   return true;
 }
 
+inline bool WeightsKeyPrunerStream::ShouldPrune(
+    size_t i0, size_t i1, size_t i2, float s) const {
+  const WeightsKey& k0 = src_keys[i0];
+  const WeightsKey& k1 = src_keys[i1];
+  const WeightsKey& k2 = src_keys[i2];
+  for (size_t i = 0, count = k0.p.size(); i != count; ++i) {
+    if (!ShouldPruneWeight(k0.p[i], k1.p[i], k2.p[i], s)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool WeightsKeyPrunerStream::IsPrunedConstant() const {
+  if (keys.size() != 2) {
+    return keys.size() < 2;
+  }
+  const WeightsKey& k0 = keys[0];
+  const WeightsKey& k1 = keys[1];
+  for (size_t i = 0, count = k0.p.size(); i != count; ++i) {
+    if (std::abs(k1.p[i] - k0.p[i]) > kPruneMorphWeight) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void PropagatePassesUsed(
     Gltf::Id node_id, const Gltf::Node* nodes, NodeInfo* node_infos) {
-  const size_t node_index = Gltf::IdToIndex(node_id);
-  const Gltf::Node& node = nodes[node_index];
-  NodeInfo& node_info = node_infos[node_index];
-  for (const Gltf::Id child_id : node.children) {
-    PropagatePassesUsed(child_id, nodes, node_infos);
-    const NodeInfo& child_node_info = node_infos[Gltf::IdToIndex(child_id)];
+  // Gather (child, parent) pairs in depth-first order, so every parent
+  // precedes its descendants. Then merge flags upward in reverse order.
+  std::vector<std::pair<size_t, size_t>> order;
+  std::vector<size_t> pending(1, Gltf::IdToIndex(node_id));
+  while (!pending.empty()) {
+    const size_t node_index = pending.back();
+    pending.pop_back();
+    for (const Gltf::Id child_id : nodes[node_index].children) {
+      const size_t child_index = Gltf::IdToIndex(child_id);
+      order.emplace_back(child_index, node_index);
+      pending.push_back(child_index);
+    }
+  }
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    const NodeInfo& child_node_info = node_infos[it->first];
+    NodeInfo& node_info = node_infos[it->second];
     for (size_t pass = 0; pass != kPassCount; ++pass) {
       if (child_node_info.passes_used[pass]) {
         node_info.passes_used[pass] = true;
@@ -287,7 +334,11 @@ AnimInfo GetAnimInfo(
   const size_t channel_count = anim->channels.size();
   for (size_t ci = 0; ci != channel_count; ++ci) {
     const Gltf::Animation::Channel& channel = anim->channels[ci];
-    if (channel.target.node != Gltf::Id::kNull) {
+    // Weights animate blend shapes rather than the node transform, so they
+    // don't affect the node or its descendants.
+    if (channel.target.node != Gltf::Id::kNull &&
+        channel.target.path !=
+            Gltf::Animation::Channel::Target::kPathWeights) {
       MarkAffectedNodes(gltf.nodes, channel.target.node,
                         &anim_info.nodes_animated);
     }
@@ -330,9 +381,9 @@ std::vector<const NodeInfo*> GetJointNodeInfos(
   return joint_infos;
 }
 
-template <typename Key>
+template <typename Key, typename Info>
 void GenerateSkinAnimKeys(
-    size_t joint_count, const NodeInfo* const* joint_infos,
+    size_t joint_count, const Info* const* joint_infos,
     std::vector<Key>* out_keys) {
   using Point = typename Key::Point;
 
@@ -353,7 +404,7 @@ void GenerateSkinAnimKeys(
     // Find the next source key time >t.
     float t = kTimeMax;
     for (size_t joint_index = 0; joint_index != joint_count; ++joint_index) {
-      const NodeInfo& info = *joint_infos[joint_index];
+      const Info& info = *joint_infos[joint_index];
       const std::vector<float>& times = Key::GetNodeTimes(info);
       const size_t next_src_it = src_its[joint_index] + 1;
       if (next_src_it < times.size()) {
@@ -372,7 +423,7 @@ void GenerateSkinAnimKeys(
     key.t = t;
     key.p.resize(joint_count);
     for (size_t joint_index = 0; joint_index != joint_count; ++joint_index) {
-      const NodeInfo& info = *joint_infos[joint_index];
+      const Info& info = *joint_infos[joint_index];
 
       // Find the source key range bounding the current time.
       const std::vector<float>& times = Key::GetNodeTimes(info);
@@ -408,9 +459,12 @@ template void GenerateSkinAnimKeys(size_t joint_count,
     const NodeInfo* const* joint_infos, std::vector<RotationKey>* out_keys);
 template void GenerateSkinAnimKeys(size_t joint_count,
     const NodeInfo* const* joint_infos, std::vector<ScaleKey>* out_keys);
+template void GenerateSkinAnimKeys(size_t joint_count,
+    const WeightTrack* const* joint_infos, std::vector<WeightsKey>* out_keys);
 
 template <typename PrunerStream>
-void PruneAnimationKeys(size_t src_count, PrunerStream* stream) {
+void PruneAnimationKeys(size_t src_count, PrunerStream* stream,
+                        const CancelToken* cancel) {
   UFG_ASSERT_LOGIC(src_count > 0);
   if (src_count == 1) {
     stream->Resize(1);
@@ -437,7 +491,16 @@ void PruneAnimationKeys(size_t src_count, PrunerStream* stream) {
   // implementation that samples just a subset (e.g. the midpoint and the point
   // to be pruned).
   size_t i_begin = 0;
+  size_t compares_until_check = 0;
   for (size_t i_end = 2; i_end != src_count; ++i_end) {
+    // Each iteration compares at most the keys in the current run.
+    const size_t compares = i_end - i_begin;
+    if (compares >= compares_until_check) {
+      CheckCancel(cancel);
+      compares_until_check = kPruneComparesPerCancelCheck;
+    } else {
+      compares_until_check -= compares;
+    }
     const float t_begin = stream->GetTime(i_begin);
     const float t_end = stream->GetTime(i_end);
     const float dt = t_end - t_begin;
@@ -473,19 +536,29 @@ void PruneAnimationKeys(size_t src_count, PrunerStream* stream) {
 }
 
 template void PruneAnimationKeys(
-    size_t src_count, TranslationPrunerStream* stream);
+    size_t src_count, TranslationPrunerStream* stream,
+    const CancelToken* cancel);
+template void PruneAnimationKeys(
+    size_t src_count, EulerPrunerStream* stream,
+    const CancelToken* cancel);
 template void PruneAnimationKeys(
-    size_t src_count, EulerPrunerStream* stream);
+    size_t src_count, QuatPrunerStream* stream,
+    const CancelToken* cancel);
 template void PruneAnimationKeys(
-    size_t src_count, QuatPrunerStream* stream);
+    size_t src_count, ScalePrunerStream* stream,
+    const CancelToken* cancel);
 template void PruneAnimationKeys(
-    size_t src_count, ScalePrunerStream* stream);
+    size_t src_count, TranslationKeyPrunerStream* stream,
+    const CancelToken* cancel);
 template void PruneAnimationKeys(
-    size_t src_count, TranslationKeyPrunerStream* stream);
+    size_t src_count, RotationKeyPrunerStream* stream,
+    const CancelToken* cancel);
 template void PruneAnimationKeys(
-    size_t src_count, RotationKeyPrunerStream* stream);
+    size_t src_count, ScaleKeyPrunerStream* stream,
+    const CancelToken* cancel);
 template void PruneAnimationKeys(
-    size_t src_count, ScaleKeyPrunerStream* stream);
+    size_t src_count, WeightsKeyPrunerStream* stream,
+    const CancelToken* cancel);
 
 bool TranslationKeyConverter::ShouldPrune(
     const Point& p0, const Point& p1, const Point& p2, float s) {
@@ -502,6 +575,11 @@ bool ScaleKeyConverter::ShouldPrune(
   return ShouldPruneScale(p0, p1, p2, s);
 }
 
+bool WeightKeyConverter::ShouldPrune(
+    const Point& p0, const Point& p1, const Point& p2, float s) {
+  return ShouldPruneWeight(p0, p1, p2, s);
+}
+
 // Cubic splines have 3 points per key to define curve gradients.
 // https://github.com/KhronosGroup/glTF/blob/master/specification/2.0/README.md#appendix-c-spline-interpolation
 enum SplineElement : uint8_t {
@@ -533,6 +611,16 @@ GfVec3f SampleSpline(const GfVec3f* key0, float t0,
   return EvalSpline(p0, m0, p1, m1, s);
 }
 
+float SampleSpline(const float* key0, float t0,
+                   const float* key1, float t1, float s) {
+  const float dt = t1 - t0;
+  const float p0 = key0[kSplineElementPoint];
+  const float p1 = key1[kSplineElementPoint];
+  const float m0 = dt * key0[kSplineElementOutTangent];
+  const float m1 = dt * key1[kSplineElementInTangent];
+  return EvalSpline(p0, m0, p1, m1, s);
+}
+
 GfQuatf SampleSpline(const GfQuatf* key0, float t0,
                      const GfQuatf* key1, float t1, float s) {
   const float dt = t1 - t0;
@@ -690,5 +778,8 @@ template void ConvertAnimKeysToLinear<QuatKeyConverter>(
 template void ConvertAnimKeysToLinear<ScaleKeyConverter>(
     Gltf::Animation::Sampler::Interpolation interpolation,
     std::vector<float>* times, std::vector<GfVec3f>* points);
+template void ConvertAnimKeysToLinear<WeightKeyConverter>(
+    Gltf::Animation::Sampler::Interpolation interpolation,
+    std::vector<float>* times, std::vector<float>* points);
 
 }  // namespace ufg
@@ -44,6 +44,12 @@ namespace ufg {
 // determine the correct bounds.
 enum Pass : uint8_t { kPassRigid, kPassSkinned, kPassCount };
 
+// Linear keys for a single morph target weight.
+struct WeightTrack {
+  std::vector<float> times;
+  std::vector<float> points;
+};
+
 struct NodeInfo {
   bool is_animated = false;
   bool passes_used[kPassCount] = { false, false };
@@ -55,6 +61,10 @@ struct NodeInfo {
   std::vector<float> scale_times;
   std::vector<GfVec3f> scale_points;
 
+  // Morph target weight tracks, one per target. Empty if weights aren't
+  // animated.
+  std::vector<WeightTrack> weight_tracks;
+
   // A list of IDs to nodes containing a mesh+skin pair for which the joint root
   // points to this node. Used to reanchor skinned meshes so they are in the
   // skeleton hierarchy (instead of the original mesh hierarchy which is unused
@@ -127,6 +137,23 @@ struct ScaleKey {
   }
 };
 
+// Keys for the weights of all blend shapes driven by a single SkelAnimation.
+struct WeightsKey {
+  using Point = float;
+  float t;
+  std::vector<Point> p;
+
+  static const std::vector<float>& GetNodeTimes(const WeightTrack& track) {
+    return track.times;
+  }
+  static const std::vector<Point>& GetNodePoints(const WeightTrack& track) {
+    return track.points;
+  }
+  static Point Blend(const Point& a, const Point& b, float s) {
+    return Lerp(a, b, s);
+  }
+};
+
 template <typename Point>
 struct SeparatePrunerStream {
   const float* src_times;
@@ -221,6 +248,13 @@ struct ScaleKeyPrunerStream : KeyPrunerStream<ScaleKey> {
   bool IsPrunedConstant() const;
 };
 
+struct WeightsKeyPrunerStream : KeyPrunerStream<WeightsKey> {
+  explicit WeightsKeyPrunerStream(const WeightsKey* src_keys)
+      : KeyPrunerStream(src_keys) {}
+  bool ShouldPrune(size_t i0, size_t i1, size_t i2, float s) const;
+  bool IsPrunedConstant() const;
+};
+
 void PropagatePassesUsed(Gltf::Id node_id, const Gltf::Node* nodes,
                          NodeInfo* node_infos);
 AnimInfo GetAnimInfo(const Gltf& gltf, Gltf::Id anim_id, GltfCache* gltf_cache);
@@ -229,13 +263,19 @@ std::vector<const NodeInfo*> GetJointNodeInfos(
     const std::vector<Gltf::Id>& joint_to_node_map,
     const std::vector<NodeInfo>& node_infos);
 
-template <typename Key>
+// Merge per-joint (or per-blend-shape) key sequences into keys sampled at the
+// union of their times. Info is NodeInfo, or WeightTrack for WeightsKey.
+template <typename Key, typename Info>
 void GenerateSkinAnimKeys(
-    size_t joint_count, const NodeInfo* const* joint_infos,
+    size_t joint_count, const Info* const* joint_infos,
     std::vector<Key>* out_keys);
 
+// Prune keys that can be linearly interpolated from their neighbors.
+// * Throws CancelException if the cancel token (which may be null) is
+//   cancelled.
 template <typename PrunerStream>
-void PruneAnimationKeys(size_t src_count, PrunerStream* stream);
+void PruneAnimationKeys(size_t src_count, PrunerStream* stream,
+                        const CancelToken* cancel = nullptr);
 
 
 struct TranslationKeyConverter {
@@ -256,6 +296,12 @@ struct ScaleKeyConverter {
       const Point& p0, const Point& p1, const Point& p2, float s);
 };
 
+struct WeightKeyConverter {
+  using Point = float;
+  static bool ShouldPrune(
+      const Point& p0, const Point& p1, const Point& p2, float s);
+};
+
 template <typename Converter>
 void ConvertAnimKeysToLinear(
     Gltf::Animation::Sampler::Interpolation interpolation,
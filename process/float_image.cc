@@ -16,6 +16,7 @@
 
 #include "process/float_image.h"
 
+#include <algorithm>
 #include "process/math.h"
 
 namespace ufg {
@@ -310,17 +311,26 @@ void ResizeImage(size_t channel_count, bool premul_alpha, size_t src_width,
 }
 }  // namespace
 
-FloatImage::FloatImage() : width_(0), height_(0), channel_count_(0) {}
+FloatImage::FloatImage(MemoryTracker* memory_tracker)
+    : width_(0), height_(0), channel_count_(0),
+      memory_charge_(kMemoryFloatImages, memory_tracker) {}
 
-FloatImage::FloatImage(const Image& src, ColorSpace src_color_space) {
+FloatImage::FloatImage(const Image& src, ColorSpace src_color_space,
+                       MemoryTracker* memory_tracker)
+    : memory_charge_(kMemoryFloatImages, memory_tracker) {
   CopyFrom(src, src_color_space);
 }
 
+FloatImage::~FloatImage() {
+  GetBufferPool<float>().Release(&pixels_);
+}
+
 void FloatImage::CopyFrom(const Image& src, ColorSpace src_color_space) {
   width_ = src.GetWidth();
   height_ = src.GetHeight();
   channel_count_ = src.GetChannelCount();
-  pixels_ = src.ToFloat(src_color_space == kColorSpaceSrgb);
+  src.ToFloat(src_color_space == kColorSpaceSrgb, &pixels_);
+  UpdateMemoryCharge();
 }
 
 void FloatImage::CopyTo(ColorSpace dst_color_space, Image* dst) const {
@@ -442,9 +452,10 @@ void FloatImage::ConvertSpecDiffToMetalBase(
   } else {
     // We can't update pixels in-place because they may be sampled multiple
     // times, so make a copy.
-    std::vector<float> diff_buffer(
-        diff_base_pixels,
-        diff_base_pixels + diff_width * diff_height * diff_channel_count);
+    const size_t diff_size = diff_width * diff_height * diff_channel_count;
+    PooledBuffer<float> diff_buffer(diff_size);
+    std::copy(diff_base_pixels, diff_base_pixels + diff_size,
+              diff_buffer.data());
     const float* const diff_pixels = diff_buffer.data();
 
     // Iterate at a sample rate high enough to touch each pixel of both images.
@@ -487,12 +498,13 @@ void FloatImage::ConvertSpecDiffToMetalBase(
 }
 
 void FloatImage::Resize(size_t width, size_t height, bool premul_alpha) {
-  std::vector<float> dst_pixels(width * height * channel_count_);
+  PooledBuffer<float> dst_pixels(width * height * channel_count_);
   ResizeImage(channel_count_, premul_alpha,
               width_, height_, pixels_.data(),
               width, height, dst_pixels.data());
   width_ = static_cast<uint32_t>(width);
   height_ = static_cast<uint32_t>(height);
-  pixels_.swap(dst_pixels);
+  pixels_.swap(dst_pixels.vector());
+  UpdateMemoryCharge();
 }
 }  // namespace ufg
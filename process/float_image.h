@@ -18,6 +18,8 @@
 #define UFG_PROCESS_FLOAT_IMAGE_H_
 
 #include <vector>
+#include "common/buffer_pool.h"
+#include "common/memory_tracker.h"
 #include "process/image.h"
 
 namespace ufg {
@@ -28,10 +30,16 @@ enum ColorSpace : uint8_t {
 
 // Image data stored as linear floating-point values, for use in texture
 // reprocessing.
+// * Pixel storage is recycled through the float buffer pool.
+// * Pixel bytes are charged to the memory tracker, if one is given.
 class FloatImage {
  public:
-  FloatImage();
-  FloatImage(const Image& src, ColorSpace src_color_space);
+  explicit FloatImage(MemoryTracker* memory_tracker = nullptr);
+  FloatImage(const Image& src, ColorSpace src_color_space,
+             MemoryTracker* memory_tracker = nullptr);
+  ~FloatImage();
+  FloatImage(const FloatImage&) = delete;
+  FloatImage& operator=(const FloatImage&) = delete;
 
   bool IsValid() const { return width_ != 0; }
   uint32_t GetWidth() const { return width_; }
@@ -67,13 +75,18 @@ class FloatImage {
   uint32_t height_;
   uint32_t channel_count_;
   std::vector<float> pixels_;
+  MemoryCharge memory_charge_;
 
   void Reset(size_t width, size_t height, size_t channel_count) {
     width_ = static_cast<uint32_t>(width);
     height_ = static_cast<uint32_t>(height);
     channel_count_ = static_cast<uint32_t>(channel_count);
-    pixels_.clear();
-    pixels_.resize(width * height * channel_count);
+    GetBufferPool<float>().Acquire(width * height * channel_count, &pixels_);
+    UpdateMemoryCharge();
+  }
+
+  void UpdateMemoryCharge() {
+    memory_charge_.Set(pixels_.capacity() * sizeof(float));
   }
 };
 }  // namespace ufg
@@ -16,6 +16,7 @@
 
 #include "process/image.h"
 
+#include "common/buffer_pool.h"
 #include "common/common_util.h"
 #include "gltf/stream.h"
 #include "process/image_fallback.h"
@@ -171,8 +172,27 @@ Image::Image() : width_(0), height_(0), channel_count_(0) {
   Clear();
 }
 
+Image::Image(const Image& src)
+    : width_(src.width_),
+      height_(src.height_),
+      channel_count_(src.channel_count_) {
+  GetBufferPool<Component>().Acquire(src.buffer_.size(), &buffer_);
+  std::copy(src.buffer_.begin(), src.buffer_.end(), buffer_.begin());
+}
+
+Image& Image::operator=(const Image& src) {
+  if (this != &src) {
+    width_ = src.width_;
+    height_ = src.height_;
+    channel_count_ = src.channel_count_;
+    GetBufferPool<Component>().Acquire(src.buffer_.size(), &buffer_);
+    std::copy(src.buffer_.begin(), src.buffer_.end(), buffer_.begin());
+  }
+  return *this;
+}
+
 Image::~Image() {
-  Clear();
+  GetBufferPool<Component>().Release(&buffer_);
 }
 
 void Image::Clear() {
@@ -189,20 +209,24 @@ bool Image::Read(
 
   // A lot of source files intermingle images with incorrect file extensions, so
   // determine type from the header.
+  // * Decoders resize the buffer directly, so recount it with the pool.
+  const size_t old_capacity = buffer_.capacity();
+  bool success;
   if (HasPngHeader(buffer, size)) {
-    return PngRead(
+    success = PngRead(
         buffer, size, &width_, &height_, &channel_count_, &buffer_, logger);
-  }
-  if (HasJpgHeader(buffer, size)) {
-    return JpgRead(
+  } else if (HasJpgHeader(buffer, size)) {
+    success = JpgRead(
         buffer, size, &width_, &height_, &channel_count_, &buffer_, logger);
-  }
-  if (HasGifHeader(buffer, size)) {
-    return GifRead(
+  } else if (HasGifHeader(buffer, size)) {
+    success = GifRead(
+        buffer, size, &width_, &height_, &channel_count_, &buffer_, logger);
+  } else {
+    success = ImageFallbackRead(
         buffer, size, &width_, &height_, &channel_count_, &buffer_, logger);
   }
-  return ImageFallbackRead(
-      buffer, size, &width_, &height_, &channel_count_, &buffer_, logger);
+  GetBufferPool<Component>().Recount(old_capacity, buffer_);
+  return success;
 }
 
 bool Image::Write(
@@ -211,7 +235,7 @@ bool Image::Write(
   UFG_ASSERT_LOGIC(IsValid());
   if (Gltf::StringEndsWithCI(path, ".png")) {
     return PngWrite(path, width_, height_, channel_count_, buffer_.data(),
-                    settings.png_level, logger);
+                    settings.png_level, logger, settings.cancel_token);
   } else {
     const int quality =
         is_norm ? settings.jpg_quality_norm : settings.jpg_quality;
@@ -221,12 +245,29 @@ bool Image::Write(
   }
 }
 
+bool Image::EncodePng(const ConvertSettings& settings,
+                      std::vector<uint8_t>* out_data, Logger* logger) const {
+  UFG_ASSERT_LOGIC(IsValid());
+  return PngEncode(width_, height_, channel_count_, buffer_.data(),
+                   settings.png_level, out_data, logger,
+                   settings.cancel_token);
+}
+
+bool Image::EncodeJpg(const ConvertSettings& settings, int jpg_quality,
+                      bool is_norm, std::vector<uint8_t>* out_data,
+                      Logger* logger) const {
+  UFG_ASSERT_LOGIC(IsValid());
+  const int subsamp = is_norm ? 0 : settings.jpg_subsamp;
+  return JpgEncode(width_, height_, channel_count_, buffer_.data(),
+                   jpg_quality, subsamp, out_data, logger);
+}
+
 void Image::CreateFromChannel(const Image& src, ColorChannel channel,
                               const Transform& transform) {
   UFG_ASSERT_LOGIC(src.IsValid());
   Clear();
   const uint32_t dst_size = src.width_ * src.height_;
-  buffer_.resize(dst_size);
+  GetBufferPool<Component>().Acquire(dst_size, &buffer_);
   CopyChannelValues(dst_size, channel, src.channel_count_, src.buffer_.data(),
                     transform, buffer_.data());
   width_ = src.width_;
@@ -241,7 +282,7 @@ void Image::CreateFromRgb(const Image& src) {
   UFG_ASSERT_LOGIC(src.channel_count_ >= kDstChannelCount);
   const size_t src_channel_count = src.channel_count_;
   const size_t dst_size = src.width_ * src.height_ * kDstChannelCount;
-  buffer_.resize(dst_size);
+  GetBufferPool<Component>().Acquire(dst_size, &buffer_);
   const Component* s = src.buffer_.data();
   for (Component* d = buffer_.data(), *const end = d + dst_size; d != end; ) {
     d[kColorChannelR] = s[kColorChannelR];
@@ -261,7 +302,7 @@ void Image::CreateFromRgba(const Image& src, Component default_alpha) {
   constexpr size_t kDstChannelCount = 4;
   const size_t src_channel_count = src.channel_count_;
   const size_t dst_size = src.width_ * src.height_ * kDstChannelCount;
-  buffer_.resize(dst_size);
+  GetBufferPool<Component>().Acquire(dst_size, &buffer_);
   const Component* s = src.buffer_.data();
   if (src_channel_count == 3) {
     for (Component* d = buffer_.data(), *const end = d + dst_size; d != end; ) {
@@ -295,7 +336,7 @@ void Image::CreateFromMasked(
   Clear();
   const size_t channel_count = src.channel_count_;
   const size_t pixel_count = src.width_ * src.height_;
-  buffer_.resize(pixel_count * channel_count);
+  GetBufferPool<Component>().Acquire(pixel_count * channel_count, &buffer_);
 
   const Component or_value[] = {
     static_cast<Component>(replace_value[0] & ~keep_mask[0]),
@@ -333,15 +374,16 @@ bool Image::ChannelEquals(ColorChannel channel, Component value) const {
   return true;
 }
 
-std::vector<float> Image::ToFloat(bool srgb_to_linear) const {
+void Image::ToFloat(bool srgb_to_linear,
+                    std::vector<float>* out_buffer) const {
   UFG_ASSERT_LOGIC(IsValid());
   const size_t pixel_stride = channel_count_;
   const size_t size = width_ * height_ * pixel_stride;
   UFG_ASSERT_LOGIC(size == buffer_.size());
-  std::vector<float> float_buffer(size);
+  GetBufferPool<float>().Acquire(size, out_buffer);
   const Component* src = buffer_.data();
   const Component* const src_end = src + size;
-  float* dst = float_buffer.data();
+  float* dst = out_buffer->data();
   if (srgb_to_linear) {
     const float* const srgb_to_linear = kSrgbToLinearTable.linear_values;
     if (pixel_stride == kColorChannelCount) {
@@ -369,14 +411,13 @@ std::vector<float> Image::ToFloat(bool srgb_to_linear) const {
       *dst = ComponentToFloat(*src);
     }
   }
-  return float_buffer;
 }
 
 void Image::CreateFromFloat(const float* data, size_t width, size_t height,
                             size_t channel_count, bool linear_to_srgb) {
   Clear();
   const size_t size = width * height * channel_count;
-  buffer_.resize(size);
+  GetBufferPool<Component>().Acquire(size, &buffer_);
   const float* src = data;
   const float* const src_end = data + size;
   Component* dst = buffer_.data();
@@ -414,7 +455,7 @@ void Image::CreateFromFloat(const float* data, size_t width, size_t height,
 void Image::Create1x1(const Component *color, size_t channel_count) {
   UFG_ASSERT_LOGIC(channel_count > 0 && channel_count <= kColorChannelCount);
   Clear();
-  buffer_.resize(channel_count);
+  GetBufferPool<Component>().Acquire(channel_count, &buffer_);
   std::copy(color, color + channel_count, buffer_.data());
   width_ = 1;
   height_ = 1;
@@ -428,7 +469,7 @@ void Image::CreateWxH(size_t width, size_t height,
   UFG_ASSERT_LOGIC(channel_count > 0 && channel_count <= kColorChannelCount);
   Clear();
   const size_t pixel_count = width * height;
-  buffer_.resize(pixel_count * channel_count);
+  GetBufferPool<Component>().Acquire(pixel_count * channel_count, &buffer_);
   Component* dst = buffer_.data();
   for (size_t i = 0; i != pixel_count; ++i) {
     for (size_t j = 0; j != channel_count; ++j) {
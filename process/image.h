@@ -76,7 +76,10 @@ class Image {
     }
   }
 
+  // Pixel storage is recycled through the component buffer pool.
   Image();
+  Image(const Image& src);
+  Image& operator=(const Image& src);
   ~Image();
 
   bool IsValid() const { return width_ != 0; }
@@ -94,6 +97,14 @@ class Image {
       const char* path, const ConvertSettings& settings,
       Logger* logger, bool is_norm = false) const;
 
+  // Encode to an in-memory file.
+  // * jpg_quality: JPG compression quality [1=worst, 100=best].
+  bool EncodePng(const ConvertSettings& settings,
+                 std::vector<uint8_t>* out_data, Logger* logger) const;
+  bool EncodeJpg(const ConvertSettings& settings, int jpg_quality,
+                 bool is_norm, std::vector<uint8_t>* out_data,
+                 Logger* logger) const;
+
   void CreateFromChannel(
       const Image& src, ColorChannel channel, const Transform& transform);
   void CreateFromRgb(const Image& src);
@@ -104,7 +115,8 @@ class Image {
 
   bool ChannelEquals(ColorChannel channel, Component value) const;
 
-  std::vector<float> ToFloat(bool srgb_to_linear) const;
+  // Convert to float components, reusing the capacity of out_buffer.
+  void ToFloat(bool srgb_to_linear, std::vector<float>* out_buffer) const;
   void CreateFromFloat(const float* data, size_t width, size_t height,
                        size_t channel_count, bool linear_to_srgb);
 
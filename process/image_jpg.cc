@@ -90,9 +90,10 @@ bool JpgRead(
   return true;
 }
 
-bool JpgWrite(
-    const char* path, uint32_t width, uint32_t height, uint8_t channel_count,
-    const Image::Component* data, int quality, int subsamp, Logger* logger) {
+bool JpgEncode(
+    uint32_t width, uint32_t height, uint8_t channel_count,
+    const Image::Component* data, int quality, int subsamp,
+    std::vector<uint8_t>* out_jpg, Logger* logger) {
   // Choose quality and chroma subsampling method.
   quality = Clamp(quality, 1, 100);
   static_assert(TJSAMP_444 == 0 && TJSAMP_422 == 1 && TJSAMP_420 == 2, "");
@@ -110,19 +111,30 @@ bool JpgWrite(
   unsigned char* jpg_data = nullptr;
   unsigned long jpg_size = 0;  // NOLINT
   JpgCompressor compressor;
-  bool success = tjCompress2(
+  const bool success = tjCompress2(
       compressor.handle, data, width, pitch, height, format,
       &jpg_data, &jpg_size, subsamp, quality, TJFLAG_FASTDCT) == 0;
-  if (!success) {
-    Log<UFG_ERROR_JPG_COMPRESS>(logger, "", JpgGetErrorStr(compressor.handle));
-  }
   if (success) {
-    success = GltfDiskWriteBinary(path, jpg_data, jpg_size);
-    if (!success) {
-      Log<UFG_ERROR_IO_WRITE_IMAGE>(logger, "", path);
-    }
+    out_jpg->assign(jpg_data, jpg_data + jpg_size);
+  } else {
+    Log<UFG_ERROR_JPG_COMPRESS>(logger, "", JpgGetErrorStr(compressor.handle));
   }
   tjFree(jpg_data);
   return success;
 }
+
+bool JpgWrite(
+    const char* path, uint32_t width, uint32_t height, uint8_t channel_count,
+    const Image::Component* data, int quality, int subsamp, Logger* logger) {
+  std::vector<uint8_t> jpg;
+  if (!JpgEncode(width, height, channel_count, data, quality, subsamp, &jpg,
+                 logger)) {
+    return false;
+  }
+  if (!GltfDiskWriteBinary(path, jpg.data(), jpg.size())) {
+    Log<UFG_ERROR_IO_WRITE_IMAGE>(logger, "", path);
+    return false;
+  }
+  return true;
+}
 }  // namespace ufg
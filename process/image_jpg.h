@@ -29,6 +29,10 @@ bool JpgRead(
 
 // * quality: JPG compression quality [1=worst, 100=best].
 // * subsamp: JPG chroma subsampling method [0=best, 2=worst].
+bool JpgEncode(
+    uint32_t width, uint32_t height, uint8_t channel_count,
+    const Image::Component* data, int quality, int subsamp,
+    std::vector<uint8_t>* out_jpg, Logger* logger);
 bool JpgWrite(
     const char* path, uint32_t width, uint32_t height, uint8_t channel_count,
     const Image::Component* data, int quality, int subsamp, Logger* logger);
@@ -16,6 +16,7 @@
 
 #include "process/image_png.h"
 
+#include "gltf/disk_util.h"
 #include "png.h"  // NOLINT: Silence relative path warning.
 #include "process/math.h"
 
@@ -23,6 +24,9 @@ namespace ufg {
 namespace {
 constexpr int kPngBitDepth = 8;
 
+// Number of rows encoded between checks for cancellation.
+constexpr size_t kRowsPerCancelCheck = 64;
+
 static void DecodeErrorCallback(png_struct* png, const char* message) {
   Logger* const logger = static_cast<Logger*>(png_get_error_ptr(png));
   Log<UFG_ERROR_PNG_DECODE>(logger, "", message);
@@ -157,22 +161,18 @@ class PngReader {
 
 class PngWriter {
  public:
-  PngWriter() : fp_(nullptr), png_(nullptr), info_(nullptr) {}
+  PngWriter() : png_(nullptr), info_(nullptr), out_png_(nullptr) {}
   ~PngWriter() { Reset(); }
 
-  bool Write(
-      const char* path, uint32_t width, uint32_t height, uint8_t channel_count,
-      const Image::Component* data, int level, Logger* logger) {
+  bool Encode(
+      uint32_t width, uint32_t height, uint8_t channel_count,
+      const Image::Component* data, int level,
+      std::vector<uint8_t>* out_png, Logger* logger,
+      const CancelToken* cancel) {
     level = Clamp(level, 0, 9);
 
     Reset();
 
-    fp_ = fopen(path, "wb");
-    if (!fp_) {
-      Log<UFG_ERROR_IO_WRITE_IMAGE>(logger, "", path);
-      return false;
-    }
-
     png_ = png_create_write_struct(
         PNG_LIBPNG_VER_STRING, logger, EncodeErrorCallback, EncodeWarnCallback);
     info_ = png_ ? png_create_info_struct(png_) : nullptr;
@@ -184,7 +184,11 @@ class PngWriter {
     if (setjmp(png_jmpbuf(png_))) {
       return false;
     }
-    png_init_io(png_, fp_);
+
+    // Use callback to write to memory.
+    out_png_ = out_png;
+    out_png_->clear();
+    png_set_write_fn(png_, this, WriteCallback, nullptr);
 
     // Write header.
     const int color_type = PngChannelCountToColorType(channel_count);
@@ -200,27 +204,42 @@ class PngWriter {
     for (size_t y = 0; y != height; ++y) {
       rows[y] = const_cast<png_bytep>(&data[row_stride * y]);
     }
-    png_write_image(png_, const_cast<png_bytep*>(rows.data()));
+
+    // Rows are written in batches so cancellation is checked periodically
+    // during long encodes at high compression levels.
+    for (size_t y = 0; y < height; y += kRowsPerCancelCheck) {
+      if (cancel && cancel->IsCancelled()) {
+        return false;
+      }
+      const size_t row_count =
+          std::min(kRowsPerCancelCheck, static_cast<size_t>(height) - y);
+      png_write_rows(png_, rows.data() + y,
+                     static_cast<png_uint_32>(row_count));
+    }
 
     png_write_end(png_, nullptr);
     return true;
   }
 
  private:
-  FILE* fp_;
   png_struct* png_;
   png_info* info_;
+  std::vector<uint8_t>* out_png_;
+
+  static void WriteCallback(
+      png_struct* png, png_byte* bytes, png_size_t byte_count) {
+    PngWriter* const encoder = static_cast<PngWriter*>(png_get_io_ptr(png));
+    encoder->out_png_->insert(
+        encoder->out_png_->end(), bytes, bytes + byte_count);
+  }
 
   void Reset() {
-    if (fp_) {
-      fclose(fp_);
-      fp_ = nullptr;
-    }
     if (png_) {
       png_destroy_write_struct(&png_, &info_);
       png_ = nullptr;
       info_ = nullptr;
     }
+    out_png_ = nullptr;
   }
 };
 }  // namespace
@@ -241,10 +260,28 @@ bool PngRead(
       logger);
 }
 
+bool PngEncode(
+    uint32_t width, uint32_t height, uint8_t channel_count,
+    const Image::Component* data, int level,
+    std::vector<uint8_t>* out_png, Logger* logger, const CancelToken* cancel) {
+  PngWriter writer;
+  return writer.Encode(
+      width, height, channel_count, data, level, out_png, logger, cancel);
+}
+
 bool PngWrite(
     const char* path, uint32_t width, uint32_t height, uint8_t channel_count,
-    const Image::Component* data, int level, Logger* logger) {
-  PngWriter writer;
-  return writer.Write(path, width, height, channel_count, data, level, logger);
+    const Image::Component* data, int level, Logger* logger,
+    const CancelToken* cancel) {
+  std::vector<uint8_t> png;
+  if (!PngEncode(width, height, channel_count, data, level, &png, logger,
+                 cancel)) {
+    return false;
+  }
+  if (!GltfDiskWriteBinary(path, png.data(), png.size())) {
+    Log<UFG_ERROR_IO_WRITE_IMAGE>(logger, "", path);
+    return false;
+  }
+  return true;
 }
 }  // namespace ufg
@@ -28,9 +28,17 @@ bool PngRead(
     std::vector<Image::Component>* out_buffer, Logger* logger);
 
 // * level: PNG compression level [0=fastest, 9=smallest].
+// * cancel: Optional token polled during encoding. Encoding fails without
+//   logging an error if it's cancelled.
+bool PngEncode(
+    uint32_t width, uint32_t height, uint8_t channel_count,
+    const Image::Component* data, int level,
+    std::vector<uint8_t>* out_png, Logger* logger,
+    const CancelToken* cancel = nullptr);
 bool PngWrite(
     const char* path, uint32_t width, uint32_t height, uint8_t channel_count,
-    const Image::Component* data, int level, Logger* logger);
+    const Image::Component* data, int level, Logger* logger,
+    const CancelToken* cancel = nullptr);
 }  // namespace ufg
 
 #endif  // UFG_PROCESS_IMAGE_PNG_H_
@@ -23,15 +23,25 @@
 
 namespace ufg {
 namespace {
+// Temporary per-primitive buffers, retained between primitives (and
+// conversions on the same thread) to avoid reallocating them for each one.
+struct PrimScratch {
+  std::vector<uint32_t> indices;
+  std::vector<uint32_t> tri_indices;
+  std::vector<bool> orig_verts_used;
+  std::vector<uint32_t> orig_to_used_vert_map;
+};
+
 void ConvertToTriangles(Gltf::Mesh::Primitive::Mode prim_mode,
-                        std::vector<uint32_t>* indices) {
+                        std::vector<uint32_t>* indices,
+                        std::vector<uint32_t>* buffer) {
   UFG_ASSERT_LOGIC(Gltf::HasTriangles(prim_mode));
   const uint32_t src_count = static_cast<uint32_t>(indices->size());
   const uint32_t* const src_indices = indices->data();
   UFG_ASSERT_FORMAT(src_count >= 3);
   const uint32_t dst_count = 3 * (src_count - 2);
-  std::vector<uint32_t> buffer(dst_count);
-  uint32_t* const dst_indices = buffer.data();
+  buffer->resize(dst_count);
+  uint32_t* const dst_indices = buffer->data();
   const uint32_t* const src_end = src_indices + src_count - 2;
   const uint32_t* src = src_indices;
   uint32_t* dst = dst_indices;
@@ -74,12 +84,13 @@ void ConvertToTriangles(Gltf::Mesh::Primitive::Mode prim_mode,
     UFG_ASSERT_LOGIC(false);
     return;
   }
-  indices->swap(buffer);
+  indices->swap(*buffer);
 }
 
 void GetMeshIndices(
     const Gltf& gltf, const Gltf::Mesh::Primitive& prim, size_t vert_count,
-    GltfCache* gltf_cache, std::vector<uint32_t>* out_indices) {
+    GltfCache* gltf_cache, PrimScratch* scratch) {
+  std::vector<uint32_t>* const out_indices = &scratch->indices;
   if (prim.indices != Gltf::Id::kNull) {
     // Indexed geometry. Read it from a buffer.
     size_t index_count, component_count;
@@ -99,7 +110,7 @@ void GetMeshIndices(
     }
   }
   if (prim.mode != Gltf::Mesh::Primitive::kModeTriangles) {
-    ConvertToTriangles(prim.mode, out_indices);
+    ConvertToTriangles(prim.mode, out_indices, &scratch->tri_indices);
   }
 }
 
@@ -197,8 +208,7 @@ size_t GetMeshInfoFromDraco(
     const void* draco_data, size_t draco_size,
     const Gltf::Mesh::AttributeSet& attrs, Gltf::Id mesh_id,
     const Gltf::Mesh& mesh, size_t prim_index,
-    PrimInfo* out_info, std::vector<uint32_t>* out_indices,
-    std::vector<bool>* out_orig_verts_used, Logger* logger) {
+    PrimInfo* out_info, PrimScratch* scratch, Logger* logger) {
   draco::Decoder decoder;
   draco::DecoderBuffer decoder_buffer;
   decoder_buffer.Init(static_cast<const char*>(draco_data), draco_size);
@@ -226,8 +236,8 @@ size_t GetMeshInfoFromDraco(
   // Convert triangle Face structures to indices.
   const uint32_t tri_count = draco_mesh.num_faces();
   const uint32_t index_count = 3 * tri_count;
-  out_indices->resize(index_count);
-  uint32_t* const indices = out_indices->data();
+  scratch->indices.resize(index_count);
+  uint32_t* const indices = scratch->indices.data();
   for (uint32_t tri_index = 0; tri_index != tri_count; ++tri_index) {
     uint32_t* const tri = indices + 3 * tri_index;
     const draco::Mesh::Face& face =
@@ -239,7 +249,7 @@ size_t GetMeshInfoFromDraco(
 
   // Get the set of used verts.
   const uint32_t orig_vert_count = draco_mesh.num_points();
-  std::vector<bool> orig_verts_used(orig_vert_count, false);
+  std::vector<bool>& orig_verts_used = scratch->orig_verts_used;
   const size_t used_vert_count =
       GetUsedPoints(orig_vert_count, indices, index_count, &orig_verts_used);
 
@@ -329,14 +339,61 @@ size_t GetMeshInfoFromDraco(
     out_info->skin_weights.swap(skin_weights);
   }
 
-  out_orig_verts_used->swap(orig_verts_used);
   return used_vert_count;
 }
 
+// Copy morph target deltas for used vertices. Returns false if the target
+// doesn't have the attribute.
+bool CopyMorphDeltas(
+    const Gltf& gltf, const Gltf::Mesh::AttributeSet& attrs,
+    const Gltf::Mesh::Attribute& key, const std::vector<bool>& used,
+    size_t used_vert_count, GltfCache* gltf_cache,
+    VtArray<GfVec3f>* out_deltas) {
+  const auto found = attrs.find(key);
+  if (found == attrs.end()) {
+    return false;
+  }
+  const Gltf::Accessor& accessor =
+      *UFG_VERIFY(Gltf::GetById(gltf.accessors, found->accessor));
+  UFG_ASSERT_FORMAT(accessor.count == used.size());
+  if (!CopyAccessorToVectors(gltf, attrs, key, used, gltf_cache, out_deltas)) {
+    return false;
+  }
+  UFG_ASSERT_FORMAT(out_deltas->size() == used_vert_count);
+  return true;
+}
+
+void GetPrimTargets(
+    const Gltf& gltf, const Gltf::Mesh::Primitive& prim,
+    const std::vector<bool>& orig_verts_used, size_t used_vert_count,
+    GltfCache* gltf_cache, PrimInfo* out_info) {
+  const size_t target_count = prim.targets.size();
+  std::vector<MorphTargetInfo> targets(target_count);
+  VtArray<GfVec3f> pos_deltas;
+  VtArray<GfVec3f> norm_deltas;
+  for (size_t target_index = 0; target_index != target_count; ++target_index) {
+    const Gltf::Mesh::AttributeSet& attrs = prim.targets[target_index];
+    if (!CopyMorphDeltas(gltf, attrs, Gltf::Mesh::kAttributePosition,
+                         orig_verts_used, used_vert_count, gltf_cache,
+                         &pos_deltas)) {
+      pos_deltas.assign(used_vert_count, GfVec3f(0.0f));
+    }
+    const bool have_norm_deltas =
+        !out_info->norm.empty() &&
+        CopyMorphDeltas(gltf, attrs, Gltf::Mesh::kAttributeNormal,
+                        orig_verts_used, used_vert_count, gltf_cache,
+                        &norm_deltas);
+    GetMorphTargetInfo(used_vert_count, pos_deltas.data(),
+                       have_norm_deltas ? norm_deltas.data() : nullptr,
+                       kMorphDeltaTol, &targets[target_index]);
+  }
+  out_info->targets.swap(targets);
+}
+
 bool GetPrimInfo(
     const Gltf& gltf, Gltf::Id mesh_id, const Gltf::Mesh& mesh,
-    size_t prim_index,
-    GltfCache* gltf_cache, PrimInfo* out_info, Logger* logger) {
+    size_t prim_index, GltfCache* gltf_cache, PrimScratch* scratch,
+    PrimInfo* out_info, Logger* logger) {
   const Gltf::Mesh::Primitive& prim = mesh.primitives[prim_index];
   if (!Gltf::HasTriangles(prim.mode)) {
     Log<UFG_WARN_NON_TRIANGLES>(
@@ -350,8 +407,8 @@ bool GetPrimInfo(
   // The Draco mesh (if present) contains a subset of vertex attributes. So we
   // first decode attributes from the Draco mesh, then load any additional ones
   // from the glTF structures.
-  std::vector<uint32_t> indices;
-  std::vector<bool> orig_verts_used;
+  const std::vector<uint32_t>& indices = scratch->indices;
+  const std::vector<bool>& orig_verts_used = scratch->orig_verts_used;
   size_t used_vert_count;
   if (prim.draco.bufferView != Gltf::Id::kNull) {
     // Decompress mesh indices and all vertex attributes.
@@ -365,7 +422,7 @@ bool GetPrimInfo(
     }
     used_vert_count = GetMeshInfoFromDraco(
         draco_data, draco_size, prim.draco.attributes, mesh_id, mesh,
-        prim_index, out_info, &indices, &orig_verts_used, logger);
+        prim_index, out_info, scratch, logger);
     if (used_vert_count == 0) {
       return false;
     }
@@ -381,15 +438,17 @@ bool GetPrimInfo(
     const Gltf::Accessor& pos_accessor =
         *UFG_VERIFY(Gltf::GetById(gltf.accessors, pos_attr.accessor));
     const uint32_t orig_vert_count = pos_accessor.count;
-    GetMeshIndices(gltf, prim, orig_vert_count, gltf_cache, &indices);
-    orig_verts_used.resize(orig_vert_count, false);
-    used_vert_count = GetUsedPoints(
-        orig_vert_count, indices.data(), indices.size(), &orig_verts_used);
+    GetMeshIndices(gltf, prim, orig_vert_count, gltf_cache, scratch);
+    used_vert_count = GetUsedPoints(orig_vert_count, indices.data(),
+                                    indices.size(), &scratch->orig_verts_used);
   }
 
   // Create mapping from original to used verts.
   const size_t orig_vert_count = orig_verts_used.size();
-  std::vector<uint32_t> orig_to_used_vert_map(orig_vert_count, kNoIndex);
+  out_info->src_vert_count = orig_vert_count;
+  std::vector<uint32_t>& orig_to_used_vert_map =
+      scratch->orig_to_used_vert_map;
+  orig_to_used_vert_map.assign(orig_vert_count, kNoIndex);
   for (uint32_t orig_vi = 0, used_vi = 0; orig_vi != orig_vert_count;
        ++orig_vi) {
     if (orig_verts_used[orig_vi]) {
@@ -486,6 +545,18 @@ bool GetPrimInfo(
     }
   }
 
+  // Copy morph targets. These are stored outside of any Draco stream, which
+  // reorders vertices, so we can only match them to uncompressed vertices.
+  if (!prim.targets.empty()) {
+    if (prim.draco.bufferView != Gltf::Id::kNull) {
+      Log<UFG_WARN_DRACO_MORPH_TARGETS>(
+          logger, "", Gltf::IdToIndex(mesh_id), prim_index, mesh.name.c_str());
+    } else {
+      GetPrimTargets(gltf, prim, orig_verts_used, used_vert_count, gltf_cache,
+                     out_info);
+    }
+  }
+
   return true;
 }
 }  // namespace
@@ -493,7 +564,8 @@ bool GetPrimInfo(
 size_t GetUsedPoints(
     size_t pos_count, const uint32_t* indices, size_t count,
     std::vector<bool>* out_used) {
-  std::vector<bool> used(pos_count, false);
+  std::vector<bool>& used = *out_used;
+  used.assign(pos_count, false);
   size_t point_count = 0;
   const uint32_t* const end = indices + count;
   for (const uint32_t* it = indices; it != end; ++it) {
@@ -504,7 +576,6 @@ size_t GetUsedPoints(
       ++point_count;
     }
   }
-  out_used->swap(used);
   return point_count;
 }
 
@@ -531,6 +602,73 @@ void GetTriIndices(
   out_vert_indices->swap(vert_indices);
 }
 
+void GetMorphTargetInfo(size_t vert_count, const GfVec3f* pos_deltas,
+                        const GfVec3f* norm_deltas, float tol,
+                        MorphTargetInfo* out_info) {
+  // Flag moved vertices in branch-free passes over the flat delta components,
+  // so the compiler can vectorize them.
+  std::vector<uint8_t> moved(vert_count);
+  const float* const pos = pos_deltas->data();
+  for (size_t i = 0; i != vert_count; ++i) {
+    const float* const d = pos + 3 * i;
+    moved[i] = (std::abs(d[0]) > tol) | (std::abs(d[1]) > tol) |
+               (std::abs(d[2]) > tol);
+  }
+  if (norm_deltas) {
+    const float* const norm = norm_deltas->data();
+    for (size_t i = 0; i != vert_count; ++i) {
+      const float* const d = norm + 3 * i;
+      moved[i] |= (std::abs(d[0]) > tol) | (std::abs(d[1]) > tol) |
+                  (std::abs(d[2]) > tol);
+    }
+  }
+  size_t moved_count = 0;
+  for (size_t i = 0; i != vert_count; ++i) {
+    moved_count += moved[i];
+  }
+
+  MorphTargetInfo info;
+  const size_t vec_count = norm_deltas ? 2 : 1;
+  const size_t sparse_size =
+      moved_count * (vec_count * sizeof(GfVec3f) + sizeof(int));
+  const size_t dense_size = vert_count * vec_count * sizeof(GfVec3f);
+  if (sparse_size >= dense_size) {
+    info.offsets.resize(vert_count);
+    std::copy(pos_deltas, pos_deltas + vert_count, info.offsets.data());
+    if (norm_deltas) {
+      info.normal_offsets.resize(vert_count);
+      std::copy(norm_deltas, norm_deltas + vert_count,
+                info.normal_offsets.data());
+    }
+  } else {
+    // An empty index list denotes dense offsets, so keep a single (zero) offset
+    // for targets that don't move anything.
+    if (moved_count == 0) {
+      moved[0] = 1;
+      moved_count = 1;
+    }
+    info.point_indices.resize(moved_count);
+    info.offsets.resize(moved_count);
+    if (norm_deltas) {
+      info.normal_offsets.resize(moved_count);
+    }
+    size_t dst = 0;
+    for (size_t i = 0; i != vert_count; ++i) {
+      if (!moved[i]) {
+        continue;
+      }
+      info.point_indices[dst] = static_cast<int>(i);
+      info.offsets[dst] = pos_deltas[i];
+      if (norm_deltas) {
+        info.normal_offsets[dst] = norm_deltas[i];
+      }
+      ++dst;
+    }
+    UFG_ASSERT_LOGIC(dst == moved_count);
+  }
+  out_info->Swap(&info);
+}
+
 void PrimInfo::Swap(PrimInfo* other) {
   tri_vert_counts.swap(other->tri_vert_counts);
   tri_vert_indices.swap(other->tri_vert_indices);
@@ -544,18 +682,44 @@ void PrimInfo::Swap(PrimInfo* other) {
   color4.swap(other->color4);
   skin_indices.swap(other->skin_indices);
   skin_weights.swap(other->skin_weights);
+  targets.swap(other->targets);
+  std::swap(src_vert_count, other->src_vert_count);
+}
+
+size_t PrimInfo::GetDataSize() const {
+  size_t size =
+      tri_vert_counts.size() * sizeof(int) +
+      tri_vert_indices.size() * sizeof(int) +
+      pos.size() * sizeof(GfVec3f) +
+      norm.size() * sizeof(GfVec3f) +
+      color3.size() * sizeof(GfVec3f) +
+      color4.size() * sizeof(GfVec4f) +
+      skin_indices.capacity() * sizeof(int) +
+      skin_weights.capacity() * sizeof(float);
+  for (const auto& uvset_kv : uvs) {
+    size += uvset_kv.second.size() * sizeof(GfVec2f);
+  }
+  for (const MorphTargetInfo& target : targets) {
+    size += target.point_indices.size() * sizeof(int) +
+            target.offsets.size() * sizeof(GfVec3f) +
+            target.normal_offsets.size() * sizeof(GfVec3f);
+  }
+  return size;
 }
 
 void GetMeshInfo(
     const Gltf& gltf, Gltf::Id mesh_id,
-    GltfCache* gltf_cache, MeshInfo* out_info, Logger* logger) {
+    GltfCache* gltf_cache, MeshInfo* out_info, Logger* logger,
+    const CancelToken* cancel) {
   const Gltf::Mesh& mesh = *UFG_VERIFY(Gltf::GetById(gltf.meshes, mesh_id));
   const size_t prim_count = mesh.primitives.size();
   out_info->prims.resize(prim_count);
+  thread_local PrimScratch scratch;
   for (size_t prim_index = 0; prim_index != prim_count; ++prim_index) {
+    CheckCancel(cancel);
     PrimInfo prim_info;
-    if (GetPrimInfo(
-            gltf, mesh_id, mesh, prim_index, gltf_cache, &prim_info, logger)) {
+    if (GetPrimInfo(gltf, mesh_id, mesh, prim_index, gltf_cache, &scratch,
+                    &prim_info, logger)) {
       out_info->prims[prim_index].Swap(&prim_info);
     }
   }
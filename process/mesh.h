@@ -18,6 +18,7 @@
 #define UFG_PROCESS_MESH_H_
 
 #include <limits>
+#include "common/cancel.h"
 #include "common/common.h"
 #include "common/logging.h"
 #include "gltf/cache.h"
@@ -51,6 +52,30 @@ void ReverseTriWinding(T* indices, size_t count) {
   }
 }
 
+// Sparse morph target deltas, in the same vertex order as PrimInfo::pos.
+// * point_indices is empty if offsets are dense (one per vertex).
+// * normal_offsets is empty if the target has no normal deltas, otherwise it
+//   parallels offsets.
+struct MorphTargetInfo {
+  VtArray<int> point_indices;
+  VtArray<GfVec3f> offsets;
+  VtArray<GfVec3f> normal_offsets;
+
+  void Swap(MorphTargetInfo* other) {
+    point_indices.swap(other->point_indices);
+    offsets.swap(other->offsets);
+    normal_offsets.swap(other->normal_offsets);
+  }
+};
+
+// Extract sparse morph target deltas, dropping vertices whose position and
+// normal deltas are all within tol. Falls back to dense offsets when most
+// vertices move, since the indices would then cost more than they save.
+// * norm_deltas may be null.
+void GetMorphTargetInfo(size_t vert_count, const GfVec3f* pos_deltas,
+                        const GfVec3f* norm_deltas, float tol,
+                        MorphTargetInfo* out_info);
+
 struct PrimInfo {
   using Uvset = VtArray<GfVec2f>;
   using UvsetMap = std::map<Gltf::Mesh::Attribute::Number, Uvset>;
@@ -66,16 +91,36 @@ struct PrimInfo {
   VtArray<GfVec4f> color4;
   std::vector<int> skin_indices;
   std::vector<float> skin_weights;
+  std::vector<MorphTargetInfo> targets;
+
+  // Vertex count in the source, before removing vertices unreferenced by
+  // indices.
+  size_t src_vert_count = 0;
 
   void Swap(PrimInfo* other);
+
+  // Get the bytes held by vertex and index arrays.
+  size_t GetDataSize() const;
 };
 
 struct MeshInfo {
   std::vector<PrimInfo> prims;
+
+  size_t GetDataSize() const {
+    size_t size = 0;
+    for (const PrimInfo& prim : prims) {
+      size += prim.GetDataSize();
+    }
+    return size;
+  }
 };
 
+// Decode primitives for a mesh.
+// * Throws CancelException if the cancel token (which may be null) is
+//   cancelled.
 void GetMeshInfo(const Gltf& gltf, Gltf::Id mesh_id, GltfCache* gltf_cache,
-                 MeshInfo* out_info, Logger* logger);
+                 MeshInfo* out_info, Logger* logger,
+                 const CancelToken* cancel = nullptr);
 }  // namespace ufg
 
 #endif  // UFG_PROCESS_MESH_H_
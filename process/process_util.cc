@@ -34,13 +34,16 @@ void MarkUsedDescendants(
     const Gltf& gltf, const Gltf::Id root_id,
     const std::vector<std::string>& remove_node_prefixes,
     std::vector<bool>* nodes_used) {
-  if (!IsIncludedNode(gltf, root_id, remove_node_prefixes)) {
-    return;
-  }
-  const Gltf::Node& root_node = *UFG_VERIFY(Gltf::GetById(gltf.nodes, root_id));
-  (*nodes_used)[Gltf::IdToIndex(root_id)] = true;
-  for (const Gltf::Id child_id : root_node.children) {
-    MarkUsedDescendants(gltf, child_id, remove_node_prefixes, nodes_used);
+  std::vector<Gltf::Id> pending(1, root_id);
+  while (!pending.empty()) {
+    const Gltf::Id node_id = pending.back();
+    pending.pop_back();
+    if (!IsIncludedNode(gltf, node_id, remove_node_prefixes)) {
+      continue;
+    }
+    const Gltf::Node& node = *UFG_VERIFY(Gltf::GetById(gltf.nodes, node_id));
+    (*nodes_used)[Gltf::IdToIndex(node_id)] = true;
+    pending.insert(pending.end(), node.children.begin(), node.children.end());
   }
 }
 }  // namespace
@@ -107,14 +110,16 @@ std::vector<uint16_t> GetJointRoots(
 void MarkAffectedNodes(
     const std::vector<Gltf::Node>& nodes, Gltf::Id node_id,
     std::vector<bool>* affected_node_ids) {
-  const size_t node_index = Gltf::IdToIndex(node_id);
-  if ((*affected_node_ids)[node_index]) {
-    return;
-  }
-  (*affected_node_ids)[node_index] = true;
-  const Gltf::Node& node = nodes[node_index];
-  for (const Gltf::Id child_node_id : node.children) {
-    MarkAffectedNodes(nodes, child_node_id, affected_node_ids);
+  std::vector<Gltf::Id> pending(1, node_id);
+  while (!pending.empty()) {
+    const size_t node_index = Gltf::IdToIndex(pending.back());
+    pending.pop_back();
+    if ((*affected_node_ids)[node_index]) {
+      continue;
+    }
+    (*affected_node_ids)[node_index] = true;
+    const Gltf::Node& node = nodes[node_index];
+    pending.insert(pending.end(), node.children.begin(), node.children.end());
   }
 }
 
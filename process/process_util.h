@@ -28,7 +28,7 @@ using PXR_NS::VtArray;
 
 std::vector<Gltf::Id> GetNodeParents(const std::vector<Gltf::Node>& nodes);
 
-// Recursively mark this node and its descendants as affected.
+// Mark this node and its descendants as affected.
 void MarkAffectedNodes(
     const std::vector<Gltf::Node>& nodes, Gltf::Id node_id,
     std::vector<bool>* affected_node_ids);
@@ -75,7 +75,10 @@ size_t MarkSkinsUsed(
     const std::vector<Gltf::Id>& node_ids, const std::vector<Gltf::Node>& nodes,
     std::vector<bool>* skins_used) {
   size_t total = 0;
-  for (const Gltf::Id node_id : node_ids) {
+  std::vector<Gltf::Id> pending(node_ids.begin(), node_ids.end());
+  while (!pending.empty()) {
+    const Gltf::Id node_id = pending.back();
+    pending.pop_back();
     const Gltf::Node& node = *UFG_VERIFY(Gltf::GetById(nodes, node_id));
     if (node.skin != Gltf::Id::kNull) {
       const size_t skin_index = Gltf::IdToIndex(node.skin);
@@ -84,7 +87,7 @@ size_t MarkSkinsUsed(
         ++total;
       }
     }
-    total += MarkSkinsUsed(node.children, nodes, skins_used);
+    pending.insert(pending.end(), node.children.begin(), node.children.end());
   }
   return total;
 }
@@ -119,6 +122,7 @@ void MergeSkinInfos(
   for (size_t node_i = 0; node_i != node_count; ++node_i) {
     if (nodes_used[node_i]) {
       const size_t ujoint_index = ujoint_to_node_map.size();
+      UFG_ASSERT_FORMAT(ujoint_index < SkinInfluence::kUnused);
       ujoint_to_node_map.push_back(Gltf::IndexToId(node_i));
       node_to_ujoint_map[node_i] = static_cast<uint16_t>(ujoint_index);
     }
@@ -251,6 +255,7 @@ void GetSkinInfo(
     std::vector<uint16_t>* out_gjoint_to_ujoint_map) {
   const Gltf::Skin& skin = *UFG_VERIFY(Gltf::GetById(gltf.skins, skin_id));
   const size_t gjoint_count = skin.joints.size();
+  UFG_ASSERT_FORMAT(gjoint_count <= SkinInfluence::kUnused);
 
   // Determine which joints are referenced by any mesh.
   std::vector<bool> gjoints_used(gjoint_count, false);
@@ -293,7 +298,7 @@ void GetSkinInfo(
   // * Note, we can't use skin.skeleton for this because it's unreliable (some
   //   GLTFs don't set it or set it incorrectly).
   constexpr Gltf::Id kIdUnset =
-      static_cast<Gltf::Id>(static_cast<int>(Gltf::Id::kNull) - 1);
+      Gltf::IndexToId(Gltf::IdToIndex(Gltf::Id::kNull) - 1);
   Gltf::Id root_node_id = kIdUnset;
   for (size_t gjoint_i = 0; gjoint_i != gjoint_count; ++gjoint_i) {
     const Gltf::Id node_id = skin.joints[gjoint_i];
@@ -340,6 +345,7 @@ void GetSkinInfo(
     }
   }
   const size_t ujoint_count = ujoint_to_node_map.size();
+  UFG_ASSERT_FORMAT(ujoint_count <= SkinInfluence::kUnused);
 
   // Sort USD-joints by hierarchy (for whatever reason, GLTF nodes aren't
   // already sorted this way). This is required by the iOS viewer (and is likely
@@ -482,7 +488,9 @@ bool GetSkinData(
 
   // Copy to skin bindings and keep track of which nodes are actually
   // referenced.
-  std::vector<SkinBinding> bindings(vert_count);
+  // Bindings are written in-place so callers may reuse out_skin_data storage.
+  std::vector<SkinBinding>& bindings = out_skin_data->bindings;
+  bindings.resize(vert_count);
   size_t influence_count = 0;
   {
     const int* index_it = indices;
@@ -519,7 +527,6 @@ bool GetSkinData(
 
   out_skin_data->influence_count = static_cast<uint8_t>(influence_count);
   out_skin_data->is_rigid = is_rigid;
-  out_skin_data->bindings.swap(bindings);
   return true;
 }
 
@@ -25,6 +25,9 @@
 namespace ufg {
 using PXR_NS::TfToken;
 
+// Joint indices are 16-bit, matching the range of glTF JOINTS_n attributes, to
+// keep skin bindings and joint maps compact. Skins with more joints are
+// rejected as malformed.
 struct SkinInfluence {
   static constexpr uint16_t kUnused = 0xffffu;
 
@@ -26,6 +26,9 @@ Typical usages:
   ufgbatch.py all.csv
   ufgbatch.py all.csv -t usda
   ufgbatch.py all.csv -t usdz
+  ufgbatch.py all.csv --report corpus_report.json
+  ufgbatch.py all.csv --timeout 300
+  ufgbatch.py all.csv --incremental
 """
 
 from __future__ import print_function
@@ -79,7 +82,8 @@ def main():
   tag_tracker = util.TagTracker()
   (_, failed_tasks, _) = run_conversion(csv_tasks, tasks, args.exe, exe_args,
                                         ext, in_path, out_path, csv_names,
-                                        process_count, '', '', tag_tracker)
+                                        process_count, '', '', tag_tracker,
+                                        args.report, args.incremental)
   if failed_tasks:
     return 1
   else:
@@ -132,6 +136,17 @@ def parse_args():
         type=str,
         default='',
         help='Output USD directory.')
+    parser.add_argument(
+        '--report',
+        type=str,
+        default=None,
+        help='Write per-model JSON reports and aggregate them to this path.')
+    parser.add_argument(
+        '--incremental',
+        default=False,
+        action='store_true',
+        help='Skip models whose inputs, arguments, and converter version are '
+        'unchanged since their last successful conversion.')
     parser.add_argument(
         '--processes',
         type=int,
@@ -0,0 +1,132 @@
+#!/usr/bin/python
+#
+# Copyright 2019 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Incremental conversion using dependency manifests (usd_from_gltf --manifest).
+
+A task is up to date if its manifest was written by the same converter version
+with the same settings digest, every output converted successfully and still
+exists, every input file has the same size and SHA-256 hash, and every input
+recorded as missing still doesn't exist.
+"""
+
+from __future__ import print_function
+
+import hashlib
+import json
+import os
+import subprocess
+
+from . import util
+
+HASH_CHUNK_SIZE = 1 << 20
+
+
+def get_task_manifest_path(task_out_path):
+  """Get the manifest path written by a task, given its output USD path."""
+  (base, _) = os.path.splitext(task_out_path)
+  return base + '_manifest.json'
+
+
+def get_output_paths(task_out_path):
+  """Get the files written for an output path (.usd- writes usda and usdz)."""
+  (base, ext) = os.path.splitext(task_out_path)
+  if ext.lower() == '.usd-':
+    return [base + '.usda', base + '.usdz']
+  return [task_out_path]
+
+
+def get_file_hash(path):
+  """Get the SHA-256 hex digest of a file, or None if it can't be read."""
+  digest = hashlib.sha256()
+  try:
+    with open(path, 'rb') as src_file:
+      while True:
+        chunk = src_file.read(HASH_CHUNK_SIZE)
+        if not chunk:
+          break
+        digest.update(chunk)
+  except (IOError, OSError):
+    return None
+  return digest.hexdigest()
+
+
+class DigestCache(object):
+  """Caches converter version and settings digest per argument list."""
+
+  def __init__(self, exe):
+    self.exe = exe
+    self.digests = {}
+
+  def get(self, args):
+    """Get (version, settings_digest) for the arguments, or None on error."""
+    key = tuple(args)
+    if key not in self.digests:
+      cmd_args = [self.exe, '--print_digest', '--nousage'] + list(args)
+      try:
+        output = subprocess.check_output(cmd_args, stderr=subprocess.STDOUT)
+        fields = output.decode(errors='ignore').split()
+        digest = (fields[0], fields[1]) if len(fields) == 2 else None
+      except (OSError, subprocess.CalledProcessError):
+        digest = None
+      self.digests[key] = digest
+    return self.digests[key]
+
+
+def input_matches(entry):
+  """Returns true if an input file is unchanged since the manifest entry."""
+  path = entry.get('path')
+  if not path:
+    return False
+  if entry.get('missing', False):
+    # The converter looked for this file and didn't find it, so creating it
+    # may change the output.
+    return not os.path.exists(path)
+  expected_hash = entry.get('sha256')
+  if not path or not expected_hash or not os.path.isfile(path):
+    return False
+  # Check size first, to avoid hashing files that obviously changed.
+  if os.path.getsize(path) != entry.get('size'):
+    return False
+  return get_file_hash(path) == expected_hash
+
+
+def is_task_up_to_date(manifest_path, task_out_path, digest):
+  """Returns true if the task's manifest shows its output is current."""
+  if not digest or not os.path.isfile(manifest_path):
+    return False
+  for out_path in get_output_paths(task_out_path):
+    if not os.path.isfile(out_path):
+      return False
+  try:
+    with open(manifest_path, 'r') as manifest_file:
+      manifest = json.load(manifest_file)
+  except ValueError:
+    util.warn('Failed parsing manifest: %s' % manifest_path)
+    return False
+  (version, settings_digest) = digest
+  if (manifest.get('version') != version or
+      manifest.get('settings_digest') != settings_digest):
+    return False
+  outputs = manifest.get('outputs', [])
+  if not outputs:
+    return False
+  for output in outputs:
+    if not output.get('success', False) or not output.get('inputs'):
+      return False
+    for entry in output['inputs']:
+      if not input_matches(entry):
+        return False
+  return True
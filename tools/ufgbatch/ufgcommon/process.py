@@ -24,6 +24,12 @@ import subprocess
 import time
 
 from . import util
+from .manifest import DigestCache
+from .manifest import get_task_manifest_path
+from .manifest import is_task_up_to_date
+from .report import get_task_report_path
+from .report import resolve_task_report_args
+from .report import write_aggregate_report
 from .util import join_path
 from .util import status
 
@@ -51,13 +57,14 @@ def get_process_count(recommended_count, process_max, num_tasks):
 
 def run_conversion(csv_tasks, tasks, exe, exe_args, ext, in_path, out_path,
                    csv_names, process_count, log_path, result_path,
-                   tag_tracker):
+                   tag_tracker, report_path=None, incremental=False):
   """Runs the processes to convert files to the target format."""
   # Convert usda and/or usdz files.
   start_time = time.time()
   (complete_tasks, failed_tasks, logs,
    results) = run_tasks(tasks, exe, exe_args, ext, in_path, out_path,
-                        len(csv_names), process_count)
+                        len(csv_names), process_count, bool(report_path),
+                        incremental)
   task_end_time = time.time()
 
   # Gather message tags.
@@ -74,6 +81,9 @@ def run_conversion(csv_tasks, tasks, exe, exe_args, ext, in_path, out_path,
   tag_summary = tag_tracker.get_summary_suffix(True)
   status('Converted %s files in %.2fs. %s failed.%s' %
          (len(complete_tasks), task_delta_time, len(failed_tasks), tag_summary))
+  if incremental:
+    skipped_count = sum(1 for task in tasks if task.skipped)
+    status('Skipped %s up-to-date files.' % skipped_count)
 
   # Write per-CSV output.
   for csv_index, csv_name in enumerate(csv_names):
@@ -111,6 +121,9 @@ def run_conversion(csv_tasks, tasks, exe, exe_args, ext, in_path, out_path,
   status(STATS_HEADER, util.LOG_COLOR_CYAN)
   tag_stats = tag_tracker.get_per_tag_stats(True)
   status(tag_stats)
+
+  if report_path:
+    write_aggregate_report(tasks, report_path)
   return (complete_tasks, failed_tasks, task_delta_time)
 
 
@@ -175,7 +188,7 @@ def wait_for_all_processes(processes):
 
 
 def run_tasks(tasks, exe, exe_args, ext, in_path, out_path, csv_count,
-              process_count):
+              process_count, write_reports=False, incremental=False):
   """Run all usd_from_gltf tasks.
 
   Args:
@@ -187,6 +200,9 @@ def run_tasks(tasks, exe, exe_args, ext, in_path, out_path, csv_count,
     out_path: Output USD root directory.
     csv_count: Number of CSV inputs.
     process_count: Max number of concurrent processes.
+    write_reports: Write a JSON report alongside each task output.
+    incremental: Write a dependency manifest alongside each task output, and
+      skip tasks whose manifest shows the output is up to date.
 
   Returns:
     complete_tasks: Tasks that completed successfully.
@@ -204,19 +220,33 @@ def run_tasks(tasks, exe, exe_args, ext, in_path, out_path, csv_count,
       util.make_directories(task_dir_path)
 
   # Spawn process for each task, up to process_count in parallel.
+  digest_cache = DigestCache(exe)
   section = None
   for task in tasks:
-    process_avail = wait_for_available_process(processes)
     if task.section != section:
       section = task.section
       status(TASK_SECTION_FORMAT % section, util.LOG_COLOR_CYAN)
     task_in_path = join_path(in_path, task.src)
     task_out_path = join_path(out_path, task.dst, task.name + ext)
     cmd_args = [exe, task_in_path, task_out_path]
+    setting_args = []
     if exe_args:
-      cmd_args += exe_args
+      setting_args += exe_args
     if task.args:
-      cmd_args += task.args
+      setting_args += resolve_task_report_args(task, out_path)
+    cmd_args += setting_args
+    if write_reports:
+      task.report_path = get_task_report_path(task_out_path)
+      cmd_args += ['--report', task.report_path]
+    if incremental:
+      manifest_path = get_task_manifest_path(task_out_path)
+      cmd_args += ['--manifest', manifest_path]
+      if is_task_up_to_date(manifest_path, task_out_path,
+                            digest_cache.get(setting_args)):
+        task.skip(get_process_command(cmd_args))
+        print(task.command + '  [up to date]')
+        continue
+    process_avail = wait_for_available_process(processes)
     # Disable usage text on argument errors to reduce spam.
     args = cmd_args + ['--nousage']
     process = subprocess.Popen(
@@ -0,0 +1,175 @@
+#!/usr/bin/python
+#
+# Copyright 2019 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Aggregation of per-model conversion reports (usd_from_gltf --report)."""
+
+from __future__ import print_function
+
+import json
+import os
+
+from . import util
+
+# Report fields summed across models.
+SUM_FIELDS = [
+    'bytes_read', 'bytes_written', 'nodes', 'meshes', 'prims', 'src_verts',
+    'used_verts', 'images_decoded', 'images_copied', 'images_resized',
+    'images_solid', 'anim_src_keys', 'anim_pruned_keys'
+]
+
+# Report fields that don't depend on timing or the machine, so they can be
+# included in task results diff'ed against goldens.
+RESULT_FIELDS = [
+    'nodes', 'meshes', 'prims', 'src_verts', 'used_verts', 'images_decoded',
+    'images_copied', 'images_resized', 'images_solid', 'anim_src_keys',
+    'anim_pruned_keys'
+]
+
+# Number of models listed in each of the slowest/largest rankings.
+TOP_COUNT = 10
+
+
+def get_task_report_path(task_out_path):
+  """Get the report path written by a task, given its output USD path."""
+  (base, _) = os.path.splitext(task_out_path)
+  return base + '_report.json'
+
+
+def resolve_task_report_args(task, out_path):
+  """Resolve a --report path given in a task's CSV arguments.
+
+  Relative paths are resolved against the output root rather than the task's
+  output directory, so reports (which contain timings) aren't diff'ed. The
+  task's result then includes the deterministic report fields instead.
+
+  Args:
+    task: The task, whose report_path is set if it has a --report argument.
+    out_path: Output USD root directory.
+
+  Returns:
+    The task's arguments, with the report path resolved.
+  """
+  args = list(task.args)
+  if '--report' not in args:
+    return args
+  path_index = args.index('--report') + 1
+  if path_index < len(args):
+    path = args[path_index]
+    if not os.path.isabs(path):
+      path = util.join_path(out_path, path)
+    args[path_index] = path
+    task.report_path = path
+    task.report_in_result = True
+  return args
+
+
+def get_report_result_text(report_path):
+  """Get deterministic report fields as text, for inclusion in results."""
+  try:
+    with open(report_path, 'r') as report_file:
+      reports = json.load(report_file).get('reports', [])
+  except (IOError, ValueError):
+    return '\n    Report: missing'
+  text = ''
+  for report in reports:
+    text += '\n    Report: ' + ', '.join(
+        '%s=%s' % (field, report.get(field, 0)) for field in RESULT_FIELDS)
+  return text
+
+
+def load_task_reports(tasks):
+  """Load per-task reports, returning (name, report) pairs."""
+  entries = []
+  for task in tasks:
+    if not task.report_path or not os.path.isfile(task.report_path):
+      continue
+    try:
+      with open(task.report_path, 'r') as report_file:
+        reports = json.load(report_file).get('reports', [])
+    except ValueError:
+      util.warn('Failed parsing report: %s' % task.report_path)
+      continue
+    for report in reports:
+      entries.append((task.name, report))
+  return entries
+
+
+def aggregate_reports(entries):
+  """Aggregate (name, report) pairs into corpus totals and rankings."""
+  totals = dict((field, 0) for field in SUM_FIELDS)
+  phase_totals = {}
+  peak_rss_max = 0
+  failed = 0
+  cancelled = {}
+  for (name, report) in entries:
+    for field in SUM_FIELDS:
+      totals[field] += report.get(field, 0)
+    for (phase, seconds) in report.get('phase_seconds', {}).items():
+      phase_totals[phase] = phase_totals.get(phase, 0.0) + seconds
+    peak_rss_max = max(peak_rss_max, report.get('peak_rss', 0))
+    if not report.get('success', False):
+      failed += 1
+    cancel_phase = report.get('cancel_phase')
+    if cancel_phase:
+      cancelled.setdefault(cancel_phase, []).append(name)
+
+  def get_total_seconds(report):
+    return sum(report.get('phase_seconds', {}).values())
+
+  slowest = sorted(entries, key=lambda e: get_total_seconds(e[1]),
+                   reverse=True)[:TOP_COUNT]
+  largest_rss = sorted(entries, key=lambda e: e[1].get('peak_rss', 0),
+                       reverse=True)[:TOP_COUNT]
+  return {
+      'model_count': len(entries),
+      'failed_count': failed,
+      'cancelled': cancelled,
+      'totals': totals,
+      'phase_seconds': phase_totals,
+      'peak_rss_max': peak_rss_max,
+      'slowest': [{
+          'name': name,
+          'seconds': get_total_seconds(report)
+      } for (name, report) in slowest],
+      'largest_rss': [{
+          'name': name,
+          'peak_rss': report.get('peak_rss', 0)
+      } for (name, report) in largest_rss],
+      'models': [{
+          'name': name,
+          'report': report
+      } for (name, report) in entries],
+  }
+
+
+def write_aggregate_report(tasks, path):
+  """Aggregate task reports and write them to a JSON file."""
+  aggregate = aggregate_reports(load_task_reports(tasks))
+  with open(path, 'w') as report_file:
+    json.dump(aggregate, report_file, indent=2, sort_keys=True)
+
+  # Print a brief summary.
+  phase_text = ', '.join(
+      '%s=%.2fs' % (phase, seconds)
+      for (phase, seconds) in sorted(aggregate['phase_seconds'].items()))
+  util.status('Report: %s models (%s failed). %s. Peak RSS: %.1f MiB.' %
+              (aggregate['model_count'], aggregate['failed_count'],
+               phase_text, aggregate['peak_rss_max'] / (1024.0 * 1024.0)))
+  for (phase, names) in sorted(aggregate['cancelled'].items()):
+    util.warn('  %s model(s) cancelled during %s: %s' %
+              (len(names), phase, ', '.join(names)))
+  util.status('  Writing report to: %s' % path)
+  return aggregate
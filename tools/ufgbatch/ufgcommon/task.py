@@ -23,6 +23,7 @@ import os
 import shlex
 
 from . import util
+from .report import get_report_result_text
 
 
 class Task(object):
@@ -35,11 +36,24 @@ class Task(object):
     self.args = args
     self.csv_index = csv_index
     self.section = section
+    # Path to the task's JSON report, if reports are enabled.
+    self.report_path = None
+    # Include report fields in the result, if the report was requested by the
+    # task's CSV arguments.
+    self.report_in_result = False
     # Task completion state.
     self.success = False
+    self.skipped = False
     self.command = None
     self.output = None
 
+  def skip(self, command):
+    """Mark the task complete without running it, as its output is current."""
+    self.success = True
+    self.skipped = True
+    self.command = command
+    self.output = None
+
   def format_output(self, in_path, out_path):
     """Format task output for logging."""
     if not self.output:
@@ -64,7 +78,10 @@ class Task(object):
     """Get result text (status plus output), suitable for diff'ing."""
     prefix = 'Success' if self.success else 'FAILURE'
     result = prefix + ' [' + self.name + '] ' + self.src + ' --> ' + self.dst
-    return result + self.format_output(in_path, out_path)
+    result += self.format_output(in_path, out_path)
+    if self.report_in_result and self.success and not self.skipped:
+      result += get_report_result_text(self.report_path)
+    return result
 
 
 def parse_tasks(fp, csv_index):
@@ -349,6 +349,25 @@ class TestDataReferenceDep(Dep):
     shutil.move(src_data_dir, dst_data_dir)
 
 
+class TestDataLocalDep(Dep):
+  """Installs test data kept in the usd_from_gltf source tree."""
+
+  def __init__(self):
+    Dep.__init__(self, 'TESTDATA_LOCAL')
+
+  def exists(self):
+    # It's small, so always copy it to pick up source changes.
+    return False
+
+  def install(self):
+    """Installs test data kept in the usd_from_gltf source tree."""
+    src_data_dir = os.path.join(cfg.ufg_src_dir, 'testdata', 'local')
+    dst_data_dir = os.path.join(cfg.src_dir, 'testdata', 'local')
+    if os.path.isdir(dst_data_dir):
+      shutil.rmtree(dst_data_dir)
+    shutil.copytree(src_data_dir, dst_data_dir)
+
+
 class UsdFromGltfDep(Dep):
   """Installs usd_from_gltf."""
 
@@ -373,6 +392,7 @@ ZLIB = ZlibDep()
 TCLAP = TclapDep()
 TESTDATA_SAMPLES = TestDataSamplesDep()
 TESTDATA_REFERENCE = TestDataReferenceDep()
+TESTDATA_LOCAL = TestDataLocalDep()
 USD_FROM_GLTF = UsdFromGltfDep()
 
 
@@ -388,7 +408,7 @@ def main():
   # Get the set of dependencies to install.
   deps = [DRACO, GIF, JPG, JSON, ZLIB, PNG, STB_IMAGE, TCLAP]
   if args.testdata:
-    deps += [TESTDATA_SAMPLES, TESTDATA_REFERENCE]
+    deps += [TESTDATA_SAMPLES, TESTDATA_REFERENCE, TESTDATA_LOCAL]
   installed_deps = []
   build_deps = []
   for dep in deps:
@@ -467,7 +487,7 @@ To rebuild or debug, open this project in Visual Studio:
     status("""
 Convert testdata with:
   cd {csv_dir}
-  python "{ufgtest_path}" samp_gltf.csv samp_glb.csv samp_embed.csv samp_draco.csv samp_specgloss.csv ref.csv -i "{in_dir}" -o "{out_dir}" --exe "{exe_path}" --nodiff --nodeploy"""
+  python "{ufgtest_path}" samp_gltf.csv samp_glb.csv samp_embed.csv samp_draco.csv samp_specgloss.csv ref.csv local.csv -i "{in_dir}" -o "{out_dir}" --exe "{exe_path}" --nodiff --nodeploy"""
            .format(
                csv_dir=os.path.join(cfg.ufg_src_dir, 'testdata'),
                ufgtest_path=os.path.join(cfg.ufg_src_dir, 'tools', 'ufgbatch',
@@ -16,8 +16,11 @@
 
 #include "args.h"  // NOLINT: Silence relative path warning.
 
+#include <string.h>
+#include <sstream>
 #include "common/common_util.h"
 #include "common/logging.h"
+#include "common/sha256.h"
 #include "gltf/disk_stream.h"
 #include "tclap/CmdLine.h"
 
@@ -41,6 +44,22 @@ const std::string& ToString(const std::string& v) {
   return v;
 }
 
+// Arguments that don't affect conversion output, so they're excluded from the
+// settings digest.
+bool IsDigestExcluded(const char* name) {
+  static const char* const kExcluded[] = {
+    "fsync_policy", "manifest", "memory_limit", "prefetch_images",
+    "preload_resources", "print_timing", "report", "timeout",
+    "write_queue_limit",
+  };
+  for (const char* excluded : kExcluded) {
+    if (strcmp(name, excluded) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
 class ArgParser {
  public:
   ArgParser()
@@ -50,8 +69,18 @@ class ArgParser {
         paths_("paths",
                "Input glTF (.gltf) and output USD "
                "(.usd, .usdc, .usda, .usdz, or .usd-) pairs.",
-               true, "path"),
-        nousage_arg_("", "nousage", "Don't print usage on argument error.") {
+               false, "path"),
+        nousage_arg_("", "nousage", "Don't print usage on argument error."),
+        print_digest_arg_("", "print_digest",
+                          "Print the converter version and settings digest "
+                          "recorded in manifests, then exit."),
+        profile_arg_("", "profile",
+                     "Also convert each job with these whitespace-separated "
+                     "flags applied, writing to the named subdirectory of its "
+                     "output directory. The glTF is loaded once for all "
+                     "profiles. May be repeated, e.g. "
+                     "--profile \"low:--image_scale 0.25\"",
+                     false, "name:flags") {
     cmd_.setOutput(&output_);
     cmd_.setExceptionHandling(false);
 
@@ -60,6 +89,8 @@ class ArgParser {
     // For some reason TCLAP lists parameters in reverse, so add them in reverse
     // to correct this.
     cmd_.add(nousage_arg_);
+    cmd_.add(profile_arg_);
+    cmd_.add(print_digest_arg_);
     const size_t binder_count = binders_.size();
     for (size_t i = binder_count; i != 0; ) {
       --i;
@@ -106,7 +137,10 @@ class ArgParser {
       }
 
       // Get src/dst path pairs.
-      if (paths.empty() || (paths.size() % 2) != 0) {
+      // * Paths are optional when just printing the digest.
+      out_args->print_digest = print_digest_arg_.getValue();
+      const bool need_paths = !out_args->print_digest || !paths.empty();
+      if (need_paths && (paths.empty() || (paths.size() % 2) != 0)) {
         ufg::Log<ufg::UFG_ERROR_ARGUMENT_PATHS>(logger, "");
         return false;
       }
@@ -122,6 +156,27 @@ class ArgParser {
       for (const std::unique_ptr<IBinder>& binder : binders_) {
         binder->Apply(out_args);
       }
+
+      // Apply each profile's flags on top of the base settings.
+      const std::vector<std::string>& profile_texts = profile_arg_.getValue();
+      out_args->profiles.resize(profile_texts.size());
+      for (size_t i = 0; i != profile_texts.size(); ++i) {
+        if (!ParseProfile(profile_texts[i], out_args->settings,
+                          &out_args->profiles[i], logger)) {
+          return false;
+        }
+      }
+
+      // Digest the effective value of every output-affecting setting, so
+      // equivalent command-lines (e.g. with arguments reordered or set to their
+      // defaults) produce the same digest.
+      ufg::Sha256 digest;
+      UpdateDigest(out_args->settings, &digest);
+      for (const Args::Profile& profile : out_args->profiles) {
+        digest.Update("profile=" + profile.name + "\n");
+        UpdateDigest(profile.settings, &digest);
+      }
+      out_args->settings_digest = digest.FinishHex();
       return true;
     } catch (const TCLAP::ArgException& e) {
       ufg::Log<ufg::UFG_ERROR_ARGUMENT_EXCEPTION>(
@@ -142,8 +197,68 @@ class ArgParser {
     virtual ~IBinder() {}
     virtual void Add(TCLAP::CmdLine* cmd) = 0;
     virtual void Apply(Args* args) = 0;
+    // Returns true if the argument was passed explicitly.
+    virtual bool IsSet() const = 0;
+    virtual const char* GetName() const = 0;
+    // Get the applied value as text.
+    virtual std::string GetValueText(
+        const ufg::ConvertSettings& settings) const = 0;
   };
 
+  void UpdateDigest(const ufg::ConvertSettings& settings,
+                    ufg::Sha256* digest) const {
+    for (const std::unique_ptr<IBinder>& binder : binders_) {
+      if (!IsDigestExcluded(binder->GetName())) {
+        digest->Update(binder->GetName());
+        digest->Update("=", 1);
+        digest->Update(binder->GetValueText(settings));
+        digest->Update("\n", 1);
+      }
+    }
+  }
+
+  // Parse a profile of the form name:[--flag value ...], applying the flags
+  // that were passed over the base settings.
+  static bool ParseProfile(const std::string& text,
+                           const ufg::ConvertSettings& base,
+                           Args::Profile* out_profile, ufg::Logger* logger) {
+    const size_t colon = text.find(':');
+    const std::string name =
+        colon == std::string::npos ? "" : text.substr(0, colon);
+    if (name.empty() || name == "." || name == ".." ||
+        name.find_first_of("/\\") != std::string::npos) {
+      ufg::Log<ufg::UFG_ERROR_ARGUMENT_PROFILE>(logger, "", text.c_str());
+      return false;
+    }
+    std::vector<std::string> arg_vec(1, "usd_from_gltf");
+    std::istringstream flags(text.substr(colon + 1));
+    std::string flag;
+    while (flags >> flag) {
+      arg_vec.push_back(flag);
+    }
+
+    ArgParser parser;
+    parser.nousage_ = true;
+    parser.cmd_.reset();
+    parser.cmd_.parse(arg_vec);
+    if (!parser.paths_.getValue().empty() ||
+        !parser.profile_arg_.getValue().empty() ||
+        parser.print_digest_arg_.getValue()) {
+      ufg::Log<ufg::UFG_ERROR_ARGUMENT_PROFILE>(logger, "", text.c_str());
+      return false;
+    }
+    Args profile_args;
+    profile_args.settings = base;
+    for (const std::unique_ptr<IBinder>& binder : parser.binders_) {
+      if (binder->IsSet()) {
+        binder->Apply(&profile_args);
+      }
+    }
+    out_profile->name = name;
+    out_profile->settings = profile_args.settings;
+    return true;
+  }
+
   class Output : public TCLAP::StdOutput {
    public:
     explicit Output(ArgParser* parser) : parser_(parser) {}
@@ -182,16 +297,23 @@ class ArgParser {
   std::vector<std::unique_ptr<IBinder>> binders_;
   TCLAP::UnlabeledMultiArg<std::string> paths_;
   TCLAP::SwitchArg nousage_arg_;
+  TCLAP::SwitchArg print_digest_arg_;
+  TCLAP::MultiArg<std::string> profile_arg_;
 
   // For switches, this adds an inverse 'no' flag (e.g. --all_nodes and
   // --noall_nodes).
+  // * The command-line default can differ from ConvertSettings::kDefault by
+  //   passing it explicitly.
   class SwitchBinder : public IBinder {
    public:
     SwitchBinder(const char* name, const char* desc, const bool* def)
+        : SwitchBinder(name, desc, def, *def) {}
+    SwitchBinder(const char* name, const char* desc, const bool* field,
+                 bool def)
         : name_(name),
           desc_(desc),
-          offset_(GetDefaultOffset(def)),
-          def_(*def) {}
+          offset_(GetDefaultOffset(field)),
+          def_(def) {}
     void Add(TCLAP::CmdLine* cmd) override {
       const std::string on_name = name_;
       const std::string off_name = "no" + on_name;
@@ -211,6 +333,14 @@ class ArgParser {
           reinterpret_cast<char*>(&args->settings) + offset_);
       *out_value = def_ ? !off_->getValue() : on_->getValue();
     }
+    bool IsSet() const override { return on_->isSet() || off_->isSet(); }
+    const char* GetName() const override { return name_; }
+    std::string GetValueText(
+        const ufg::ConvertSettings& settings) const override {
+      const bool* const value = reinterpret_cast<const bool*>(
+          reinterpret_cast<const char*>(&settings) + offset_);
+      return *value ? "1" : "0";
+    }
 
    private:
     const char* name_;
@@ -256,6 +386,14 @@ class ArgParser {
         *out_value = static_cast<DstType>(arg_->getValue());
       }
     }
+    bool IsSet() const override { return arg_->isSet(); }
+    const char* GetName() const override { return name_; }
+    std::string GetValueText(
+        const ufg::ConvertSettings& settings) const override {
+      const DstType* const value = reinterpret_cast<const DstType*>(
+          reinterpret_cast<const char*>(&settings) + offset_);
+      return ToString(*value);
+    }
 
    private:
     const char* name_;
@@ -292,6 +430,20 @@ class ArgParser {
                             add_strings.end());
       }
     }
+    bool IsSet() const override { return arg_->isSet(); }
+    const char* GetName() const override { return name_; }
+    std::string GetValueText(
+        const ufg::ConvertSettings& settings) const override {
+      const std::vector<std::string>* const strings =
+          reinterpret_cast<const std::vector<std::string>*>(
+              reinterpret_cast<const char*>(&settings) + offset_);
+      std::string text;
+      for (const std::string& str : *strings) {
+        text += str;
+        text += '\0';
+      }
+      return text;
+    }
 
    private:
     const char* name_;
@@ -344,6 +496,17 @@ class ArgParser {
     binders_.emplace_back(new FloatBinder ("image_limit_step",
         "Step used when limiting total image size.",
         &def.limit_total_image_scale_step));
+    binders_.emplace_back(new SwitchBinder("image_limit_weighted",
+        "Scale images individually by importance when limiting total size.",
+        &def.limit_total_image_weighted));
+    binders_.emplace_back(new UintBinder  ("image_limit_file_size",
+        "Limit the total file size of all images by reducing JPG quality. "
+        "One quality is chosen for all JPGs, so a single large image lowers "
+        "the quality of the rest.",
+        &def.limit_total_image_file_size));
+    binders_.emplace_back(new Uint8Binder ("jpg_quality_min",
+        "Minimum JPG quality used when limiting total image file size.",
+        &def.jpg_quality_min));
     binders_.emplace_back(new SwitchBinder("add_debug_bone_meshes",
         "Add debug meshes to each transform node to visualize animation.",
         &def.add_debug_bone_meshes));
@@ -359,6 +522,9 @@ class ArgParser {
     binders_.emplace_back(new SwitchBinder("black_occlusion_is_white",
         "If the occlusion channel is pure black, replace it with pure white.",
         &def.black_occlusion_is_white));
+    binders_.emplace_back(new SwitchBinder("fold_solid_textures",
+        "Replace solid-color textures with constant shader inputs.",
+        &def.fold_solid_textures));
     binders_.emplace_back(new SwitchBinder("delete_unused",
         "Delete unused intermediate output files.",
         &def.delete_unused));
@@ -383,6 +549,9 @@ class ArgParser {
     binders_.emplace_back(new SwitchBinder("fix_skinned_normals",
         "Work around iOS viewer not skinning normals.",
         &def.fix_skinned_normals));
+    binders_.emplace_back(new SwitchBinder("half_precision",
+        "Write mesh and animation data at half precision where accurate.",
+        &def.half_precision));
     binders_.emplace_back(new SwitchBinder("merge_identical_materials",
         "Merge materials with identical parameters, irrespective of name.",
         &def.merge_identical_materials));
@@ -398,6 +567,25 @@ class ArgParser {
     binders_.emplace_back(new SwitchBinder("prefer_jpeg",
         "Prefer saving images as jpeg.",
         &def.prefer_jpeg));
+    binders_.emplace_back(new SwitchBinder("pick_smaller_image_format",
+        "Encode opaque images as both PNG and JPG, keeping the smaller.",
+        &def.pick_smaller_image_format));
+    // Prefetch is safe here because the tool logs through an AsyncLogger.
+    binders_.emplace_back(new SwitchBinder("prefetch_images",
+        "Read and decode images in the background during geometry conversion.",
+        &def.prefetch_images, true));
+    binders_.emplace_back(new UintBinder  ("write_queue_limit",
+        "Bytes of encoded images queued for background writing [0=sync].",
+        &def.write_queue_limit));
+    binders_.emplace_back(new Uint8Binder ("fsync_policy",
+        "Flush written files to storage [0=never, 1=files, 2=files+dirs].",
+        &def.fsync_policy));
+    binders_.emplace_back(new SwitchBinder("preload_resources",
+        "Read all bin and image files in a single batch after loading.",
+        &def.gltf_load_settings.preload_resources));
+    binders_.emplace_back(new SwitchBinder("validate_data",
+        "Check accessor data for non-finite values and bad indices on load.",
+        &def.gltf_load_settings.validate_data));
     binders_.emplace_back(new SwitchBinder("print_timing",
         "Print conversion time stats.",
         &def.print_timing));
@@ -410,6 +598,9 @@ class ArgParser {
     binders_.emplace_back(new SwitchBinder("reverse_culling_for_inverse_scale",
         "Reverse polygon winding during conversion for inverse scale.",
         &def.reverse_culling_for_inverse_scale));
+    binders_.emplace_back(new SwitchBinder("split_layers",
+        "Write geometry, materials, and animation to separate sublayers.",
+        &def.split_layers));
     binders_.emplace_back(new SwitchBinder("warn_ios_incompat",
         "Emit warnings for features that are incompatible with the iOS viewer.",
         &def.warn_ios_incompat));
@@ -419,6 +610,18 @@ class ArgParser {
     binders_.emplace_back(new StringBinder("plugin_path",
         "Paths to USD plugins (may contain wildcards).",
         &def.plugin_path));
+    binders_.emplace_back(new StringBinder("report",
+        "Write a JSON report of conversion stats to this path.",
+        &def.report_path));
+    binders_.emplace_back(new StringBinder("manifest",
+        "Write a JSON manifest of input dependencies to this path.",
+        &def.manifest_path));
+    binders_.emplace_back(new FloatBinder ("timeout",
+        "Abort each conversion after this many seconds.",
+        &def.timeout));
+    binders_.emplace_back(new UintBinder  ("memory_limit",
+        "Abort each conversion if tracked memory exceeds this many MiB.",
+        &def.memory_limit_mb));
   }
 };
 }  // namespace
@@ -25,8 +25,20 @@ struct Args {
     std::string src;
     std::string dst;
   };
+  // Additional output written for each job, from the same glTF load.
+  struct Profile {
+    // Subdirectory of each job's output directory that this profile writes to.
+    std::string name;
+    // Base settings overridden by the profile's flags.
+    ufg::ConvertSettings settings;
+  };
   ufg::ConvertSettings settings;
   std::vector<Job> jobs;
+  std::vector<Profile> profiles;
+  // SHA-256 hex digest of settings that affect conversion output.
+  std::string settings_digest;
+  // Print the converter version and settings digest rather than converting.
+  bool print_digest = false;
 };
 
 bool ParseArgs(
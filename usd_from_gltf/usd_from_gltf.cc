@@ -15,9 +15,29 @@
  */
 
 #include <stdio.h>
+#include <vector>
 #include "args.h"  // NOLINT: Silence relative path warning.
+#include "common/buffer_pool.h"
 #include "common/logging.h"
 #include "convert/package.h"
+#include "gltf/disk_util.h"
+
+namespace {
+template <typename T>
+void PrintBufferPoolStats(const char* label) {
+  constexpr double kMiB = 1.0 / (1024.0 * 1024.0);
+  const ufg::BufferPoolStats stats = ufg::GetBufferPool<T>().GetStats();
+  printf("%s buffers: %.1f MiB high-water, %zu allocated, %zu reused.\n",
+         label, stats.high_water_bytes * kMiB, stats.alloc_count,
+         stats.reuse_count);
+  // All images are destroyed with their converters, so every pooled buffer
+  // should have been released by now.
+  if (stats.live_bytes != 0) {
+    printf("Warning: %s buffers: %.1f MiB still in use.\n", label,
+           stats.live_bytes * kMiB);
+  }
+}
+}  // namespace
 
 int main(int argc, char* argv[]) {
   GltfPrintLogger logger;
@@ -26,27 +46,88 @@ int main(int argc, char* argv[]) {
   if (!ParseArgs(argc, argv, &args, &logger)) {
     return -1;
   }
+  if (args.print_digest) {
+    printf("%s %s\n", ufg::kConverterVersion, args.settings_digest.c_str());
+    return 0;
+  }
   if (args.jobs.empty()) {
     return 0;
   }
 
-  if (!ufg::RegisterPlugins(args.settings.plugin_path, &logger)) {
+  // Print messages on a background thread, so conversion doesn't block on
+  // output. It's flushed before printing directly, to keep output ordered.
+  ufg::AsyncLogger async_logger(&logger);
+  if (!ufg::RegisterPlugins(args.settings.plugin_path, &async_logger)) {
     return -1;
   }
 
   bool success = true;
+  const bool keep_reports = !args.settings.report_path.empty() ||
+                            !args.settings.manifest_path.empty();
+  std::vector<ufg::ConvertReport> reports;
   {
     ufg::ProfileSentry profile_sentry("Convert", args.settings.print_timing);
     for (const Args::Job& job : args.jobs) {
       if (args.jobs.size() > 1) {
+        async_logger.Flush();
         printf("%s\n", job.src.c_str());
         logger.SetLinePrefix("  ");
       }
-      if (!ufg::ConvertGltfToUsd(
-              job.src.c_str(), job.dst.c_str(), args.settings, &logger)) {
+      if (args.profiles.empty()) {
+        ufg::ConvertReport report;
+        if (!ufg::ConvertGltfToUsd(job.src.c_str(), job.dst.c_str(),
+                                   args.settings, &async_logger, &report)) {
+          success = false;
+        }
+        if (keep_reports) {
+          reports.push_back(report);
+        }
+        continue;
+      }
+
+      // Convert the base settings and each profile from a single load. Each
+      // profile writes to a subdirectory named for it, next to the main
+      // output.
+      std::vector<ufg::ConvertProfile> profiles(1 + args.profiles.size());
+      profiles[0].dst_usd_path = job.dst;
+      profiles[0].settings = args.settings;
+      std::string dst_dir, dst_name;
+      Gltf::SplitPath(job.dst, &dst_dir, &dst_name);
+      for (size_t i = 0; i != args.profiles.size(); ++i) {
+        ufg::ConvertProfile& profile = profiles[i + 1];
+        profile.dst_usd_path =
+            dst_dir + args.profiles[i].name + "/" + dst_name;
+        profile.settings = args.profiles[i].settings;
+        GltfDiskCreateDirectoryForFile(profile.dst_usd_path);
+      }
+      std::vector<ufg::ConvertReport> profile_reports;
+      if (!ufg::ConvertGltfToUsdProfiles(job.src.c_str(), profiles,
+                                         &async_logger, &profile_reports)) {
         success = false;
       }
+      if (keep_reports) {
+        reports.insert(reports.end(), profile_reports.begin(),
+                       profile_reports.end());
+      }
     }
+    async_logger.Flush();
+  }
+
+  if (!args.settings.report_path.empty() &&
+      !ufg::WriteConvertReports(args.settings.report_path.c_str(), reports,
+                                &async_logger)) {
+    success = false;
+  }
+  if (!args.settings.manifest_path.empty() &&
+      !ufg::WriteConvertManifest(args.settings.manifest_path.c_str(),
+                                 ufg::kConverterVersion, args.settings_digest,
+                                 reports, &async_logger)) {
+    success = false;
+  }
+  async_logger.Flush();
+  if (args.settings.print_timing) {
+    PrintBufferPoolStats<uint8_t>("Image");
+    PrintBufferPoolStats<float>("Float");
   }
   return success ? 0 : -1;
 }